@@ -1,20 +1,24 @@
 #pragma once
 #include "AstDeclarationSpecifiers.h"
+#include "AstDeclarator.h"
 
 nullable_begin
 
 typedef struct
 {
 	AstDeclarationSpecifiers* declSpecs;
+	AstDeclaratorList* declarators;
 	SourceLocation location;
 } AstDeclaration;
 
 static AstDeclaration* AstDeclaration_Init_WithArgs(
 	AstDeclaration* self,
 	AstDeclarationSpecifiers* declSpecs,
+	AstDeclaratorList* declarators,
 	const SourceLocation location)
 {
 	self->declSpecs = declSpecs;
+	self->declarators = declarators;
 	self->location = location;
 	return self;
 }
@@ -22,6 +26,9 @@ static AstDeclaration* AstDeclaration_Init_WithArgs(
 static void AstDeclaration_Fini(const AstDeclaration* self)
 {
 	Release(self->declSpecs);
+	for (size_t i = 0; i < self->declarators->size; i++)
+		Release(self->declarators->data[i]);
+	Release(self->declarators);
 }
 
 nullable_end
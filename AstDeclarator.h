@@ -1,5 +1,6 @@
 #pragma once
 #include "AstDirectDeclarator.h"
+#include "AstExpression.h"
 #include "AstPointer.h"
 
 nullable_begin
@@ -8,6 +9,8 @@ struct AstDeclarator
 {
 	AstPointer*nullable pointer;
 	AstDirectDeclarator* directDeclarator;
+	// Set when the declarator of a declaration is followed by "= <initializer>"
+	AstExpression*nullable initializer;
 	SourceLocation location;
 };
 
@@ -16,6 +19,7 @@ static AstDeclarator* AstDeclarator_Init_WithArgs(AstDeclarator* self, AstPointe
 	self->location = location;
 	self->pointer = pointer;
 	self->directDeclarator = directDeclarator;
+	self->initializer = NULL;
 	return self;
 }
 
@@ -23,6 +27,13 @@ static void AstDeclarator_Fini(const AstDeclarator* self)
 {
 	Release(self->pointer);
 	Release(self->directDeclarator);
+	Release(self->initializer);
 }
 
 nullable_end
+
+#define LIST_TYPE AstDeclaratorList
+#define LIST_ELEMENT_TYPE AstDeclarator*
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
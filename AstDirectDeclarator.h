@@ -37,17 +37,23 @@ typedef struct
 
 	union
 	{
-		ConstCharSpan identifier;
+		struct
+		{
+			ConstCharSpan identifier;
+			uint32_t symbol; // Interned identifier
+		};
 		AstDeclarator* parenthesized;
 	};
 } AstDirectDeclarator;
 
 static AstDirectDeclarator* AstDirectDeclarator_Init_WithIdentifier(AstDirectDeclarator* self,
                                                                     const ConstCharSpan identifier,
+                                                                    const uint32_t symbol,
                                                                     const SourceLocation location)
 {
 	self->type = AST_DIRECTDECLARATOR_IDENTIFIER;
 	self->identifier = identifier;
+	self->symbol = symbol;
 	self->location = location;
 	return self;
 }
@@ -56,7 +62,7 @@ static AstDirectDeclarator* AstDirectDeclarator_Init_WithParenthesized(AstDirect
                                                                        AstDeclarator* parenthesized,
                                                                        const SourceLocation location)
 {
-	self->type = AST_DIRECTDECLARATOR_IDENTIFIER;
+	self->type = AST_DIRECTDECLARATOR_PARENTHESIZED;
 	self->parenthesized = parenthesized;
 	self->location = location;
 	return self;
@@ -194,6 +194,7 @@ typedef struct
 {
 	AstExpression* expression;
 	ConstCharSpan memberName;
+	uint32_t memberSymbol; // Interned member name
 	bool isPointerAccess;
 } AstMemberAccessExpression;
 
@@ -206,6 +207,10 @@ typedef struct
 typedef struct
 {
 	Token literal;
+	// Copy of the literal's payload (integer and floating-point literals only)
+	Token_Data data;
+	// Stands for a constant subexpression that was evaluated; literal spans the subexpression and has no lexeme
+	bool isFolded;
 } AstPrimaryExpression;
 
 typedef union
@@ -282,11 +287,17 @@ static AstExpression* AstExpression_Init_WithSizeofType(AstExpression* self, Ast
 static AstExpression* AstExpression_Init_WithMemberAccess(AstExpression* self,
                                                           AstExpression* expression,
                                                           const ConstCharSpan memberName,
+                                                          const uint32_t memberSymbol,
                                                           const bool isPointerAccess,
                                                           const SourceLocation location)
 {
 	self->type = AST_EXPR_MEMBER_ACCESS;
-	self->data.memberAccess = (AstMemberAccessExpression) { .expression = expression, .memberName = memberName, .isPointerAccess = isPointerAccess };
+	self->data.memberAccess = (AstMemberAccessExpression) {
+		.expression = expression,
+		.memberName = memberName,
+		.memberSymbol = memberSymbol,
+		.isPointerAccess = isPointerAccess,
+	};
 	self->location = location;
 	return self;
 }
@@ -299,45 +310,103 @@ static AstExpression* AstExpression_Init_WithCall(AstExpression* self, AstExpres
 	return self;
 }
 
-static AstExpression* AstExpression_Init_WithPrimary(AstExpression* self, const Token literal, const SourceLocation location)
+static AstExpression* AstExpression_Init_WithPrimary(AstExpression* self, const Token literal, const Token_Data data, const SourceLocation location)
 {
 	self->type = AST_EXPR_PRIMARY;
-	self->data.primary = (AstPrimaryExpression) { .literal = literal };
+	self->data.primary = (AstPrimaryExpression) { .literal = literal, .data = data, .isFolded = false };
 	self->location = location;
 	return self;
 }
 
-static void AstExpression_Fini(const AstExpression* self)
+// Children in source order: operands, then call arguments after the callee. Type names are not children.
+// Passes over expressions walk them through these accessors from a stack of their own rather than by recursion, as
+// expressions nest as deeply as their source does and must not exhaust the C stack.
+static size_t AstExpression_GetChildCount(const AstExpression* self)
+{
+	switch (self->type)
+	{
+		case AST_EXPR_UNARY:
+		case AST_EXPR_CAST:
+		case AST_EXPR_MEMBER_ACCESS:
+			return 1;
+		case AST_EXPR_BINARY:
+			return 2;
+		case AST_EXPR_TERNARY:
+			return 3;
+		case AST_EXPR_CALL:
+			return 1 + self->data.call.arguments->size;
+		default:
+			return 0;
+	}
+}
+
+// The field holding the child at position index, so that passes can replace it
+static AstExpression** AstExpression_GetChildSlot(AstExpression* self, const size_t index)
+{
+	switch (self->type)
+	{
+		case AST_EXPR_UNARY:
+			return &self->data.unary.expression;
+		case AST_EXPR_BINARY:
+			return index == 0 ? &self->data.binary.left : &self->data.binary.right;
+		case AST_EXPR_TERNARY:
+			return index == 0 ? &self->data.ternary.left : index == 1 ? &self->data.ternary.middle : &self->data.ternary.right;
+		case AST_EXPR_CAST:
+			return &self->data.cast.expression;
+		case AST_EXPR_MEMBER_ACCESS:
+			return &self->data.memberAccess.expression;
+		case AST_EXPR_CALL:
+			return index == 0 ? &self->data.call.callee : &self->data.call.arguments->data[index - 1];
+		default:
+			assert(false && "unreachable (node has no children)");
+			abort();
+	}
+}
+
+// Drops a reference to a child. If it was the last one, the child is pushed on *pending, linked through its location
+// (which teardown no longer needs), instead of being finalized recursively.
+static void AstExpression_ReleaseChild(AstExpression* child, AstExpression*nullable* pending)
+{
+	AstExpression*nullable detached = ReleaseDetach(child);
+	if (detached == NULL)
+		return;
+
+	detached->location.offset = (uintptr_t)*pending;
+	*pending = detached;
+}
+
+static void AstExpression_ReleaseChildren(const AstExpression* self, AstExpression*nullable* pending)
 {
 	switch (self->type)
 	{
 		case AST_EXPR_PRIMARY:
 			break;
 		case AST_EXPR_UNARY:
-			Release(self->data.unary.expression);
+			AstExpression_ReleaseChild(self->data.unary.expression, pending);
 			break;
 		case AST_EXPR_BINARY:
-			Release(self->data.binary.left);
-			Release(self->data.binary.right);
+			AstExpression_ReleaseChild(self->data.binary.left, pending);
+			AstExpression_ReleaseChild(self->data.binary.right, pending);
 			break;
 		case AST_EXPR_TERNARY:
-			Release(self->data.ternary.left);
-			Release(self->data.ternary.middle);
-			Release(self->data.ternary.right);
+			AstExpression_ReleaseChild(self->data.ternary.left, pending);
+			AstExpression_ReleaseChild(self->data.ternary.middle, pending);
+			AstExpression_ReleaseChild(self->data.ternary.right, pending);
 			break;
 		case AST_EXPR_CAST:
 			Release(self->data.cast.typeName);
+			AstExpression_ReleaseChild(self->data.cast.expression, pending);
 			break;
 		case AST_EXPR_SIZEOF_TYPE:
 			Release(self->data.sizeofType.typeName);
 			break;
 		case AST_EXPR_MEMBER_ACCESS:
-			Release(self->data.memberAccess.expression);
+			AstExpression_ReleaseChild(self->data.memberAccess.expression, pending);
 			break;
 		case AST_EXPR_CALL:
-			Release(self->data.call.callee);
+			AstExpression_ReleaseChild(self->data.call.callee, pending);
 			for (size_t i = 0; i < self->data.call.arguments->size; i++)
-				Release(self->data.call.arguments->data[i]);
+				AstExpression_ReleaseChild(self->data.call.arguments->data[i], pending);
 			Release(self->data.call.arguments);
 			break;
 		default:
@@ -345,4 +414,18 @@ static void AstExpression_Fini(const AstExpression* self)
 	}
 }
 
+// Tears the subtree down with a loop over the nodes whose last reference it drops, so deep trees do not recurse
+static void AstExpression_Fini(const AstExpression* self)
+{
+	AstExpression*nullable pending = NULL;
+	AstExpression_ReleaseChildren(self, &pending);
+	while (pending != NULL)
+	{
+		AstExpression* expression = pending;
+		pending = (AstExpression*)(uintptr_t)expression->location.offset;
+		AstExpression_ReleaseChildren(expression, &pending);
+		FreeDetached(expression);
+	}
+}
+
 nullable_end
@@ -3,22 +3,26 @@
 
 nullable_begin
 
-typedef struct
+typedef struct AstPointer AstPointer;
+
+struct AstPointer
 {
 	SourceLocation location;
 	AstTypeQualifiers qualifiers;
-} AstPointer;
+	AstPointer*nullable pointer; // Next level of indirection
+};
 
-static AstPointer* AstPointer_Init_WithArgs(AstPointer* self, AstTypeQualifiers qualifiers, SourceLocation location)
+static AstPointer* AstPointer_Init_WithArgs(AstPointer* self, AstTypeQualifiers qualifiers, AstPointer*nullable pointer, SourceLocation location)
 {
 	self->location = location;
 	self->qualifiers = qualifiers;
+	self->pointer = pointer;
 	return self;
 }
 
 static void AstPointer_Fini(const AstPointer* self)
 {
-	(void)self;
+	Release(self->pointer);
 }
 
 nullable_end
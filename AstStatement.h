@@ -77,7 +77,7 @@ static void AstStatement_Fini(const AstStatement* self)
 	{
 		case AST_STMT_EXPRESSION:
 			if (self->data.expression.expression)
-				AstExpression_Fini((AstExpression*)self->data.expression.expression);
+				Release(self->data.expression.expression);
 			break;
 		default:
 			break;
@@ -1,5 +1,8 @@
 #pragma once
 
+#include "Util/Managed.h"
+#include "Util/String.h"
+
 nullable_begin
 
 #define AST_TYPEQUALIFIERS_ENUM_VALUES \
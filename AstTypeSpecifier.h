@@ -1,5 +1,8 @@
 #pragma once
 
+#include "SourceFile.h"
+#include "Util/Interner.h"
+
 nullable_begin
 
 #define AST_TYPESPECIFIER_ENUM_VALUES \
@@ -41,11 +44,21 @@ typedef struct
 {
 	SourceLocation location;
 	AstTypeSpecifier_Type type;
+	uint32_t symbol; // Interned name of a TYPEDEF_NAME
 } AstTypeSpecifier;
 
 static AstTypeSpecifier* AstTypeSpecifier_Init_WithArgs(AstTypeSpecifier* self, const AstTypeSpecifier_Type type, const SourceLocation location)
 {
 	self->type = type;
+	self->symbol = INTERNER_NO_SYMBOL;
+	self->location = location;
+	return self;
+}
+
+static AstTypeSpecifier* AstTypeSpecifier_Init_WithTypedefName(AstTypeSpecifier* self, const uint32_t symbol, const SourceLocation location)
+{
+	self->type = AST_TYPESPECIFIER_TYPEDEF_NAME;
+	self->symbol = symbol;
 	self->location = location;
 	return self;
 }
@@ -26,11 +26,16 @@ static const char* ErrorMsg_UnterminatedComment = "unterminated comment";
 static const char* ErrorMsg_UnterminatedStringLiteral = "unterminated string literal";
 static const char* ErrorMsg_UnexpectedEndOfFile = "unexpected end of file";
 static const char* ErrorMsg_InvalidNumericLiteral = "invalid numeric literal";
+static const char* ErrorMsg_IntegerLiteralTooLarge = "integer literal is too large";
 static const char* ErrorMsg_InvalidAssignmentTarget = "invalid assignment target";
 static const char* ErrorMsg_ExpectedColonInConditionalExpression = "expected ':' in conditional expression";
 static const char* ErrorMsg_ExpectedClosingParenthesisInCastExpression = "expected ')' in cast expression";
 static const char* ErrorMsg_ExpectedClosingParenthesisInSizeofTypeExpression = "expected ')' in sizeof(<type>) expression";
 static const char* ErrorMsg_ExpectedClosingBracketInSubscriptExpression = "expected ']' in subscript expression";
 static const char* ErrorMsg_ExpectedClosingParenthesisInParenthesizedExpression = "expected ')' in parenthesized expression";
+static const char* ErrorMsg_ExpectedClosingParenthesisInCompoundLiteral = "expected ')' after type name in compound literal";
+static const char* ErrorMsg_ExpectedInitializerListInCompoundLiteral = "expected '{' after type name in compound literal";
+static const char* ErrorMsg_ExpectedInitializer = "expected an initializer after '='";
+static const char* ErrorMsg_InitializerListNotSupported = "braced initializer lists are not supported";
 
 nullable_end
@@ -0,0 +1,882 @@
+#include "ConstantFolder.h"
+
+#include <float.h>
+#include <math.h>
+
+#include "Util/Managed.h"
+
+nullable_begin
+
+typedef enum
+{
+	CONSTANT_TYPE_CHAR,
+	CONSTANT_TYPE_SIGNED_CHAR,
+	CONSTANT_TYPE_UNSIGNED_CHAR,
+	CONSTANT_TYPE_SHORT,
+	CONSTANT_TYPE_UNSIGNED_SHORT,
+	// Each signed type from int up is directly followed by its unsigned counterpart
+	CONSTANT_TYPE_INT,
+	CONSTANT_TYPE_UNSIGNED_INT,
+	CONSTANT_TYPE_LONG,
+	CONSTANT_TYPE_UNSIGNED_LONG,
+	CONSTANT_TYPE_LONG_LONG,
+	CONSTANT_TYPE_UNSIGNED_LONG_LONG,
+	CONSTANT_TYPE_FLOAT,
+	CONSTANT_TYPE_DOUBLE,
+} ConstantFolder_Type;
+
+typedef struct
+{
+	uint8_t size;
+	// Integer conversion rank, or the order of floating types
+	uint8_t rank;
+	bool isSigned;
+	bool isFloating;
+} ConstantFolder_TypeInfo;
+
+static const ConstantFolder_TypeInfo ConstantFolder_TypeInfos[] = {
+	[CONSTANT_TYPE_CHAR] = { 1, 1, true, false },
+	[CONSTANT_TYPE_SIGNED_CHAR] = { 1, 1, true, false },
+	[CONSTANT_TYPE_UNSIGNED_CHAR] = { 1, 1, false, false },
+	[CONSTANT_TYPE_SHORT] = { 2, 2, true, false },
+	[CONSTANT_TYPE_UNSIGNED_SHORT] = { 2, 2, false, false },
+	[CONSTANT_TYPE_INT] = { 4, 3, true, false },
+	[CONSTANT_TYPE_UNSIGNED_INT] = { 4, 3, false, false },
+	[CONSTANT_TYPE_LONG] = { 8, 4, true, false },
+	[CONSTANT_TYPE_UNSIGNED_LONG] = { 8, 4, false, false },
+	[CONSTANT_TYPE_LONG_LONG] = { 8, 5, true, false },
+	[CONSTANT_TYPE_UNSIGNED_LONG_LONG] = { 8, 5, false, false },
+	[CONSTANT_TYPE_FLOAT] = { 4, 0, true, true },
+	[CONSTANT_TYPE_DOUBLE] = { 8, 1, true, true },
+};
+
+typedef struct
+{
+	ConstantFolder_Type type;
+	union
+	{
+		// Integers are kept truncated to their type and sign-extended to 64 bits
+		uint64_t integer;
+		// Floats are kept as the double holding the exact float value
+		double floating;
+	};
+} ConstantFolder_Value;
+
+typedef struct
+{
+	bool isConstant;
+	ConstantFolder_Value value;
+	// Nodes in the subtree
+	size_t nodeCount;
+	// Constant casts to character and short types: the index + 1 of their operand in the operand list, or 0
+	uint32_t operand;
+} ConstantFolder_Result;
+
+// The operand of a constant cast to a type without literals, folded in its place when the cast is materialized
+typedef struct
+{
+	AstExpression** slot;
+	ConstantFolder_Result result;
+} ConstantFolder_Operand;
+
+// An expression whose children are not all evaluated yet
+typedef struct
+{
+	AstExpression** slot;
+	uint32_t nextChild;
+	uint32_t childCount;
+} ConstantFolder_Frame;
+
+nullable_end
+
+#define LIST_TYPE ConstantFolder_ResultList
+#define LIST_ELEMENT_TYPE ConstantFolder_Result
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE ConstantFolder_OperandList
+#define LIST_ELEMENT_TYPE ConstantFolder_Operand
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE ConstantFolder_FrameList
+#define LIST_ELEMENT_TYPE ConstantFolder_Frame
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+nullable_begin
+
+static void ConstantFolder_Push(ConstantFolder_FrameList* stack, ConstantFolder_ResultList* results, AstExpression** slot);
+static ConstantFolder_Result ConstantFolder_Evaluate(ConstantFolder* self, ConstantFolder_OperandList* operands, AstExpression* expression,
+                                                     const ConstantFolder_Result* children, size_t childCount);
+static void ConstantFolder_Materialize(ConstantFolder* self, const ConstantFolder_OperandList* operands, AstExpression** slot,
+                                       const ConstantFolder_Result* result);
+static bool ConstantFolder_EvaluatePrimary(const AstPrimaryExpression* primary, const SourceLocation* location, ConstantFolder_Value* outValue);
+static bool ConstantFolder_IsFloatTie(double value);
+static bool ConstantFolder_EvaluateUnary(AstUnaryOperation operation, const ConstantFolder_Value* operand, ConstantFolder_Value* outValue);
+static bool ConstantFolder_EvaluateBinary(AstBinaryOperation operation, const ConstantFolder_Value* left, const ConstantFolder_Value* right,
+                                          ConstantFolder_Value* outValue);
+static bool ConstantFolder_EvaluateIntegerBinary(AstBinaryOperation operation, ConstantFolder_Type type, uint64_t left, uint64_t right,
+                                                 uint64_t* outValue);
+static bool ConstantFolder_EvaluateShift(AstBinaryOperation operation, const ConstantFolder_Value* left, const ConstantFolder_Value* right,
+                                         ConstantFolder_Value* outValue);
+static bool ConstantFolder_Convert(const ConstantFolder_Value* value, ConstantFolder_Type type, ConstantFolder_Value* outValue);
+static bool ConstantFolder_GetTypeNameType(const AstTypeName* typeName, ConstantFolder_Type* outType);
+static ConstantFolder_Type ConstantFolder_Promote(ConstantFolder_Type type);
+static ConstantFolder_Type ConstantFolder_GetCommonType(ConstantFolder_Type first, ConstantFolder_Type second);
+static uint64_t ConstantFolder_Truncate(uint64_t value, ConstantFolder_Type type);
+static bool ConstantFolder_IsNonzero(const ConstantFolder_Value* value);
+static ConstantFolder_Value ConstantFolder_MakeInt(bool value);
+
+ConstantFolder ConstantFolder_Create(Arena*nullable arena)
+{
+	return (ConstantFolder) { .arena = arena };
+}
+
+AstExpression* ConstantFolder_Fold(ConstantFolder* self, AstExpression* expression)
+{
+	// Subtrees are evaluated bottom-up; the results of finished children wait on a second stack until their parent is
+	// evaluated.
+	ConstantFolder_FrameList stack;
+	ConstantFolder_FrameList_Init(&stack);
+	ConstantFolder_ResultList results;
+	ConstantFolder_ResultList_Init(&results);
+	ConstantFolder_OperandList operands;
+	ConstantFolder_OperandList_Init(&operands);
+
+	ConstantFolder_Push(&stack, &results, &expression);
+	while (stack.size != 0)
+	{
+		ConstantFolder_Frame* frame = &stack.data[stack.size - 1];
+		if (frame->nextChild != frame->childCount)
+		{
+			AstExpression** slot = AstExpression_GetChildSlot(*frame->slot, frame->nextChild++);
+			// Pushing may move the stack, so frame is not used past this point
+			ConstantFolder_Push(&stack, &results, slot);
+			continue;
+		}
+
+		results.size -= frame->childCount;
+		const ConstantFolder_Result result = ConstantFolder_Evaluate(self, &operands, *frame->slot, results.data + results.size, frame->childCount);
+		ConstantFolder_ResultList_AppendFromPtr(&results, &result);
+		stack.size--;
+	}
+
+	assert(results.size == 1);
+	if (results.data[0].isConstant)
+		ConstantFolder_Materialize(self, &operands, &expression, &results.data[0]);
+
+	ConstantFolder_FrameList_Fini(&stack);
+	ConstantFolder_ResultList_Fini(&results);
+	ConstantFolder_OperandList_Fini(&operands);
+	return expression;
+}
+
+void ConstantFolder_Push(ConstantFolder_FrameList* stack, ConstantFolder_ResultList* results, AstExpression** slot)
+{
+	// A missing child has no nodes and is not constant
+	if (!*slot)
+	{
+		const ConstantFolder_Result missing = { 0 };
+		ConstantFolder_ResultList_AppendFromPtr(results, &missing);
+		return;
+	}
+
+	// Leaves are evaluated right away, without a frame
+	const AstExpression* expression = *slot;
+	if (expression->type == AST_EXPR_PRIMARY)
+	{
+		ConstantFolder_Result leaf = { .nodeCount = 1 };
+		leaf.isConstant = ConstantFolder_EvaluatePrimary(&expression->data.primary, &expression->location, &leaf.value);
+		ConstantFolder_ResultList_AppendFromPtr(results, &leaf);
+		return;
+	}
+
+	const ConstantFolder_Frame frame = { slot, 0, (uint32_t)AstExpression_GetChildCount(*slot) };
+	ConstantFolder_FrameList_AppendFromPtr(stack, &frame);
+}
+
+// Evaluates expression from the results of its children. Constant children of a node that is not constant itself are
+// replaced by folded nodes; a constant node is left for its parent to replace, so each folded subtree becomes a single node.
+ConstantFolder_Result ConstantFolder_Evaluate(ConstantFolder* self, ConstantFolder_OperandList* operands, AstExpression* expression,
+                                              const ConstantFolder_Result* children, const size_t childCount)
+{
+	ConstantFolder_Result result = { .nodeCount = 1 };
+	for (size_t i = 0; i < childCount; i++)
+		result.nodeCount += children[i].nodeCount;
+
+	switch (expression->type)
+	{
+		case AST_EXPR_PRIMARY:
+			result.isConstant = ConstantFolder_EvaluatePrimary(&expression->data.primary, &expression->location, &result.value);
+			break;
+		case AST_EXPR_UNARY:
+		{
+			AstUnaryExpression* unary = &expression->data.unary;
+			const ConstantFolder_Result* operand = &children[0];
+			if (operand->isConstant && unary->operation == AST_UNOP_SIZEOF)
+			{
+				// The operand is not evaluated, only its type matters
+				result.isConstant = true;
+				result.value = (ConstantFolder_Value) {
+					.type = CONSTANT_TYPE_UNSIGNED_LONG,
+					.integer = ConstantFolder_TypeInfos[operand->value.type].size,
+				};
+			}
+			else if (operand->isConstant)
+				result.isConstant = ConstantFolder_EvaluateUnary(unary->operation, &operand->value, &result.value);
+
+			if (!result.isConstant && operand->isConstant)
+				ConstantFolder_Materialize(self, operands, &unary->expression, operand);
+			break;
+		}
+		case AST_EXPR_BINARY:
+		{
+			AstBinaryExpression* binary = &expression->data.binary;
+			const ConstantFolder_Result* left = &children[0];
+			const ConstantFolder_Result* right = &children[1];
+			if (left->isConstant && right->isConstant)
+				result.isConstant = ConstantFolder_EvaluateBinary(binary->operation, &left->value, &right->value, &result.value);
+
+			if (!result.isConstant)
+			{
+				if (left->isConstant)
+					ConstantFolder_Materialize(self, operands, &binary->left, left);
+				if (right->isConstant)
+					ConstantFolder_Materialize(self, operands, &binary->right, right);
+			}
+			break;
+		}
+		case AST_EXPR_TERNARY:
+		{
+			AstTernaryExpression* ternary = &expression->data.ternary;
+			const ConstantFolder_Result* left = &children[0];
+			const ConstantFolder_Result* middle = &children[1];
+			const ConstantFolder_Result* right = &children[2];
+
+			// The result has the common type of both arms, so both have to be known even though only one is evaluated
+			if (ternary->operation == AST_TERNOP_CONDITIONAL && left->isConstant && middle->isConstant && right->isConstant)
+			{
+				const ConstantFolder_Type type = ConstantFolder_GetCommonType(middle->value.type, right->value.type);
+				const ConstantFolder_Value* chosen = ConstantFolder_IsNonzero(&left->value) ? &middle->value : &right->value;
+				result.isConstant = ConstantFolder_Convert(chosen, type, &result.value);
+			}
+
+			if (!result.isConstant)
+			{
+				if (left->isConstant)
+					ConstantFolder_Materialize(self, operands, &ternary->left, left);
+				if (middle->isConstant)
+					ConstantFolder_Materialize(self, operands, &ternary->middle, middle);
+				if (right->isConstant)
+					ConstantFolder_Materialize(self, operands, &ternary->right, right);
+			}
+			break;
+		}
+		case AST_EXPR_CAST:
+		{
+			AstCastExpression* cast = &expression->data.cast;
+			const ConstantFolder_Result* operand = &children[0];
+			ConstantFolder_Type type;
+			if (operand->isConstant && ConstantFolder_GetTypeNameType(cast->typeName, &type))
+				result.isConstant = ConstantFolder_Convert(&operand->value, type, &result.value);
+
+			if (!result.isConstant && operand->isConstant)
+				ConstantFolder_Materialize(self, operands, &cast->expression, operand);
+			else if (result.isConstant && result.value.type < CONSTANT_TYPE_INT)
+			{
+				// Character and short types have no literals, so materializing this cast folds its operand instead
+				const ConstantFolder_Operand deferred = { &cast->expression, *operand };
+				ConstantFolder_OperandList_AppendFromPtr(operands, &deferred);
+				result.operand = (uint32_t)operands->size;
+			}
+			break;
+		}
+		case AST_EXPR_SIZEOF_TYPE:
+		{
+			ConstantFolder_Type type;
+			if (ConstantFolder_GetTypeNameType(expression->data.sizeofType.typeName, &type))
+			{
+				result.isConstant = true;
+				result.value = (ConstantFolder_Value) { .type = CONSTANT_TYPE_UNSIGNED_LONG, .integer = ConstantFolder_TypeInfos[type].size };
+			}
+			break;
+		}
+		case AST_EXPR_MEMBER_ACCESS:
+		case AST_EXPR_CALL:
+			// Never constant; every constant child is replaced
+			for (size_t i = 0; i < childCount; i++)
+			{
+				if (children[i].isConstant)
+					ConstantFolder_Materialize(self, operands, AstExpression_GetChildSlot(expression, i), &children[i]);
+			}
+			break;
+		default:
+			break;
+	}
+
+	return result;
+}
+
+// Replaces the constant subtree at slot with a folded node
+void ConstantFolder_Materialize(ConstantFolder* self, const ConstantFolder_OperandList* operands, AstExpression** slot,
+                                const ConstantFolder_Result* result)
+{
+	// Character and short types have no literals; fold below the conversions to them instead
+	while (result->value.type < CONSTANT_TYPE_INT)
+	{
+		assert(result->operand != 0);
+		const ConstantFolder_Operand* operand = &operands->data[result->operand - 1];
+		slot = operand->slot;
+		result = &operand->result;
+	}
+
+	AstExpression* expression = *slot;
+	if (expression->type == AST_EXPR_PRIMARY)
+		return;
+
+	const ConstantFolder_Value* value = &result->value;
+	Token literal = {
+		.offset = (uint32_t)expression->location.offset,
+		.length = (uint32_t)expression->location.snippet.length,
+		.dataIndex = TOKEN_NO_DATA,
+	};
+	Token_Data data = { 0 };
+	if (ConstantFolder_TypeInfos[value->type].isFloating)
+	{
+		literal.type = TOKEN_LITERAL_FLOAT;
+		data.literalDecimalFloat = (Token_LiteralFloat) {
+			.type = value->type == CONSTANT_TYPE_FLOAT ? TOKEN_LITERAL_FLOAT_TYPE_FLOAT : TOKEN_LITERAL_FLOAT_TYPE_DOUBLE,
+			.decoded = value->floating,
+		};
+	}
+	else
+	{
+		literal.type = TOKEN_LITERAL_INTEGER;
+		data.literalInteger = (Token_LiteralInteger) {
+			.base = 10,
+			.type = (Token_LiteralInteger_Type)(TOKEN_LITERAL_INTEGER_TYPE_INT + (value->type - CONSTANT_TYPE_INT) / 2 +
+			                                    (ConstantFolder_TypeInfos[value->type].isSigned ? 0 : 3)),
+			.decoded = value->integer,
+		};
+	}
+
+	AstExpression* folded = NewWithIn(self->arena, AstExpression, Primary, literal, data, expression->location);
+	folded->data.primary.isFolded = true;
+	*slot = folded;
+	Release(expression);
+
+	self->foldedNodeCount++;
+	self->removedNodeCount += result->nodeCount;
+}
+
+bool ConstantFolder_EvaluatePrimary(const AstPrimaryExpression* primary, const SourceLocation* location, ConstantFolder_Value* outValue)
+{
+	switch (primary->literal.type)
+	{
+		case TOKEN_LITERAL_INTEGER:
+		{
+			const Token_LiteralInteger* literal = &primary->data.literalInteger;
+			outValue->type = (ConstantFolder_Type)(CONSTANT_TYPE_INT + (literal->type % 3) * 2 + (literal->type >= TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDINT));
+			outValue->integer = ConstantFolder_Truncate(literal->decoded, outValue->type);
+			return true;
+		}
+		case TOKEN_LITERAL_FLOAT:
+		{
+			const Token_LiteralFloat* literal = &primary->data.literalDecimalFloat;
+			if (literal->type == TOKEN_LITERAL_FLOAT_TYPE_DOUBLE)
+			{
+				*outValue = (ConstantFolder_Value) { .type = CONSTANT_TYPE_DOUBLE, .floating = literal->decoded };
+				return true;
+			}
+
+			// Rounding the correctly rounded double to float gives the correctly rounded float unless the double landed
+			// exactly halfway between two floats, where the literal may have been on either side
+			if (literal->type == TOKEN_LITERAL_FLOAT_TYPE_FLOAT && !ConstantFolder_IsFloatTie(literal->decoded))
+			{
+				const double value = (double)(float)literal->decoded;
+				if (!isfinite(value))
+					return false;
+
+				*outValue = (ConstantFolder_Value) { .type = CONSTANT_TYPE_FLOAT, .floating = value };
+				return true;
+			}
+			return false;
+		}
+		case TOKEN_LITERAL_CHAR:
+		{
+			// Character constants have type int; only unprefixed ones of a single ASCII character or simple escape are known
+			const ConstCharSpan lexeme = location->snippet;
+			static const char escapes[] = "n\nt\tr\r0\0\\\\''\"\"a\ab\bf\fv\v??";
+			if (lexeme.length == 3 && lexeme.data[0] == '\'' && lexeme.data[1] != '\\' && (unsigned char)lexeme.data[1] < 0x80)
+			{
+				*outValue = (ConstantFolder_Value) { .type = CONSTANT_TYPE_INT, .integer = (uint64_t)lexeme.data[1] };
+				return true;
+			}
+			if (lexeme.length == 4 && lexeme.data[0] == '\'' && lexeme.data[1] == '\\')
+			{
+				for (size_t i = 0; i + 1 < sizeof(escapes); i += 2)
+				{
+					if (escapes[i] == lexeme.data[2])
+					{
+						*outValue = (ConstantFolder_Value) { .type = CONSTANT_TYPE_INT, .integer = (uint64_t)escapes[i + 1] };
+						return true;
+					}
+				}
+			}
+			return false;
+		}
+		default:
+			return false;
+	}
+}
+
+bool ConstantFolder_IsFloatTie(const double value)
+{
+	// Scale the magnitude so that the last significand bit of a float in its binade (or of a subnormal float) is worth
+	// one; halfway values then have a fractional part of exactly one half. The scaling by a power of two is exact.
+	int exponent;
+	frexp(fabs(value), &exponent);
+	if (exponent < FLT_MIN_EXP)
+		exponent = FLT_MIN_EXP;
+
+	const double scaled = ldexp(fabs(value), FLT_MANT_DIG - exponent);
+	return scaled - floor(scaled) == 0.5;
+}
+
+bool ConstantFolder_EvaluateUnary(const AstUnaryOperation operation, const ConstantFolder_Value* operand, ConstantFolder_Value* outValue)
+{
+	if (operation == AST_UNOP_LOGICAL_NOT)
+	{
+		*outValue = ConstantFolder_MakeInt(!ConstantFolder_IsNonzero(operand));
+		return true;
+	}
+
+	ConstantFolder_Value promoted;
+	if (!ConstantFolder_Convert(operand, ConstantFolder_Promote(operand->type), &promoted))
+		return false;
+
+	const ConstantFolder_TypeInfo* info = &ConstantFolder_TypeInfos[promoted.type];
+	switch (operation)
+	{
+		case AST_UNOP_PLUS:
+			*outValue = promoted;
+			return true;
+		case AST_UNOP_MINUS:
+			outValue->type = promoted.type;
+			if (info->isFloating)
+			{
+				outValue->floating = -promoted.floating;
+				return true;
+			}
+			return ConstantFolder_EvaluateIntegerBinary(AST_BINOP_SUBTRACT, promoted.type, 0, promoted.integer, &outValue->integer);
+		case AST_UNOP_BITWISE_NOT:
+			if (info->isFloating)
+				return false;
+			*outValue = (ConstantFolder_Value) { .type = promoted.type, .integer = ConstantFolder_Truncate(~promoted.integer, promoted.type) };
+			return true;
+		default:
+			return false;
+	}
+}
+
+bool ConstantFolder_EvaluateBinary(const AstBinaryOperation operation, const ConstantFolder_Value* left, const ConstantFolder_Value* right,
+                                   ConstantFolder_Value* outValue)
+{
+	switch (operation)
+	{
+		case AST_BINOP_LOGICAL_AND:
+			*outValue = ConstantFolder_MakeInt(ConstantFolder_IsNonzero(left) && ConstantFolder_IsNonzero(right));
+			return true;
+		case AST_BINOP_LOGICAL_OR:
+			*outValue = ConstantFolder_MakeInt(ConstantFolder_IsNonzero(left) || ConstantFolder_IsNonzero(right));
+			return true;
+		case AST_BINOP_SHIFT_LEFT:
+		case AST_BINOP_SHIFT_RIGHT:
+			return ConstantFolder_EvaluateShift(operation, left, right, outValue);
+		case AST_BINOP_BITWISE_OR:
+		case AST_BINOP_BITWISE_XOR:
+		case AST_BINOP_BITWISE_AND:
+		case AST_BINOP_TEST_EQUAL:
+		case AST_BINOP_TEST_NOT_EQUAL:
+		case AST_BINOP_TEST_LESS:
+		case AST_BINOP_TEST_GREATER:
+		case AST_BINOP_TEST_LESS_EQUAL:
+		case AST_BINOP_TEST_GREATER_EQUAL:
+		case AST_BINOP_ADD:
+		case AST_BINOP_SUBTRACT:
+		case AST_BINOP_MULTIPLY:
+		case AST_BINOP_DIVIDE:
+		case AST_BINOP_MODULO:
+			break;
+		default:
+			// Assignments, the comma operator and subscripts are never constant
+			return false;
+	}
+
+	// Usual arithmetic conversions
+	const ConstantFolder_Type type = ConstantFolder_GetCommonType(left->type, right->type);
+	const ConstantFolder_TypeInfo* info = &ConstantFolder_TypeInfos[type];
+	ConstantFolder_Value a;
+	ConstantFolder_Value b;
+	if (!ConstantFolder_Convert(left, type, &a) || !ConstantFolder_Convert(right, type, &b))
+		return false;
+
+	switch (operation)
+	{
+		case AST_BINOP_TEST_EQUAL:
+			*outValue = ConstantFolder_MakeInt(info->isFloating ? a.floating == b.floating : a.integer == b.integer);
+			return true;
+		case AST_BINOP_TEST_NOT_EQUAL:
+			*outValue = ConstantFolder_MakeInt(info->isFloating ? a.floating != b.floating : a.integer != b.integer);
+			return true;
+		case AST_BINOP_TEST_LESS:
+		case AST_BINOP_TEST_GREATER:
+		case AST_BINOP_TEST_LESS_EQUAL:
+		case AST_BINOP_TEST_GREATER_EQUAL:
+		{
+			// -1, 0 or 1, or 2 if unordered
+			const int order = info->isFloating
+				                  ? (a.floating < b.floating ? -1 : a.floating > b.floating ? 1 : a.floating == b.floating ? 0 : 2)
+				                  : info->isSigned
+				                  ? ((int64_t)a.integer < (int64_t)b.integer ? -1 : (int64_t)a.integer > (int64_t)b.integer)
+				                  : (a.integer < b.integer ? -1 : a.integer > b.integer);
+			const bool isTrue = operation == AST_BINOP_TEST_LESS
+				                    ? order == -1
+				                    : operation == AST_BINOP_TEST_GREATER
+				                    ? order == 1
+				                    : operation == AST_BINOP_TEST_LESS_EQUAL
+				                    ? order == -1 || order == 0
+				                    : order == 1 || order == 0;
+			*outValue = ConstantFolder_MakeInt(isTrue);
+			return true;
+		}
+		default:
+			break;
+	}
+
+	outValue->type = type;
+	if (!info->isFloating)
+		return ConstantFolder_EvaluateIntegerBinary(operation, type, a.integer, b.integer, &outValue->integer);
+
+	double result;
+	switch (operation)
+	{
+		case AST_BINOP_ADD:
+			result = a.floating + b.floating;
+			break;
+		case AST_BINOP_SUBTRACT:
+			result = a.floating - b.floating;
+			break;
+		case AST_BINOP_MULTIPLY:
+			result = a.floating * b.floating;
+			break;
+		case AST_BINOP_DIVIDE:
+			if (b.floating == 0.0)
+				return false;
+			result = a.floating / b.floating;
+			break;
+		default:
+			// Bitwise operators and '%' take integers only
+			return false;
+	}
+
+	// Float operations are exact in double and rounded once, which gives the float result
+	if (type == CONSTANT_TYPE_FLOAT)
+		result = (double)(float)result;
+
+	// Leave overflow to the compiler's own floating point environment
+	if (!isfinite(result))
+		return false;
+
+	outValue->floating = result;
+	return true;
+}
+
+bool ConstantFolder_EvaluateIntegerBinary(const AstBinaryOperation operation, const ConstantFolder_Type type, const uint64_t left,
+                                          const uint64_t right, uint64_t* outValue)
+{
+	const ConstantFolder_TypeInfo* info = &ConstantFolder_TypeInfos[type];
+	if (!info->isSigned)
+	{
+		uint64_t result;
+		switch (operation)
+		{
+			case AST_BINOP_ADD:
+				result = left + right;
+				break;
+			case AST_BINOP_SUBTRACT:
+				result = left - right;
+				break;
+			case AST_BINOP_MULTIPLY:
+				result = left * right;
+				break;
+			case AST_BINOP_DIVIDE:
+				if (right == 0)
+					return false;
+				result = left / right;
+				break;
+			case AST_BINOP_MODULO:
+				if (right == 0)
+					return false;
+				result = left % right;
+				break;
+			case AST_BINOP_BITWISE_OR:
+				result = left | right;
+				break;
+			case AST_BINOP_BITWISE_XOR:
+				result = left ^ right;
+				break;
+			case AST_BINOP_BITWISE_AND:
+				result = left & right;
+				break;
+			default:
+				return false;
+		}
+
+		// Unsigned arithmetic wraps around
+		*outValue = ConstantFolder_Truncate(result, type);
+		return true;
+	}
+
+	const int64_t a = (int64_t)left;
+	const int64_t b = (int64_t)right;
+	int64_t result;
+	switch (operation)
+	{
+		case AST_BINOP_ADD:
+			if (__builtin_add_overflow(a, b, &result))
+				return false;
+			break;
+		case AST_BINOP_SUBTRACT:
+			if (__builtin_sub_overflow(a, b, &result))
+				return false;
+			break;
+		case AST_BINOP_MULTIPLY:
+			if (__builtin_mul_overflow(a, b, &result))
+				return false;
+			break;
+		case AST_BINOP_DIVIDE:
+			if (b == 0 || (a == INT64_MIN && b == -1))
+				return false;
+			result = a / b;
+			break;
+		case AST_BINOP_MODULO:
+			if (b == 0 || (a == INT64_MIN && b == -1))
+				return false;
+			result = a % b;
+			break;
+		case AST_BINOP_BITWISE_OR:
+			result = a | b;
+			break;
+		case AST_BINOP_BITWISE_XOR:
+			result = a ^ b;
+			break;
+		case AST_BINOP_BITWISE_AND:
+			result = a & b;
+			break;
+		default:
+			return false;
+	}
+
+	// Signed overflow is undefined; narrower types overflow when the exact result does not survive truncation
+	if (ConstantFolder_Truncate((uint64_t)result, type) != (uint64_t)result)
+		return false;
+
+	*outValue = (uint64_t)result;
+	return true;
+}
+
+bool ConstantFolder_EvaluateShift(const AstBinaryOperation operation, const ConstantFolder_Value* left, const ConstantFolder_Value* right,
+                                  ConstantFolder_Value* outValue)
+{
+	// Both operands are promoted on their own; the result has the type of the left one
+	if (ConstantFolder_TypeInfos[left->type].isFloating || ConstantFolder_TypeInfos[right->type].isFloating)
+		return false;
+
+	ConstantFolder_Value a;
+	ConstantFolder_Value count;
+	if (!ConstantFolder_Convert(left, ConstantFolder_Promote(left->type), &a) || !ConstantFolder_Convert(right, ConstantFolder_Promote(right->type), &count))
+		return false;
+
+	const ConstantFolder_TypeInfo* info = &ConstantFolder_TypeInfos[a.type];
+	const unsigned width = info->size * 8u;
+	if ((ConstantFolder_TypeInfos[count.type].isSigned && (int64_t)count.integer < 0) || count.integer >= width)
+		return false;
+
+	outValue->type = a.type;
+	if (operation == AST_BINOP_SHIFT_LEFT)
+	{
+		if (!info->isSigned)
+		{
+			outValue->integer = ConstantFolder_Truncate(a.integer << count.integer, a.type);
+			return true;
+		}
+
+		// Shifting a negative value, or a one into or past the sign bit, is undefined
+		const int64_t max = (int64_t)(UINT64_MAX >> (65 - width));
+		if ((int64_t)a.integer < 0 || (int64_t)a.integer > max >> count.integer)
+			return false;
+		outValue->integer = a.integer << count.integer;
+		return true;
+	}
+
+	// Right shifts of negative values are arithmetic, as implementation-defined for GCC and Clang
+	outValue->integer = info->isSigned ? (uint64_t)((int64_t)a.integer >> count.integer) : a.integer >> count.integer;
+	return true;
+}
+
+bool ConstantFolder_Convert(const ConstantFolder_Value* value, const ConstantFolder_Type type, ConstantFolder_Value* outValue)
+{
+	const ConstantFolder_TypeInfo* from = &ConstantFolder_TypeInfos[value->type];
+	const ConstantFolder_TypeInfo* to = &ConstantFolder_TypeInfos[type];
+	outValue->type = type;
+
+	if (!from->isFloating && !to->isFloating)
+	{
+		// Out-of-range conversions to signed types wrap, as implementation-defined for GCC and Clang
+		outValue->integer = ConstantFolder_Truncate(value->integer, type);
+		return true;
+	}
+
+	if (!from->isFloating)
+	{
+		// Convert straight to the target type, as rounding to double first could round twice
+		if (type == CONSTANT_TYPE_FLOAT)
+			outValue->floating = from->isSigned ? (double)(float)(int64_t)value->integer : (double)(float)value->integer;
+		else
+			outValue->floating = from->isSigned ? (double)(int64_t)value->integer : (double)value->integer;
+		return true;
+	}
+
+	if (to->isFloating)
+	{
+		outValue->floating = type == CONSTANT_TYPE_FLOAT ? (double)(float)value->floating : value->floating;
+		return isfinite(outValue->floating);
+	}
+
+	// Floating to integer truncates, and is undefined if the result is out of range
+	const double truncated = trunc(value->floating);
+	const double limit = ldexp(1.0, to->size * 8 - to->isSigned);
+	if (isnan(truncated) || truncated >= limit || truncated < (to->isSigned ? -limit : 0.0))
+		return false;
+
+	outValue->integer = to->isSigned ? (uint64_t)(int64_t)truncated : (uint64_t)truncated;
+	return true;
+}
+
+// Only plain arithmetic types are known; typedef names, tags and long double are not folded
+bool ConstantFolder_GetTypeNameType(const AstTypeName* typeName, ConstantFolder_Type* outType)
+{
+	size_t counts[AST_TYPESPECIFIER_TYPEDEF_NAME + 1] = { 0 };
+	const AstTypeSpecifierList* specifiers = typeName->specifierQualifierList->specifiers;
+	for (size_t i = 0; i < specifiers->size; i++)
+		counts[specifiers->data[i]->type]++;
+
+	if (counts[AST_TYPESPECIFIER_VOID] || counts[AST_TYPESPECIFIER_STRUCT] || counts[AST_TYPESPECIFIER_UNION] ||
+	    counts[AST_TYPESPECIFIER_ENUM] || counts[AST_TYPESPECIFIER_TYPEDEF_NAME])
+		return false;
+
+	const size_t isSigned = counts[AST_TYPESPECIFIER_SIGNED];
+	const size_t isUnsigned = counts[AST_TYPESPECIFIER_UNSIGNED];
+	const size_t charCount = counts[AST_TYPESPECIFIER_CHAR];
+	const size_t shortCount = counts[AST_TYPESPECIFIER_SHORT];
+	const size_t intCount = counts[AST_TYPESPECIFIER_INT];
+	const size_t longCount = counts[AST_TYPESPECIFIER_LONG];
+	const size_t floatCount = counts[AST_TYPESPECIFIER_FLOAT];
+	const size_t doubleCount = counts[AST_TYPESPECIFIER_DOUBLE];
+	if (isSigned + isUnsigned > 1 || intCount > 1)
+		return false;
+
+	if (floatCount || doubleCount)
+	{
+		if (floatCount + doubleCount != 1 || isSigned || isUnsigned || charCount || shortCount || intCount || longCount)
+			return false;
+		*outType = floatCount ? CONSTANT_TYPE_FLOAT : CONSTANT_TYPE_DOUBLE;
+		return true;
+	}
+
+	if (charCount)
+	{
+		if (charCount != 1 || shortCount || intCount || longCount)
+			return false;
+		*outType = isSigned ? CONSTANT_TYPE_SIGNED_CHAR : isUnsigned ? CONSTANT_TYPE_UNSIGNED_CHAR : CONSTANT_TYPE_CHAR;
+		return true;
+	}
+
+	if (shortCount + longCount == 0 && intCount + isSigned + isUnsigned == 0)
+		return false;
+	if (shortCount > 1 || longCount > 2 || (shortCount && longCount))
+		return false;
+
+	const ConstantFolder_Type type = shortCount ? CONSTANT_TYPE_SHORT
+		                                 : longCount == 2 ? CONSTANT_TYPE_LONG_LONG
+		                                 : longCount == 1 ? CONSTANT_TYPE_LONG
+		                                 : CONSTANT_TYPE_INT;
+	*outType = (ConstantFolder_Type)(type + (isUnsigned ? 1 : 0));
+	return true;
+}
+
+// Integer promotions: every type narrower than int fits in int
+ConstantFolder_Type ConstantFolder_Promote(const ConstantFolder_Type type)
+{
+	return type < CONSTANT_TYPE_INT ? CONSTANT_TYPE_INT : type;
+}
+
+ConstantFolder_Type ConstantFolder_GetCommonType(const ConstantFolder_Type first, const ConstantFolder_Type second)
+{
+	const ConstantFolder_TypeInfo* firstInfo = &ConstantFolder_TypeInfos[first];
+	const ConstantFolder_TypeInfo* secondInfo = &ConstantFolder_TypeInfos[second];
+	if (firstInfo->isFloating || secondInfo->isFloating)
+	{
+		if (!secondInfo->isFloating)
+			return first;
+		if (!firstInfo->isFloating)
+			return second;
+		return firstInfo->rank >= secondInfo->rank ? first : second;
+	}
+
+	const ConstantFolder_Type a = ConstantFolder_Promote(first);
+	const ConstantFolder_Type b = ConstantFolder_Promote(second);
+	const ConstantFolder_TypeInfo* aInfo = &ConstantFolder_TypeInfos[a];
+	const ConstantFolder_TypeInfo* bInfo = &ConstantFolder_TypeInfos[b];
+	if (a == b)
+		return a;
+	if (aInfo->isSigned == bInfo->isSigned)
+		return aInfo->rank >= bInfo->rank ? a : b;
+
+	const ConstantFolder_Type unsignedType = aInfo->isSigned ? b : a;
+	const ConstantFolder_Type signedType = aInfo->isSigned ? a : b;
+	if (ConstantFolder_TypeInfos[unsignedType].rank >= ConstantFolder_TypeInfos[signedType].rank)
+		return unsignedType;
+	if (ConstantFolder_TypeInfos[signedType].size > ConstantFolder_TypeInfos[unsignedType].size)
+		return signedType;
+	return (ConstantFolder_Type)(signedType + 1);
+}
+
+uint64_t ConstantFolder_Truncate(const uint64_t value, const ConstantFolder_Type type)
+{
+	const ConstantFolder_TypeInfo* info = &ConstantFolder_TypeInfos[type];
+	const unsigned width = info->size * 8u;
+	if (width == 64)
+		return value;
+
+	const uint64_t truncated = value & ((UINT64_C(1) << width) - 1);
+	const uint64_t signBit = UINT64_C(1) << (width - 1);
+	return info->isSigned && (truncated & signBit) ? truncated | ~((UINT64_C(1) << width) - 1) : truncated;
+}
+
+bool ConstantFolder_IsNonzero(const ConstantFolder_Value* value)
+{
+	return ConstantFolder_TypeInfos[value->type].isFloating ? value->floating != 0.0 : value->integer != 0;
+}
+
+ConstantFolder_Value ConstantFolder_MakeInt(const bool value)
+{
+	return (ConstantFolder_Value) { .type = CONSTANT_TYPE_INT, .integer = value };
+}
+
+nullable_end
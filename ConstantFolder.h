@@ -0,0 +1,26 @@
+#pragma once
+
+#include "AstExpression.h"
+#include "Util/Arena.h"
+
+nullable_begin
+
+// Replaces integer and floating constant subexpressions with single folded AST_EXPR_PRIMARY nodes. Evaluation follows
+// C on an LP64 target (32-bit int, 64-bit long and long long, signed plain char): literal types, integer promotions,
+// usual arithmetic conversions and casts between arithmetic types. Anything with undefined behavior, such as signed
+// overflow, division by zero or an out-of-range shift count, is left as it is.
+typedef struct
+{
+	// New nodes are allocated here, or on the heap if NULL; replaced subtrees are released
+	Arena*nullable arena;
+	size_t foldedNodeCount;
+	// Nodes replaced by folded ones, counting the replacements' subtrees
+	size_t removedNodeCount;
+} ConstantFolder;
+
+ConstantFolder ConstantFolder_Create(Arena*nullable arena);
+
+// Folds expression in place and returns it, or the node that replaced it
+AstExpression* ConstantFolder_Fold(ConstantFolder* self, AstExpression* expression);
+
+nullable_end
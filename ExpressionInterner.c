@@ -0,0 +1,280 @@
+#include "ExpressionInterner.h"
+
+nullable_begin
+
+#define EXPRESSIONINTERNER_INITIAL_SLOT_COUNT 256
+
+// An expression whose children are not all interned yet, and the field that receives its shared node
+typedef struct
+{
+	AstExpression** slot;
+	uint32_t nextChild;
+	uint32_t childCount;
+} ExpressionInterner_Frame;
+
+nullable_end
+
+#define LIST_TYPE ExpressionInterner_FrameList
+#define LIST_ELEMENT_TYPE ExpressionInterner_Frame
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+nullable_begin
+
+static AstExpression* ExpressionInterner_InternNode(ExpressionInterner* self, AstExpression* expression);
+
+static uint64_t ExpressionInterner_Mix(uint64_t hash, uint64_t word);
+static uint64_t ExpressionInterner_HashTypeName(uint64_t hash, const AstTypeName* typeName);
+static uint32_t ExpressionInterner_Hash(const AstExpression* expression, uint32_t lexeme);
+static bool ExpressionInterner_TypeNamesEqual(const AstTypeName* first, const AstTypeName* second);
+static bool ExpressionInterner_Equals(const ExpressionInterner_Entry* entry, const AstExpression* expression, uint32_t lexeme);
+static void ExpressionInterner_Rehash(ExpressionInterner* self, size_t newSlotCount);
+
+ExpressionInterner* ExpressionInterner_Init(ExpressionInterner* self)
+{
+	ExpressionInterner_EntryList_Init(&self->entries);
+	Interner_Init(&self->lexemes);
+	self->sharedNodeCount = 0;
+
+	self->slotCount = EXPRESSIONINTERNER_INITIAL_SLOT_COUNT;
+	self->slots = (uint32_t*)calloc(self->slotCount, sizeof(uint32_t));
+	if (self->slots == NULL)
+		abort();
+
+	return self;
+}
+
+void ExpressionInterner_Fini(const ExpressionInterner* self)
+{
+	for (size_t i = 0; i < self->entries.size; i++)
+		Release(self->entries.data[i].expression);
+	ExpressionInterner_EntryList_Fini(&self->entries);
+	Interner_Fini(&self->lexemes);
+	free(self->slots);
+}
+
+AstExpression* ExpressionInterner_Intern(ExpressionInterner* self, AstExpression* expression)
+{
+	// Children first, so that equal subtrees are already the same node and can be compared by pointer
+	AstExpression* root = expression;
+	ExpressionInterner_FrameList stack;
+	ExpressionInterner_FrameList_Init(&stack);
+	const ExpressionInterner_Frame rootFrame = { &root, 0, (uint32_t)AstExpression_GetChildCount(root) };
+	ExpressionInterner_FrameList_AppendFromPtr(&stack, &rootFrame);
+
+	while (stack.size != 0)
+	{
+		ExpressionInterner_Frame* frame = &stack.data[stack.size - 1];
+		if (frame->nextChild != frame->childCount)
+		{
+			AstExpression** slot = AstExpression_GetChildSlot(*frame->slot, frame->nextChild++);
+			// Appending may move the stack, so frame is not used past this point
+			const ExpressionInterner_Frame childFrame = { slot, 0, (uint32_t)AstExpression_GetChildCount(*slot) };
+			ExpressionInterner_FrameList_AppendFromPtr(&stack, &childFrame);
+			continue;
+		}
+
+		*frame->slot = ExpressionInterner_InternNode(self, *frame->slot);
+		stack.size--;
+	}
+
+	ExpressionInterner_FrameList_Fini(&stack);
+	return root;
+}
+
+AstExpression* ExpressionInterner_InternNode(ExpressionInterner* self, AstExpression* expression)
+{
+	uint32_t lexeme = 0;
+	if (expression->type == AST_EXPR_MEMBER_ACCESS)
+		lexeme = Interner_Intern(&self->lexemes, expression->data.memberAccess.memberName);
+	else if (expression->type == AST_EXPR_PRIMARY)
+	{
+		if (expression->data.primary.isFolded)
+			return expression;
+		lexeme = Interner_Intern(&self->lexemes, expression->location.snippet);
+	}
+
+	const uint32_t hash = ExpressionInterner_Hash(expression, lexeme);
+
+	size_t slot = hash & (self->slotCount - 1);
+	while (self->slots[slot] != 0)
+	{
+		const ExpressionInterner_Entry* entry = &self->entries.data[self->slots[slot] - 1];
+		if (entry->expression == expression)
+			return expression;
+		if (entry->hash == hash && ExpressionInterner_Equals(entry, expression, lexeme))
+		{
+			self->sharedNodeCount++;
+			Release(expression);
+			return Retain(entry->expression);
+		}
+
+		slot = (slot + 1) & (self->slotCount - 1);
+	}
+
+	assert(self->entries.size < UINT32_MAX - 1);
+	const ExpressionInterner_Entry entry = { Retain(expression), hash, lexeme };
+	ExpressionInterner_EntryList_AppendFromPtr(&self->entries, &entry);
+	self->slots[slot] = (uint32_t)self->entries.size;
+
+	// Keep the load factor at or below 1/2
+	if (self->entries.size * 2 > self->slotCount)
+		ExpressionInterner_Rehash(self, self->slotCount * 2);
+
+	return expression;
+}
+
+size_t ExpressionInterner_GetCount(const ExpressionInterner* self)
+{
+	return self->entries.size;
+}
+
+uint64_t ExpressionInterner_Mix(const uint64_t hash, const uint64_t word)
+{
+	const uint64_t mixed = (hash ^ word) * 0xFF51AFD7ED558CCDu;
+	return mixed ^ (mixed >> 32);
+}
+
+uint64_t ExpressionInterner_HashTypeName(uint64_t hash, const AstTypeName* typeName)
+{
+	const AstTypeSpecifierQualifierList* list = typeName->specifierQualifierList;
+	hash = ExpressionInterner_Mix(hash, list->qualifiers);
+	for (size_t i = 0; i < list->specifiers->size; i++)
+	{
+		const AstTypeSpecifier* specifier = list->specifiers->data[i];
+		hash = ExpressionInterner_Mix(hash, (uint64_t)specifier->type << 32 | specifier->symbol);
+	}
+	return hash;
+}
+
+uint32_t ExpressionInterner_Hash(const AstExpression* expression, const uint32_t lexeme)
+{
+	uint64_t hash = ExpressionInterner_Mix(expression->type * 0x9E3779B97F4A7C15u, lexeme);
+	switch (expression->type)
+	{
+		case AST_EXPR_UNARY:
+			hash = ExpressionInterner_Mix(hash, expression->data.unary.operation);
+			hash = ExpressionInterner_Mix(hash, (uintptr_t)expression->data.unary.expression);
+			break;
+		case AST_EXPR_BINARY:
+			hash = ExpressionInterner_Mix(hash, expression->data.binary.operation);
+			hash = ExpressionInterner_Mix(hash, (uintptr_t)expression->data.binary.left);
+			hash = ExpressionInterner_Mix(hash, (uintptr_t)expression->data.binary.right);
+			break;
+		case AST_EXPR_TERNARY:
+			hash = ExpressionInterner_Mix(hash, expression->data.ternary.operation);
+			hash = ExpressionInterner_Mix(hash, (uintptr_t)expression->data.ternary.left);
+			hash = ExpressionInterner_Mix(hash, (uintptr_t)expression->data.ternary.middle);
+			hash = ExpressionInterner_Mix(hash, (uintptr_t)expression->data.ternary.right);
+			break;
+		case AST_EXPR_CAST:
+			hash = ExpressionInterner_HashTypeName(hash, expression->data.cast.typeName);
+			hash = ExpressionInterner_Mix(hash, (uintptr_t)expression->data.cast.expression);
+			break;
+		case AST_EXPR_SIZEOF_TYPE:
+			hash = ExpressionInterner_HashTypeName(hash, expression->data.sizeofType.typeName);
+			break;
+		case AST_EXPR_MEMBER_ACCESS:
+			hash = ExpressionInterner_Mix(hash, expression->data.memberAccess.isPointerAccess);
+			hash = ExpressionInterner_Mix(hash, (uintptr_t)expression->data.memberAccess.expression);
+			break;
+		case AST_EXPR_CALL:
+			hash = ExpressionInterner_Mix(hash, (uintptr_t)expression->data.call.callee);
+			for (size_t i = 0; i < expression->data.call.arguments->size; i++)
+				hash = ExpressionInterner_Mix(hash, (uintptr_t)expression->data.call.arguments->data[i]);
+			break;
+		case AST_EXPR_PRIMARY:
+			hash = ExpressionInterner_Mix(hash, expression->data.primary.literal.type);
+			break;
+		default:
+			break;
+	}
+	return (uint32_t)hash;
+}
+
+bool ExpressionInterner_TypeNamesEqual(const AstTypeName* first, const AstTypeName* second)
+{
+	const AstTypeSpecifierQualifierList* firstList = first->specifierQualifierList;
+	const AstTypeSpecifierQualifierList* secondList = second->specifierQualifierList;
+	if (firstList->qualifiers != secondList->qualifiers || firstList->specifiers->size != secondList->specifiers->size)
+		return false;
+
+	for (size_t i = 0; i < firstList->specifiers->size; i++)
+	{
+		const AstTypeSpecifier* firstSpecifier = firstList->specifiers->data[i];
+		const AstTypeSpecifier* secondSpecifier = secondList->specifiers->data[i];
+		if (firstSpecifier->type != secondSpecifier->type || firstSpecifier->symbol != secondSpecifier->symbol)
+			return false;
+	}
+	return true;
+}
+
+bool ExpressionInterner_Equals(const ExpressionInterner_Entry* entry, const AstExpression* expression, const uint32_t lexeme)
+{
+	const AstExpression* other = entry->expression;
+	if (other->type != expression->type || entry->lexeme != lexeme)
+		return false;
+
+	switch (expression->type)
+	{
+		case AST_EXPR_UNARY:
+			return other->data.unary.operation == expression->data.unary.operation &&
+			       other->data.unary.expression == expression->data.unary.expression;
+		case AST_EXPR_BINARY:
+			return other->data.binary.operation == expression->data.binary.operation &&
+			       other->data.binary.left == expression->data.binary.left && other->data.binary.right == expression->data.binary.right;
+		case AST_EXPR_TERNARY:
+			return other->data.ternary.operation == expression->data.ternary.operation &&
+			       other->data.ternary.left == expression->data.ternary.left &&
+			       other->data.ternary.middle == expression->data.ternary.middle &&
+			       other->data.ternary.right == expression->data.ternary.right;
+		case AST_EXPR_CAST:
+			return other->data.cast.expression == expression->data.cast.expression &&
+			       ExpressionInterner_TypeNamesEqual(other->data.cast.typeName, expression->data.cast.typeName);
+		case AST_EXPR_SIZEOF_TYPE:
+			return ExpressionInterner_TypeNamesEqual(other->data.sizeofType.typeName, expression->data.sizeofType.typeName);
+		case AST_EXPR_MEMBER_ACCESS:
+			return other->data.memberAccess.isPointerAccess == expression->data.memberAccess.isPointerAccess &&
+			       other->data.memberAccess.expression == expression->data.memberAccess.expression;
+		case AST_EXPR_CALL:
+		{
+			const AstExpressionList* otherArguments = other->data.call.arguments;
+			const AstExpressionList* arguments = expression->data.call.arguments;
+			if (other->data.call.callee != expression->data.call.callee || otherArguments->size != arguments->size)
+				return false;
+			for (size_t i = 0; i < arguments->size; i++)
+			{
+				if (otherArguments->data[i] != arguments->data[i])
+					return false;
+			}
+			return true;
+		}
+		case AST_EXPR_PRIMARY:
+			return other->data.primary.literal.type == expression->data.primary.literal.type;
+		default:
+			return false;
+	}
+}
+
+void ExpressionInterner_Rehash(ExpressionInterner* self, const size_t newSlotCount)
+{
+	uint32_t* slots = (uint32_t*)calloc(newSlotCount, sizeof(uint32_t));
+	if (slots == NULL)
+		abort();
+
+	for (size_t index = 0; index < self->entries.size; index++)
+	{
+		size_t slot = self->entries.data[index].hash & (newSlotCount - 1);
+		while (slots[slot] != 0)
+			slot = (slot + 1) & (newSlotCount - 1);
+
+		slots[slot] = (uint32_t)index + 1;
+	}
+
+	free(self->slots);
+	self->slots = slots;
+	self->slotCount = newSlotCount;
+}
+
+nullable_end
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "AstExpression.h"
+#include "Util/Interner.h"
+
+nullable_begin
+
+typedef struct
+{
+	AstExpression* expression;
+	uint32_t hash;
+	// Interned lexeme of a primary expression or member name, 0 otherwise
+	uint32_t lexeme;
+} ExpressionInterner_Entry;
+
+#define LIST_TYPE ExpressionInterner_EntryList
+#define LIST_ELEMENT_TYPE ExpressionInterner_Entry
+nullable_end
+#include "Util/ListDef.h"
+nullable_begin
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+// Hash-conses expressions: structurally equal subexpressions are replaced by one shared node, so that they can be
+// compared by pointer. Nodes are keyed on their operation and the identity of their (already shared) children, with
+// literals and identifiers keyed on their lexeme and casts on their type name. Locations are not part of the key, so a
+// shared node keeps the location of its first occurrence. Folded constants are never shared.
+typedef struct
+{
+	// Every distinct expression, each holding a reference to it
+	ExpressionInterner_EntryList entries;
+	Interner lexemes;
+	// Open-addressing hash table of entry index + 1 (0 marks an empty slot)
+	uint32_t* slots;
+	size_t slotCount; // Power of two
+	// Nodes replaced by a shared one, not counting their subtrees
+	size_t sharedNodeCount;
+} ExpressionInterner;
+
+ExpressionInterner* ExpressionInterner_Init(ExpressionInterner* self);
+void ExpressionInterner_Fini(const ExpressionInterner* self);
+
+// Takes over the reference to expression and returns a reference to the shared node equal to it. The children of
+// expression are shared in place; interned nodes must not be changed afterwards while the interner is in use.
+AstExpression* ExpressionInterner_Intern(ExpressionInterner* self, AstExpression* expression);
+size_t ExpressionInterner_GetCount(const ExpressionInterner* self);
+
+nullable_end
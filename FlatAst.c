@@ -0,0 +1,388 @@
+#include "FlatAst.h"
+
+nullable_begin
+
+typedef struct
+{
+	FlatAst_Node node;
+	uint32_t nextChild;
+	uint32_t childCount;
+	// Whether the child before nextChild was entered and still needs its leaveChild call
+	bool inChild;
+} FlatAst_WalkFrame;
+
+// An expression being added whose children are not all added yet
+typedef struct
+{
+	const AstExpression* expression;
+	uint32_t nextChild;
+	uint32_t childCount;
+	// Casts and sizeof(<type>): the type name, added before the operand
+	uint32_t typeName;
+} FlatAst_AddFrame;
+
+nullable_end
+
+#define LIST_TYPE FlatAst_WalkFrameList
+#define LIST_ELEMENT_TYPE FlatAst_WalkFrame
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE FlatAst_AddFrameList
+#define LIST_ELEMENT_TYPE FlatAst_AddFrame
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+nullable_begin
+
+static FlatAst_Node FlatAst_AddExpression(FlatAst* self, const AstExpression* expression);
+static void FlatAst_PushAddFrame(FlatAst* self, FlatAst_AddFrameList* stack, const AstExpression* expression);
+static FlatAst_Node FlatAst_AddExpressionNode(FlatAst* self, const FlatAst_AddFrame* frame, const FlatAst_Node* children);
+static uint32_t FlatAst_AddTypeName(FlatAst* self, const AstTypeName* typeName);
+static FlatAst_Node FlatAst_AddNode(FlatAst* self, AstExpression_Type type, size_t payload, const SourceLocation* location);
+static FlatAst_Span FlatAst_Span_FromLocation(const SourceLocation* location);
+static void FlatAst_PushFrame(FlatAst_WalkFrameList* stack, const FlatAst* ast, FlatAst_Node node, const FlatAst_Visitor* visitor);
+
+FlatAst* FlatAst_Init_WithSource(FlatAst* self, const SourceFile* source)
+{
+	self->source = source;
+	UInt8List_Init(&self->types);
+	UInt32List_Init(&self->payloads);
+	FlatAst_SpanList_Init(&self->locations);
+	FlatAst_UnaryList_Init(&self->unaries);
+	FlatAst_BinaryList_Init(&self->binaries);
+	FlatAst_TernaryList_Init(&self->ternaries);
+	FlatAst_CastList_Init(&self->casts);
+	FlatAst_SizeofTypeList_Init(&self->sizeofTypes);
+	FlatAst_MemberAccessList_Init(&self->memberAccesses);
+	FlatAst_CallList_Init(&self->calls);
+	FlatAst_PrimaryList_Init(&self->primaries);
+	UInt32List_Init(&self->arguments);
+	FlatAst_TypeNameList_Init(&self->typeNames);
+	FlatAst_TypeSpecifierList_Init(&self->typeSpecifiers);
+	UInt32List_Init(&self->roots);
+	return self;
+}
+
+void FlatAst_Fini(const FlatAst* self)
+{
+	UInt8List_Fini(&self->types);
+	UInt32List_Fini(&self->payloads);
+	FlatAst_SpanList_Fini(&self->locations);
+	FlatAst_UnaryList_Fini(&self->unaries);
+	FlatAst_BinaryList_Fini(&self->binaries);
+	FlatAst_TernaryList_Fini(&self->ternaries);
+	FlatAst_CastList_Fini(&self->casts);
+	FlatAst_SizeofTypeList_Fini(&self->sizeofTypes);
+	FlatAst_MemberAccessList_Fini(&self->memberAccesses);
+	FlatAst_CallList_Fini(&self->calls);
+	FlatAst_PrimaryList_Fini(&self->primaries);
+	UInt32List_Fini(&self->arguments);
+	FlatAst_TypeNameList_Fini(&self->typeNames);
+	FlatAst_TypeSpecifierList_Fini(&self->typeSpecifiers);
+	UInt32List_Fini(&self->roots);
+}
+
+FlatAst_Node FlatAst_AppendExpression(FlatAst* self, const AstExpression* expression)
+{
+	const FlatAst_Node root = FlatAst_AddExpression(self, expression);
+	UInt32List_Append(&self->roots, root);
+	return root;
+}
+
+size_t FlatAst_GetChildCount(const FlatAst* self, const FlatAst_Node node)
+{
+	switch (FlatAst_GetType(self, node))
+	{
+		case AST_EXPR_UNARY:
+		case AST_EXPR_CAST:
+		case AST_EXPR_MEMBER_ACCESS:
+			return 1;
+		case AST_EXPR_BINARY:
+			return 2;
+		case AST_EXPR_TERNARY:
+			return 3;
+		case AST_EXPR_CALL:
+			return 1 + (size_t)FlatAst_GetCall(self, node)->argumentCount;
+		case AST_EXPR_SIZEOF_TYPE:
+		case AST_EXPR_PRIMARY:
+		default:
+			return 0;
+	}
+}
+
+FlatAst_Node FlatAst_GetChild(const FlatAst* self, const FlatAst_Node node, const size_t index)
+{
+	assert(index < FlatAst_GetChildCount(self, node));
+	switch (FlatAst_GetType(self, node))
+	{
+		case AST_EXPR_UNARY:
+			return FlatAst_GetUnary(self, node)->operand;
+		case AST_EXPR_CAST:
+			return FlatAst_GetCast(self, node)->operand;
+		case AST_EXPR_MEMBER_ACCESS:
+			return FlatAst_GetMemberAccess(self, node)->operand;
+		case AST_EXPR_BINARY:
+		{
+			const FlatAst_Binary* binary = FlatAst_GetBinary(self, node);
+			return index == 0 ? binary->left : binary->right;
+		}
+		case AST_EXPR_TERNARY:
+		{
+			const FlatAst_Ternary* ternary = FlatAst_GetTernary(self, node);
+			return index == 0 ? ternary->left : index == 1 ? ternary->middle : ternary->right;
+		}
+		case AST_EXPR_CALL:
+		{
+			const FlatAst_Call* call = FlatAst_GetCall(self, node);
+			return index == 0 ? call->callee : self->arguments.data[call->firstArgument + index - 1];
+		}
+		default:
+			assert(false && "unreachable (node has no children)");
+			return FLAT_AST_NO_NODE;
+	}
+}
+
+void FlatAst_Walk(const FlatAst* self, const FlatAst_Node node, const FlatAst_Visitor* visitor)
+{
+	FlatAst_WalkFrameList stack;
+	FlatAst_WalkFrameList_Init(&stack);
+	FlatAst_PushFrame(&stack, self, node, visitor);
+
+	while (stack.size != 0)
+	{
+		FlatAst_WalkFrame* frame = &stack.data[stack.size - 1];
+		if (frame->inChild)
+		{
+			frame->inChild = false;
+			if (visitor->leaveChild)
+				visitor->leaveChild(visitor->context, self, frame->node, frame->nextChild - 1);
+		}
+
+		if (frame->nextChild == frame->childCount)
+		{
+			if (visitor->leave)
+				visitor->leave(visitor->context, self, frame->node);
+			stack.size--;
+			continue;
+		}
+
+		const size_t index = frame->nextChild++;
+		if (visitor->enterChild && !visitor->enterChild(visitor->context, self, frame->node, index))
+			continue;
+
+		frame->inChild = true;
+		// Pushing may move the stack, so frame is not used past this point
+		FlatAst_PushFrame(&stack, self, FlatAst_GetChild(self, frame->node, index), visitor);
+	}
+
+	FlatAst_WalkFrameList_Fini(&stack);
+}
+
+FlatAst_Node FlatAst_AddExpression(FlatAst* self, const AstExpression* expression)
+{
+	// Children are added before their parent; the nodes of finished children wait on a second stack until their parent
+	// is added.
+	FlatAst_AddFrameList stack;
+	FlatAst_AddFrameList_Init(&stack);
+	UInt32List children;
+	UInt32List_Init(&children);
+
+	FlatAst_PushAddFrame(self, &stack, expression);
+	while (stack.size != 0)
+	{
+		FlatAst_AddFrame* frame = &stack.data[stack.size - 1];
+		if (frame->nextChild != frame->childCount)
+		{
+			const AstExpression* child = *AstExpression_GetChildSlot((AstExpression*)frame->expression, frame->nextChild++);
+			// Pushing may move the stack, so frame is not used past this point
+			FlatAst_PushAddFrame(self, &stack, child);
+			continue;
+		}
+
+		children.size -= frame->childCount;
+		const FlatAst_Node node = FlatAst_AddExpressionNode(self, frame, children.data + children.size);
+		UInt32List_Append(&children, node);
+		stack.size--;
+	}
+
+	assert(children.size == 1);
+	const FlatAst_Node root = children.data[0];
+	FlatAst_AddFrameList_Fini(&stack);
+	UInt32List_Fini(&children);
+	return root;
+}
+
+void FlatAst_PushAddFrame(FlatAst* self, FlatAst_AddFrameList* stack, const AstExpression* expression)
+{
+	FlatAst_AddFrame frame = {
+		.expression = expression,
+		.childCount = (uint32_t)AstExpression_GetChildCount(expression),
+	};
+	if (expression->type == AST_EXPR_CAST)
+		frame.typeName = FlatAst_AddTypeName(self, expression->data.cast.typeName);
+	else if (expression->type == AST_EXPR_SIZEOF_TYPE)
+		frame.typeName = FlatAst_AddTypeName(self, expression->data.sizeofType.typeName);
+	FlatAst_AddFrameList_AppendFromPtr(stack, &frame);
+}
+
+// Adds the expression of frame, whose children were added as children[0, frame->childCount)
+FlatAst_Node FlatAst_AddExpressionNode(FlatAst* self, const FlatAst_AddFrame* frame, const FlatAst_Node* children)
+{
+	const AstExpression* expression = frame->expression;
+	switch (expression->type)
+	{
+		case AST_EXPR_UNARY:
+		{
+			const FlatAst_Unary unary = { .operand = children[0], .operation = (uint8_t)expression->data.unary.operation };
+			FlatAst_UnaryList_AppendFromPtr(&self->unaries, &unary);
+			return FlatAst_AddNode(self, AST_EXPR_UNARY, self->unaries.size - 1, &expression->location);
+		}
+		case AST_EXPR_BINARY:
+		{
+			const FlatAst_Binary binary = {
+				.left = children[0],
+				.right = children[1],
+				.operation = (uint8_t)expression->data.binary.operation,
+			};
+			FlatAst_BinaryList_AppendFromPtr(&self->binaries, &binary);
+			return FlatAst_AddNode(self, AST_EXPR_BINARY, self->binaries.size - 1, &expression->location);
+		}
+		case AST_EXPR_TERNARY:
+		{
+			const FlatAst_Ternary ternary = {
+				.left = children[0],
+				.middle = children[1],
+				.right = children[2],
+				.operation = (uint8_t)expression->data.ternary.operation,
+			};
+			FlatAst_TernaryList_AppendFromPtr(&self->ternaries, &ternary);
+			return FlatAst_AddNode(self, AST_EXPR_TERNARY, self->ternaries.size - 1, &expression->location);
+		}
+		case AST_EXPR_CAST:
+		{
+			const FlatAst_Cast cast = { .typeName = frame->typeName, .operand = children[0] };
+			FlatAst_CastList_AppendFromPtr(&self->casts, &cast);
+			return FlatAst_AddNode(self, AST_EXPR_CAST, self->casts.size - 1, &expression->location);
+		}
+		case AST_EXPR_SIZEOF_TYPE:
+		{
+			const FlatAst_SizeofType sizeofType = { .typeName = frame->typeName };
+			FlatAst_SizeofTypeList_AppendFromPtr(&self->sizeofTypes, &sizeofType);
+			return FlatAst_AddNode(self, AST_EXPR_SIZEOF_TYPE, self->sizeofTypes.size - 1, &expression->location);
+		}
+		case AST_EXPR_MEMBER_ACCESS:
+		{
+			const AstMemberAccessExpression* memberAccessExpression = &expression->data.memberAccess;
+			const ConstCharSpan memberName = memberAccessExpression->memberName;
+			const FlatAst_MemberAccess memberAccess = {
+				.operand = children[0],
+				.memberSymbol = memberAccessExpression->memberSymbol,
+				.memberName = {
+					.offset = (uint32_t)(expression->location.offset + (size_t)(memberName.data - expression->location.snippet.data)),
+					.length = (uint32_t)memberName.length,
+				},
+				.isPointerAccess = memberAccessExpression->isPointerAccess,
+			};
+			FlatAst_MemberAccessList_AppendFromPtr(&self->memberAccesses, &memberAccess);
+			return FlatAst_AddNode(self, AST_EXPR_MEMBER_ACCESS, self->memberAccesses.size - 1, &expression->location);
+		}
+		case AST_EXPR_CALL:
+		{
+			// The arguments are complete by now, and nested calls have appended their own ranges already
+			const size_t argumentCount = frame->childCount - 1;
+			const size_t firstArgument = self->arguments.size;
+			if (!UInt32List_Resize(&self->arguments, firstArgument + argumentCount))
+				abort();
+			memcpy(self->arguments.data + firstArgument, children + 1, argumentCount * sizeof(FlatAst_Node));
+
+			const FlatAst_Call call = {
+				.callee = children[0],
+				.firstArgument = (uint32_t)firstArgument,
+				.argumentCount = (uint32_t)argumentCount,
+			};
+			FlatAst_CallList_AppendFromPtr(&self->calls, &call);
+			return FlatAst_AddNode(self, AST_EXPR_CALL, self->calls.size - 1, &expression->location);
+		}
+		case AST_EXPR_PRIMARY:
+		{
+			const AstPrimaryExpression* primaryExpression = &expression->data.primary;
+			FlatAst_Primary primary = {
+				.symbol = INTERNER_NO_SYMBOL,
+				.tokenType = primaryExpression->literal.type,
+				.isFolded = primaryExpression->isFolded,
+			};
+			switch (primaryExpression->literal.type)
+			{
+				case TOKEN_LITERAL_INTEGER:
+					primary.value.integer = primaryExpression->data.literalInteger.decoded;
+					primary.literalType = (uint8_t)primaryExpression->data.literalInteger.type;
+					primary.base = (uint8_t)primaryExpression->data.literalInteger.base;
+					break;
+				case TOKEN_LITERAL_FLOAT:
+					primary.value.floating = primaryExpression->data.literalDecimalFloat.decoded;
+					primary.literalType = (uint8_t)primaryExpression->data.literalDecimalFloat.type;
+					break;
+				case TOKEN_IDENTIFIER:
+					primary.symbol = primaryExpression->literal.symbol;
+					break;
+				default:
+					break;
+			}
+			FlatAst_PrimaryList_AppendFromPtr(&self->primaries, &primary);
+			return FlatAst_AddNode(self, AST_EXPR_PRIMARY, self->primaries.size - 1, &expression->location);
+		}
+		default:
+			assert(false && "unreachable");
+			return FLAT_AST_NO_NODE;
+	}
+}
+
+uint32_t FlatAst_AddTypeName(FlatAst* self, const AstTypeName* typeName)
+{
+	const AstTypeSpecifierList* specifiers = typeName->specifierQualifierList->specifiers;
+	const FlatAst_TypeName flatTypeName = {
+		.location = FlatAst_Span_FromLocation(&typeName->location),
+		.firstSpecifier = (uint32_t)self->typeSpecifiers.size,
+		.specifierCount = (uint32_t)specifiers->size,
+		.qualifiers = (uint8_t)typeName->specifierQualifierList->qualifiers,
+	};
+
+	for (size_t i = 0; i < specifiers->size; i++)
+	{
+		const FlatAst_TypeSpecifier specifier = { .symbol = specifiers->data[i]->symbol, .type = (uint8_t)specifiers->data[i]->type };
+		FlatAst_TypeSpecifierList_AppendFromPtr(&self->typeSpecifiers, &specifier);
+	}
+
+	FlatAst_TypeNameList_AppendFromPtr(&self->typeNames, &flatTypeName);
+	return (uint32_t)(self->typeNames.size - 1);
+}
+
+FlatAst_Node FlatAst_AddNode(FlatAst* self, const AstExpression_Type type, const size_t payload, const SourceLocation* location)
+{
+	assert(location->sourceFile == self->source);
+	const FlatAst_Span span = FlatAst_Span_FromLocation(location);
+	UInt8List_Append(&self->types, (uint8_t)type);
+	UInt32List_Append(&self->payloads, (uint32_t)payload);
+	FlatAst_SpanList_AppendFromPtr(&self->locations, &span);
+	return (FlatAst_Node)(self->types.size - 1);
+}
+
+FlatAst_Span FlatAst_Span_FromLocation(const SourceLocation* location)
+{
+	return (FlatAst_Span) { .offset = (uint32_t)location->offset, .length = (uint32_t)location->snippet.length };
+}
+
+void FlatAst_PushFrame(FlatAst_WalkFrameList* stack, const FlatAst* ast, const FlatAst_Node node, const FlatAst_Visitor* visitor)
+{
+	const bool visitChildren = visitor->enter == NULL || visitor->enter(visitor->context, ast, node);
+	const FlatAst_WalkFrame frame = {
+		.node = node,
+		.childCount = visitChildren ? (uint32_t)FlatAst_GetChildCount(ast, node) : 0,
+	};
+	FlatAst_WalkFrameList_AppendFromPtr(stack, &frame);
+}
+
+nullable_end
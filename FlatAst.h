@@ -0,0 +1,293 @@
+#pragma once
+
+#include "AstExpression.h"
+#include "Util/List.h"
+
+nullable_begin
+
+// Flat expression storage: every node is an index into parallel arrays (type, payload, location), and the payload
+// indexes a contiguous array holding all nodes of that type. Nodes are appended in post-order, so children always
+// precede their parent and bottom-up passes are a single forward loop. Nothing but the source file is referenced
+// through a pointer, so every array can be written out and read back as is.
+typedef uint32_t FlatAst_Node;
+
+#define FLAT_AST_NO_NODE UINT32_MAX
+
+typedef struct
+{
+	uint32_t offset;
+	uint32_t length;
+} FlatAst_Span;
+
+typedef struct
+{
+	FlatAst_Node operand;
+	uint8_t operation; // AstUnaryOperation
+} FlatAst_Unary;
+
+typedef struct
+{
+	FlatAst_Node left;
+	FlatAst_Node right;
+	uint8_t operation; // AstBinaryOperation
+} FlatAst_Binary;
+
+typedef struct
+{
+	FlatAst_Node left;
+	FlatAst_Node middle;
+	FlatAst_Node right;
+	uint8_t operation; // AstTernaryOperation
+} FlatAst_Ternary;
+
+typedef struct
+{
+	uint32_t typeName;
+	FlatAst_Node operand;
+} FlatAst_Cast;
+
+typedef struct
+{
+	uint32_t typeName;
+} FlatAst_SizeofType;
+
+typedef struct
+{
+	FlatAst_Node operand;
+	uint32_t memberSymbol;
+	FlatAst_Span memberName;
+	bool isPointerAccess;
+} FlatAst_MemberAccess;
+
+typedef struct
+{
+	FlatAst_Node callee;
+	// Arguments are the range [firstArgument, firstArgument + argumentCount) of FlatAst.arguments
+	uint32_t firstArgument;
+	uint32_t argumentCount;
+} FlatAst_Call;
+
+typedef struct
+{
+	union
+	{
+		uint64_t integer;
+		double floating;
+	} value;
+	uint32_t symbol;     // Identifiers only
+	uint8_t tokenType;   // Token_Type of the literal or identifier
+	uint8_t literalType; // Token_LiteralInteger_Type or Token_LiteralFloat_Type
+	uint8_t base;        // Integer literals only
+	bool isFolded;       // A folded constant rather than a literal from the source
+} FlatAst_Primary;
+
+typedef struct
+{
+	FlatAst_Span location;
+	// Specifiers are the range [firstSpecifier, firstSpecifier + specifierCount) of FlatAst.typeSpecifiers
+	uint32_t firstSpecifier;
+	uint32_t specifierCount;
+	uint8_t qualifiers; // AstTypeQualifiers
+} FlatAst_TypeName;
+
+typedef struct
+{
+	uint32_t symbol;
+	uint8_t type; // AstTypeSpecifier_Type
+} FlatAst_TypeSpecifier;
+
+nullable_end
+
+#define LIST_TYPE FlatAst_SpanList
+#define LIST_ELEMENT_TYPE FlatAst_Span
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE FlatAst_UnaryList
+#define LIST_ELEMENT_TYPE FlatAst_Unary
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE FlatAst_BinaryList
+#define LIST_ELEMENT_TYPE FlatAst_Binary
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE FlatAst_TernaryList
+#define LIST_ELEMENT_TYPE FlatAst_Ternary
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE FlatAst_CastList
+#define LIST_ELEMENT_TYPE FlatAst_Cast
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE FlatAst_SizeofTypeList
+#define LIST_ELEMENT_TYPE FlatAst_SizeofType
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE FlatAst_MemberAccessList
+#define LIST_ELEMENT_TYPE FlatAst_MemberAccess
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE FlatAst_CallList
+#define LIST_ELEMENT_TYPE FlatAst_Call
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE FlatAst_PrimaryList
+#define LIST_ELEMENT_TYPE FlatAst_Primary
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE FlatAst_TypeNameList
+#define LIST_ELEMENT_TYPE FlatAst_TypeName
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE FlatAst_TypeSpecifierList
+#define LIST_ELEMENT_TYPE FlatAst_TypeSpecifier
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+nullable_begin
+
+typedef struct
+{
+	const SourceFile* source;
+
+	// Per node, indexed by FlatAst_Node
+	UInt8List types;      // AstExpression_Type
+	UInt32List payloads;  // Index into the array for the node's type
+	FlatAst_SpanList locations;
+
+	// Per node type
+	FlatAst_UnaryList unaries;
+	FlatAst_BinaryList binaries;
+	FlatAst_TernaryList ternaries;
+	FlatAst_CastList casts;
+	FlatAst_SizeofTypeList sizeofTypes;
+	FlatAst_MemberAccessList memberAccesses;
+	FlatAst_CallList calls;
+	FlatAst_PrimaryList primaries;
+
+	UInt32List arguments;
+	FlatAst_TypeNameList typeNames;
+	FlatAst_TypeSpecifierList typeSpecifiers;
+
+	// Top-level expressions, in the order they were appended
+	UInt32List roots;
+} FlatAst;
+
+// Callbacks for FlatAst_Walk; any of them may be NULL
+typedef struct
+{
+	void*nullable context;
+	// Called before the children of node; returning false skips all of them
+	bool (*nullable enter)(void*nullable context, const FlatAst* ast, FlatAst_Node node);
+	// Called before and after the child at position index of parent; returning false from enterChild skips that child
+	bool (*nullable enterChild)(void*nullable context, const FlatAst* ast, FlatAst_Node parent, size_t index);
+	void (*nullable leaveChild)(void*nullable context, const FlatAst* ast, FlatAst_Node parent, size_t index);
+	// Called after the children of node, even when enter skipped them
+	void (*nullable leave)(void*nullable context, const FlatAst* ast, FlatAst_Node node);
+} FlatAst_Visitor;
+
+FlatAst* FlatAst_Init_WithSource(FlatAst* self, const SourceFile* source);
+void FlatAst_Fini(const FlatAst* self);
+
+// Copies the expression tree into the flat storage, appends it to the roots and returns its root node
+FlatAst_Node FlatAst_AppendExpression(FlatAst* self, const AstExpression* expression);
+
+// Children in source order: operands, then call arguments after the callee
+size_t FlatAst_GetChildCount(const FlatAst* self, FlatAst_Node node);
+FlatAst_Node FlatAst_GetChild(const FlatAst* self, FlatAst_Node node, size_t index);
+
+// Depth-first walk from node, without recursion like the passes over AstExpression
+void FlatAst_Walk(const FlatAst* self, FlatAst_Node node, const FlatAst_Visitor* visitor);
+
+static size_t FlatAst_GetNodeCount(const FlatAst* self)
+{
+	return self->types.size;
+}
+
+static AstExpression_Type FlatAst_GetType(const FlatAst* self, const FlatAst_Node node)
+{
+	assert(node < self->types.size);
+	return (AstExpression_Type)self->types.data[node];
+}
+
+static SourceLocation FlatAst_GetLocation(const FlatAst* self, const FlatAst_Node node)
+{
+	assert(node < self->locations.size);
+	return SourceLocation_Create(self->source, self->locations.data[node].offset, self->locations.data[node].length);
+}
+
+static const FlatAst_Unary* FlatAst_GetUnary(const FlatAst* self, const FlatAst_Node node)
+{
+	assert(FlatAst_GetType(self, node) == AST_EXPR_UNARY);
+	return &self->unaries.data[self->payloads.data[node]];
+}
+
+static const FlatAst_Binary* FlatAst_GetBinary(const FlatAst* self, const FlatAst_Node node)
+{
+	assert(FlatAst_GetType(self, node) == AST_EXPR_BINARY);
+	return &self->binaries.data[self->payloads.data[node]];
+}
+
+static const FlatAst_Ternary* FlatAst_GetTernary(const FlatAst* self, const FlatAst_Node node)
+{
+	assert(FlatAst_GetType(self, node) == AST_EXPR_TERNARY);
+	return &self->ternaries.data[self->payloads.data[node]];
+}
+
+static const FlatAst_Cast* FlatAst_GetCast(const FlatAst* self, const FlatAst_Node node)
+{
+	assert(FlatAst_GetType(self, node) == AST_EXPR_CAST);
+	return &self->casts.data[self->payloads.data[node]];
+}
+
+static const FlatAst_SizeofType* FlatAst_GetSizeofType(const FlatAst* self, const FlatAst_Node node)
+{
+	assert(FlatAst_GetType(self, node) == AST_EXPR_SIZEOF_TYPE);
+	return &self->sizeofTypes.data[self->payloads.data[node]];
+}
+
+static const FlatAst_MemberAccess* FlatAst_GetMemberAccess(const FlatAst* self, const FlatAst_Node node)
+{
+	assert(FlatAst_GetType(self, node) == AST_EXPR_MEMBER_ACCESS);
+	return &self->memberAccesses.data[self->payloads.data[node]];
+}
+
+static const FlatAst_Call* FlatAst_GetCall(const FlatAst* self, const FlatAst_Node node)
+{
+	assert(FlatAst_GetType(self, node) == AST_EXPR_CALL);
+	return &self->calls.data[self->payloads.data[node]];
+}
+
+static const FlatAst_Primary* FlatAst_GetPrimary(const FlatAst* self, const FlatAst_Node node)
+{
+	assert(FlatAst_GetType(self, node) == AST_EXPR_PRIMARY);
+	return &self->primaries.data[self->payloads.data[node]];
+}
+
+static const FlatAst_TypeName* FlatAst_GetTypeName(const FlatAst* self, const uint32_t typeName)
+{
+	assert(typeName < self->typeNames.size);
+	return &self->typeNames.data[typeName];
+}
+
+nullable_end
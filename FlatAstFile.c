@@ -0,0 +1,429 @@
+#include "FlatAstFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Util/File.h"
+#include "Util/Managed.h"
+
+nullable_begin
+
+#define FLAT_AST_FILE_ALIGNMENT 8
+
+static const size_t FlatAstFile_elementSizes[FLAT_AST_FILE_SECTION_COUNT] = {
+	[FLAT_AST_FILE_SECTION_TYPES] = sizeof(uint8_t),
+	[FLAT_AST_FILE_SECTION_PAYLOADS] = sizeof(uint32_t),
+	[FLAT_AST_FILE_SECTION_LOCATIONS] = sizeof(FlatAst_Span),
+	[FLAT_AST_FILE_SECTION_UNARIES] = sizeof(FlatAst_Unary),
+	[FLAT_AST_FILE_SECTION_BINARIES] = sizeof(FlatAst_Binary),
+	[FLAT_AST_FILE_SECTION_TERNARIES] = sizeof(FlatAst_Ternary),
+	[FLAT_AST_FILE_SECTION_CASTS] = sizeof(FlatAst_Cast),
+	[FLAT_AST_FILE_SECTION_SIZEOF_TYPES] = sizeof(FlatAst_SizeofType),
+	[FLAT_AST_FILE_SECTION_MEMBER_ACCESSES] = sizeof(FlatAst_MemberAccess),
+	[FLAT_AST_FILE_SECTION_CALLS] = sizeof(FlatAst_Call),
+	[FLAT_AST_FILE_SECTION_PRIMARIES] = sizeof(FlatAst_Primary),
+	[FLAT_AST_FILE_SECTION_ARGUMENTS] = sizeof(uint32_t),
+	[FLAT_AST_FILE_SECTION_TYPE_NAMES] = sizeof(FlatAst_TypeName),
+	[FLAT_AST_FILE_SECTION_TYPE_SPECIFIERS] = sizeof(FlatAst_TypeSpecifier),
+	[FLAT_AST_FILE_SECTION_ROOTS] = sizeof(uint32_t),
+	[FLAT_AST_FILE_SECTION_STRINGS] = sizeof(FlatAst_Span),
+	[FLAT_AST_FILE_SECTION_SPELLINGS] = sizeof(char),
+};
+
+typedef struct
+{
+	const Interner*nullable interner;
+	// File symbol + 1 per interner symbol, 0 if it is not used yet
+	uint32_t*nullable symbolMap;
+	FlatAst_SpanList strings;
+	CharList spellings;
+} FlatAstFile_StringTable;
+
+static uint64_t FlatAstFile_HashSource(const SourceFile* source);
+static uint32_t FlatAstFile_MapSymbol(FlatAstFile_StringTable* table, uint32_t symbol);
+static const void*nullable FlatAstFile_GetSection(const FlatAstFile_Header* header, size_t size, FlatAstFile_Section section);
+static bool FlatAstFile_Validate(const FlatAstFile* self, uint64_t sourceLength, size_t spellingsLength);
+static bool FlatAstFile_IsNodeValid(const FlatAstFile* self, FlatAst_Node node, uint64_t sourceLength);
+static bool FlatAstFile_IsSymbolValid(const FlatAstFile* self, uint32_t symbol);
+static bool FlatAstFile_IsRangeValid(uint64_t offset, uint64_t count, uint64_t limit);
+
+bool FlatAstFile_Write(const FlatAst* ast, const Interner*nullable interner, const char* path)
+{
+	// Records holding symbols are copied with the symbols renumbered in order of first use
+	FlatAstFile_StringTable table = { .interner = interner };
+	if (interner)
+	{
+		table.symbolMap = (uint32_t*)calloc(Interner_GetCount(interner) + 1, sizeof(uint32_t));
+		if (table.symbolMap == NULL)
+			abort();
+	}
+	FlatAst_SpanList_Init(&table.strings);
+	CharList_Init(&table.spellings);
+
+	FlatAst_PrimaryList primaries;
+	FlatAst_PrimaryList_Init(&primaries);
+	for (size_t i = 0; i < ast->primaries.size; i++)
+	{
+		FlatAst_Primary primary = ast->primaries.data[i];
+		primary.symbol = FlatAstFile_MapSymbol(&table, primary.symbol);
+		FlatAst_PrimaryList_AppendFromPtr(&primaries, &primary);
+	}
+
+	FlatAst_MemberAccessList memberAccesses;
+	FlatAst_MemberAccessList_Init(&memberAccesses);
+	for (size_t i = 0; i < ast->memberAccesses.size; i++)
+	{
+		FlatAst_MemberAccess memberAccess = ast->memberAccesses.data[i];
+		memberAccess.memberSymbol = FlatAstFile_MapSymbol(&table, memberAccess.memberSymbol);
+		FlatAst_MemberAccessList_AppendFromPtr(&memberAccesses, &memberAccess);
+	}
+
+	FlatAst_TypeSpecifierList typeSpecifiers;
+	FlatAst_TypeSpecifierList_Init(&typeSpecifiers);
+	for (size_t i = 0; i < ast->typeSpecifiers.size; i++)
+	{
+		FlatAst_TypeSpecifier typeSpecifier = ast->typeSpecifiers.data[i];
+		typeSpecifier.symbol = FlatAstFile_MapSymbol(&table, typeSpecifier.symbol);
+		FlatAst_TypeSpecifierList_AppendFromPtr(&typeSpecifiers, &typeSpecifier);
+	}
+
+	const struct
+	{
+		const void* data;
+		size_t count;
+	} sections[FLAT_AST_FILE_SECTION_COUNT] = {
+		[FLAT_AST_FILE_SECTION_TYPES] = { ast->types.data, ast->types.size },
+		[FLAT_AST_FILE_SECTION_PAYLOADS] = { ast->payloads.data, ast->payloads.size },
+		[FLAT_AST_FILE_SECTION_LOCATIONS] = { ast->locations.data, ast->locations.size },
+		[FLAT_AST_FILE_SECTION_UNARIES] = { ast->unaries.data, ast->unaries.size },
+		[FLAT_AST_FILE_SECTION_BINARIES] = { ast->binaries.data, ast->binaries.size },
+		[FLAT_AST_FILE_SECTION_TERNARIES] = { ast->ternaries.data, ast->ternaries.size },
+		[FLAT_AST_FILE_SECTION_CASTS] = { ast->casts.data, ast->casts.size },
+		[FLAT_AST_FILE_SECTION_SIZEOF_TYPES] = { ast->sizeofTypes.data, ast->sizeofTypes.size },
+		[FLAT_AST_FILE_SECTION_MEMBER_ACCESSES] = { memberAccesses.data, memberAccesses.size },
+		[FLAT_AST_FILE_SECTION_CALLS] = { ast->calls.data, ast->calls.size },
+		[FLAT_AST_FILE_SECTION_PRIMARIES] = { primaries.data, primaries.size },
+		[FLAT_AST_FILE_SECTION_ARGUMENTS] = { ast->arguments.data, ast->arguments.size },
+		[FLAT_AST_FILE_SECTION_TYPE_NAMES] = { ast->typeNames.data, ast->typeNames.size },
+		[FLAT_AST_FILE_SECTION_TYPE_SPECIFIERS] = { typeSpecifiers.data, typeSpecifiers.size },
+		[FLAT_AST_FILE_SECTION_ROOTS] = { ast->roots.data, ast->roots.size },
+		[FLAT_AST_FILE_SECTION_STRINGS] = { table.strings.data, table.strings.size },
+		[FLAT_AST_FILE_SECTION_SPELLINGS] = { table.spellings.data, table.spellings.size },
+	};
+
+	FlatAstFile_Header header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, FLAT_AST_FILE_MAGIC, sizeof(FLAT_AST_FILE_MAGIC));
+	header.version = FLAT_AST_FILE_VERSION;
+	header.byteOrder = FLAT_AST_FILE_BYTE_ORDER;
+	header.sourceLength = ast->source->content ? String_Length(ast->source->content) : 0;
+	header.sourceHash = FlatAstFile_HashSource(ast->source);
+
+	size_t offset = sizeof(header);
+	for (size_t i = 0; i < FLAT_AST_FILE_SECTION_COUNT; i++)
+	{
+		offset = (offset + FLAT_AST_FILE_ALIGNMENT - 1) & ~(size_t)(FLAT_AST_FILE_ALIGNMENT - 1);
+		header.sections[i].offset = offset;
+		header.sections[i].count = sections[i].count;
+		offset += sections[i].count * FlatAstFile_elementSizes[i];
+	}
+
+	bool isWritten = false;
+	{
+		using FileHandle* file = NewWith(FileHandle, Args, path, "wb");
+		if (file->file)
+		{
+			static const char padding[FLAT_AST_FILE_ALIGNMENT] = { 0 };
+			isWritten = FileHandle_Write(file, &header, sizeof(header)) == sizeof(header);
+			offset = sizeof(header);
+			for (size_t i = 0; i < FLAT_AST_FILE_SECTION_COUNT && isWritten; i++)
+			{
+				const size_t paddingSize = header.sections[i].offset - offset;
+				const size_t dataSize = sections[i].count * FlatAstFile_elementSizes[i];
+				isWritten = FileHandle_Write(file, padding, paddingSize) == paddingSize &&
+				            FileHandle_Write(file, sections[i].data, dataSize) == dataSize;
+				offset = header.sections[i].offset + dataSize;
+			}
+
+			// A full disk may only show when the buffered tail is flushed
+			if (!FileHandle_Close(file))
+				isWritten = false;
+		}
+	}
+
+	FlatAst_PrimaryList_Fini(&primaries);
+	FlatAst_MemberAccessList_Fini(&memberAccesses);
+	FlatAst_TypeSpecifierList_Fini(&typeSpecifiers);
+	FlatAst_SpanList_Fini(&table.strings);
+	CharList_Fini(&table.spellings);
+	free(table.symbolMap);
+	return isWritten;
+}
+
+FlatAstFile* FlatAstFile_Init_WithPath(FlatAstFile* self, const char* path, const SourceFile* source)
+{
+	memset(self, 0, sizeof(*self));
+	self->ast.source = source;
+
+	self->error = "cannot be read";
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return self;
+
+	struct stat status;
+	void* data = MAP_FAILED;
+	if (fstat(fd, &status) == 0 && (size_t)status.st_size >= sizeof(FlatAstFile_Header))
+		data = mmap(NULL, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return self;
+
+	const size_t size = (size_t)status.st_size;
+	const FlatAstFile_Header* header = (const FlatAstFile_Header*)data;
+	const void*nullable sections[FLAT_AST_FILE_SECTION_COUNT];
+	bool isValid = memcmp(header->magic, FLAT_AST_FILE_MAGIC, sizeof(FLAT_AST_FILE_MAGIC)) == 0 &&
+	               header->version == FLAT_AST_FILE_VERSION && header->byteOrder == FLAT_AST_FILE_BYTE_ORDER;
+	for (size_t i = 0; i < FLAT_AST_FILE_SECTION_COUNT && isValid; i++)
+	{
+		sections[i] = FlatAstFile_GetSection(header, size, (FlatAstFile_Section)i);
+		isValid = sections[i] != NULL;
+	}
+
+	// Every node has a type, a payload and a location
+	const FlatAstFile_SectionEntry* entries = header->sections;
+	if (!isValid || entries[FLAT_AST_FILE_SECTION_PAYLOADS].count != entries[FLAT_AST_FILE_SECTION_TYPES].count ||
+	    entries[FLAT_AST_FILE_SECTION_LOCATIONS].count != entries[FLAT_AST_FILE_SECTION_TYPES].count)
+	{
+		self->error = "is not an AST file for this version and machine";
+		munmap(data, size);
+		return self;
+	}
+
+	// The lists borrow the mapping, with their capacity at their size so that they are never written to
+#define FLAT_AST_FILE_BORROW(list, listType, elementType, section) \
+	self->ast.list = (listType) { (elementType*)sections[section], entries[section].count, entries[section].count }
+	FLAT_AST_FILE_BORROW(types, UInt8List, uint8_t, FLAT_AST_FILE_SECTION_TYPES);
+	FLAT_AST_FILE_BORROW(payloads, UInt32List, uint32_t, FLAT_AST_FILE_SECTION_PAYLOADS);
+	FLAT_AST_FILE_BORROW(locations, FlatAst_SpanList, FlatAst_Span, FLAT_AST_FILE_SECTION_LOCATIONS);
+	FLAT_AST_FILE_BORROW(unaries, FlatAst_UnaryList, FlatAst_Unary, FLAT_AST_FILE_SECTION_UNARIES);
+	FLAT_AST_FILE_BORROW(binaries, FlatAst_BinaryList, FlatAst_Binary, FLAT_AST_FILE_SECTION_BINARIES);
+	FLAT_AST_FILE_BORROW(ternaries, FlatAst_TernaryList, FlatAst_Ternary, FLAT_AST_FILE_SECTION_TERNARIES);
+	FLAT_AST_FILE_BORROW(casts, FlatAst_CastList, FlatAst_Cast, FLAT_AST_FILE_SECTION_CASTS);
+	FLAT_AST_FILE_BORROW(sizeofTypes, FlatAst_SizeofTypeList, FlatAst_SizeofType, FLAT_AST_FILE_SECTION_SIZEOF_TYPES);
+	FLAT_AST_FILE_BORROW(memberAccesses, FlatAst_MemberAccessList, FlatAst_MemberAccess, FLAT_AST_FILE_SECTION_MEMBER_ACCESSES);
+	FLAT_AST_FILE_BORROW(calls, FlatAst_CallList, FlatAst_Call, FLAT_AST_FILE_SECTION_CALLS);
+	FLAT_AST_FILE_BORROW(primaries, FlatAst_PrimaryList, FlatAst_Primary, FLAT_AST_FILE_SECTION_PRIMARIES);
+	FLAT_AST_FILE_BORROW(arguments, UInt32List, uint32_t, FLAT_AST_FILE_SECTION_ARGUMENTS);
+	FLAT_AST_FILE_BORROW(typeNames, FlatAst_TypeNameList, FlatAst_TypeName, FLAT_AST_FILE_SECTION_TYPE_NAMES);
+	FLAT_AST_FILE_BORROW(typeSpecifiers, FlatAst_TypeSpecifierList, FlatAst_TypeSpecifier, FLAT_AST_FILE_SECTION_TYPE_SPECIFIERS);
+	FLAT_AST_FILE_BORROW(roots, UInt32List, uint32_t, FLAT_AST_FILE_SECTION_ROOTS);
+#undef FLAT_AST_FILE_BORROW
+
+	self->strings = (const FlatAst_Span*)sections[FLAT_AST_FILE_SECTION_STRINGS];
+	self->stringCount = entries[FLAT_AST_FILE_SECTION_STRINGS].count;
+	self->spellings = (const char*)sections[FLAT_AST_FILE_SECTION_SPELLINGS];
+	if (!FlatAstFile_Validate(self, header->sourceLength, entries[FLAT_AST_FILE_SECTION_SPELLINGS].count))
+	{
+		self->error = "is corrupt";
+		munmap(data, size);
+		return self;
+	}
+
+	self->error = NULL;
+	self->data = data;
+	self->size = size;
+	return self;
+}
+
+void FlatAstFile_Fini(const FlatAstFile* self)
+{
+	if (self->data)
+		munmap((void*)self->data, self->size);
+}
+
+bool FlatAstFile_MatchesSource(const FlatAstFile* self, const SourceFile* source)
+{
+	assert(self->data && "file was loaded");
+	const FlatAstFile_Header* header = (const FlatAstFile_Header*)self->data;
+	const size_t length = source->content ? String_Length(source->content) : 0;
+	return header->sourceLength == length && header->sourceHash == FlatAstFile_HashSource(source);
+}
+
+ConstCharSpan FlatAstFile_GetSpelling(const FlatAstFile* self, const uint32_t symbol)
+{
+	if (symbol >= self->stringCount)
+		return ConstCharSpan_Empty;
+
+	const FlatAst_Span* string = &self->strings[symbol];
+	const size_t spellingsLength = ((const FlatAstFile_Header*)self->data)->sections[FLAT_AST_FILE_SECTION_SPELLINGS].count;
+	if (string->offset > spellingsLength || string->length > spellingsLength - string->offset)
+		return ConstCharSpan_Empty;
+	return ConstCharSpan_Create(self->spellings + string->offset, string->length);
+}
+
+// FNV-1a over the content
+uint64_t FlatAstFile_HashSource(const SourceFile* source)
+{
+	uint64_t hash = 0xCBF29CE484222325u;
+	if (!source->content)
+		return hash;
+
+	const ConstCharSpan content = String_AsConstCharSpan((String*)source->content);
+	for (size_t i = 0; i < content.length; i++)
+		hash = (hash ^ (uint8_t)content.data[i]) * 0x100000001B3u;
+	return hash;
+}
+
+uint32_t FlatAstFile_MapSymbol(FlatAstFile_StringTable* table, const uint32_t symbol)
+{
+	if (!table->interner || symbol >= Interner_GetCount(table->interner))
+		return INTERNER_NO_SYMBOL;
+	if (table->symbolMap[symbol] != 0)
+		return table->symbolMap[symbol] - 1;
+
+	const ConstCharSpan spelling = Interner_GetSpelling(table->interner, symbol);
+	const FlatAst_Span string = { (uint32_t)table->spellings.size, (uint32_t)spelling.length };
+	CharList_Resize(&table->spellings, string.offset + spelling.length);
+	memcpy(table->spellings.data + string.offset, spelling.data, spelling.length);
+	FlatAst_SpanList_AppendFromPtr(&table->strings, &string);
+
+	table->symbolMap[symbol] = (uint32_t)table->strings.size;
+	return (uint32_t)table->strings.size - 1;
+}
+
+// The section if it lies within the file and is aligned for its elements, NULL otherwise
+const void* FlatAstFile_GetSection(const FlatAstFile_Header* header, const size_t size, const FlatAstFile_Section section)
+{
+	const FlatAstFile_SectionEntry* entry = &header->sections[section];
+	if (entry->offset % FLAT_AST_FILE_ALIGNMENT != 0 || entry->offset > size ||
+	    entry->count > (size - entry->offset) / FlatAstFile_elementSizes[section])
+		return NULL;
+	return (const char*)header + entry->offset;
+}
+
+// Checks every index and range in the sections, so that walking and printing the AST stay within the mapping
+bool FlatAstFile_Validate(const FlatAstFile* self, const uint64_t sourceLength, const size_t spellingsLength)
+{
+	const FlatAst* ast = &self->ast;
+	for (size_t node = 0; node < ast->types.size; node++)
+	{
+		if (!FlatAstFile_IsNodeValid(self, (FlatAst_Node)node, sourceLength))
+			return false;
+	}
+
+	for (size_t i = 0; i < ast->roots.size; i++)
+	{
+		if (ast->roots.data[i] >= ast->types.size)
+			return false;
+	}
+
+	for (size_t i = 0; i < ast->typeNames.size; i++)
+	{
+		const FlatAst_TypeName* typeName = &ast->typeNames.data[i];
+		if (!FlatAstFile_IsRangeValid(typeName->location.offset, typeName->location.length, sourceLength) ||
+		    !FlatAstFile_IsRangeValid(typeName->firstSpecifier, typeName->specifierCount, ast->typeSpecifiers.size))
+			return false;
+	}
+
+	for (size_t i = 0; i < ast->typeSpecifiers.size; i++)
+	{
+		if (!FlatAstFile_IsSymbolValid(self, ast->typeSpecifiers.data[i].symbol))
+			return false;
+	}
+
+	for (size_t i = 0; i < self->stringCount; i++)
+	{
+		if (!FlatAstFile_IsRangeValid(self->strings[i].offset, self->strings[i].length, spellingsLength))
+			return false;
+	}
+
+	return true;
+}
+
+// Children have to precede their parent, as they do when written, which also keeps the nodes free of cycles
+bool FlatAstFile_IsNodeValid(const FlatAstFile* self, const FlatAst_Node node, const uint64_t sourceLength)
+{
+	const FlatAst* ast = &self->ast;
+	const FlatAst_Span* location = &ast->locations.data[node];
+	if (!FlatAstFile_IsRangeValid(location->offset, location->length, sourceLength))
+		return false;
+
+	const uint32_t payload = ast->payloads.data[node];
+	switch ((AstExpression_Type)ast->types.data[node])
+	{
+		case AST_EXPR_UNARY:
+			return payload < ast->unaries.size && ast->unaries.data[payload].operand < node;
+		case AST_EXPR_BINARY:
+		{
+			if (payload >= ast->binaries.size)
+				return false;
+			const FlatAst_Binary* binary = &ast->binaries.data[payload];
+			return binary->left < node && binary->right < node;
+		}
+		case AST_EXPR_TERNARY:
+		{
+			if (payload >= ast->ternaries.size)
+				return false;
+			const FlatAst_Ternary* ternary = &ast->ternaries.data[payload];
+			return ternary->left < node && ternary->middle < node && ternary->right < node;
+		}
+		case AST_EXPR_CAST:
+		{
+			if (payload >= ast->casts.size)
+				return false;
+			const FlatAst_Cast* cast = &ast->casts.data[payload];
+			return cast->operand < node && cast->typeName < ast->typeNames.size;
+		}
+		case AST_EXPR_SIZEOF_TYPE:
+			return payload < ast->sizeofTypes.size && ast->sizeofTypes.data[payload].typeName < ast->typeNames.size;
+		case AST_EXPR_MEMBER_ACCESS:
+		{
+			if (payload >= ast->memberAccesses.size)
+				return false;
+			const FlatAst_MemberAccess* memberAccess = &ast->memberAccesses.data[payload];
+			return memberAccess->operand < node && FlatAstFile_IsSymbolValid(self, memberAccess->memberSymbol) &&
+			       FlatAstFile_IsRangeValid(memberAccess->memberName.offset, memberAccess->memberName.length, sourceLength);
+		}
+		case AST_EXPR_CALL:
+		{
+			if (payload >= ast->calls.size)
+				return false;
+			const FlatAst_Call* call = &ast->calls.data[payload];
+			if (call->callee >= node || !FlatAstFile_IsRangeValid(call->firstArgument, call->argumentCount, ast->arguments.size))
+				return false;
+			for (size_t i = 0; i < call->argumentCount; i++)
+			{
+				if (ast->arguments.data[call->firstArgument + i] >= node)
+					return false;
+			}
+			return true;
+		}
+		case AST_EXPR_PRIMARY:
+		{
+			if (payload >= ast->primaries.size)
+				return false;
+			const FlatAst_Primary* primary = &ast->primaries.data[payload];
+			if (primary->tokenType == TOKEN_LITERAL_INTEGER && primary->literalType > TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONGLONG)
+				return false;
+			if (primary->tokenType == TOKEN_LITERAL_FLOAT && primary->literalType > TOKEN_LITERAL_FLOAT_TYPE_DECIMAL128)
+				return false;
+			return FlatAstFile_IsSymbolValid(self, primary->symbol);
+		}
+		default:
+			return false;
+	}
+}
+
+bool FlatAstFile_IsSymbolValid(const FlatAstFile* self, const uint32_t symbol)
+{
+	return symbol == INTERNER_NO_SYMBOL || symbol < self->stringCount;
+}
+
+bool FlatAstFile_IsRangeValid(const uint64_t offset, const uint64_t count, const uint64_t limit)
+{
+	return offset <= limit && count <= limit - offset;
+}
+
+nullable_end
@@ -0,0 +1,83 @@
+#pragma once
+
+#include "FlatAst.h"
+#include "Util/Interner.h"
+
+nullable_begin
+
+// On-disk form of a FlatAst, loaded by mapping the file and pointing the arrays of a FlatAst into it. A file is a
+// header followed by one section per array, each 8-byte aligned and located by its offset from the start of the file.
+// The arrays are written as they are in memory, so a file only loads on a machine with the same byte order and layout,
+// which the header records. Symbols are renumbered into the file's own string table, as the interner that assigned
+// them is not saved.
+#define FLAT_AST_FILE_MAGIC "SCFLAST"
+#define FLAT_AST_FILE_VERSION 1
+#define FLAT_AST_FILE_BYTE_ORDER 0x01020304u
+
+typedef enum
+{
+	FLAT_AST_FILE_SECTION_TYPES,
+	FLAT_AST_FILE_SECTION_PAYLOADS,
+	FLAT_AST_FILE_SECTION_LOCATIONS,
+	FLAT_AST_FILE_SECTION_UNARIES,
+	FLAT_AST_FILE_SECTION_BINARIES,
+	FLAT_AST_FILE_SECTION_TERNARIES,
+	FLAT_AST_FILE_SECTION_CASTS,
+	FLAT_AST_FILE_SECTION_SIZEOF_TYPES,
+	FLAT_AST_FILE_SECTION_MEMBER_ACCESSES,
+	FLAT_AST_FILE_SECTION_CALLS,
+	FLAT_AST_FILE_SECTION_PRIMARIES,
+	FLAT_AST_FILE_SECTION_ARGUMENTS,
+	FLAT_AST_FILE_SECTION_TYPE_NAMES,
+	FLAT_AST_FILE_SECTION_TYPE_SPECIFIERS,
+	FLAT_AST_FILE_SECTION_ROOTS,
+	FLAT_AST_FILE_SECTION_STRINGS, // FlatAst_Span per symbol, into the spellings
+	FLAT_AST_FILE_SECTION_SPELLINGS, // All spellings back to back
+	FLAT_AST_FILE_SECTION_COUNT,
+} FlatAstFile_Section;
+
+typedef struct
+{
+	uint64_t offset;
+	uint64_t count; // Elements, not bytes
+} FlatAstFile_SectionEntry;
+
+typedef struct
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t byteOrder;
+	// The source the AST was parsed from, to tell whether a saved file is still current
+	uint64_t sourceLength;
+	uint64_t sourceHash;
+	FlatAstFile_SectionEntry sections[FLAT_AST_FILE_SECTION_COUNT];
+} FlatAstFile_Header;
+
+// A mapped file. The header, the section bounds and every index and range within the sections are checked on load, in
+// one pass over the nodes.
+typedef struct
+{
+	// Arrays point into the mapping; the lists are never grown or finalized
+	FlatAst ast;
+	const FlatAst_Span* strings;
+	size_t stringCount;
+	const char* spellings;
+	// NULL if the file could not be loaded
+	const void*nullable data;
+	size_t size;
+	// Why the file could not be loaded, NULL if it was
+	const char*nullable error;
+} FlatAstFile;
+
+// Writes ast with its symbols spelled by interner, or without symbols if interner is NULL; returns whether it succeeded
+bool FlatAstFile_Write(const FlatAst* ast, const Interner*nullable interner, const char* path);
+
+// Maps the file at path; locations in it refer to source
+FlatAstFile* FlatAstFile_Init_WithPath(FlatAstFile* self, const char* path, const SourceFile* source);
+void FlatAstFile_Fini(const FlatAstFile* self);
+
+// Whether source has the content the file was written from
+bool FlatAstFile_MatchesSource(const FlatAstFile* self, const SourceFile* source);
+ConstCharSpan FlatAstFile_GetSpelling(const FlatAstFile* self, uint32_t symbol);
+
+nullable_end
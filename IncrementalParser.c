@@ -0,0 +1,437 @@
+#include "IncrementalParser.h"
+
+#include "Lexer.h"
+#include "ParallelParser.h"
+#include "Util/Managed.h"
+
+nullable_begin
+
+static IncrementalParser_Item* IncrementalParser_Item_Init_WithText(IncrementalParser_Item* self, const char* path, ConstCharSpan text, size_t start);
+static void IncrementalParser_Item_Fini(IncrementalParser_Item* self);
+static void IncrementalParser_ApplyEdit(IncrementalParser* self, const IncrementalParser_Edit* edit);
+static void IncrementalParser_Rebuild(IncrementalParser* self, size_t first, size_t end, String* window);
+static void IncrementalParser_ParseItem(IncrementalParser* self, IncrementalParser_Item* item, TypedefTable* visible);
+static void IncrementalParser_DeclareNames(TypedefTable* table, const IncrementalParser_NameList* names);
+static bool IncrementalParser_NamesEqual(const IncrementalParser_NameList* first, const IncrementalParser_NameList* second);
+static void IncrementalParser_MarkNames(UInt8List* affected, const IncrementalParser_NameList* names);
+static bool IncrementalParser_UsesAny(const IncrementalParser_Item* item, const UInt8List* affected);
+static ConstCharSpan IncrementalParser_Item_GetText(const IncrementalParser_Item* item);
+
+IncrementalParser* IncrementalParser_Init_WithSource(IncrementalParser* self, const SourceFile* source)
+{
+	self->path = source->path;
+	self->interner = New(Interner);
+	IncrementalParser_ItemList_Init(&self->items);
+	self->length = 0;
+	self->lexedBytes = 0;
+	self->parsedItems = 0;
+
+	// The first parse is a rebuild of a document without items
+	String* window = New(String);
+	if (source->content)
+		String_AppendConstCharSpan(window, String_AsConstCharSpan((String*)source->content));
+	self->length = String_Length(window);
+	IncrementalParser_Rebuild(self, 0, 0, window);
+	Release(window);
+	return self;
+}
+
+void IncrementalParser_Fini(const IncrementalParser* self)
+{
+	for (size_t i = 0; i < self->items.size; i++)
+		Release(self->items.data[i]);
+	IncrementalParser_ItemList_Fini(&self->items);
+	Release(self->interner);
+}
+
+void IncrementalParser_ApplyEdits(IncrementalParser* self, const IncrementalParser_Edit* edits, const size_t editCount)
+{
+	for (size_t i = 0; i < editCount; i++)
+		IncrementalParser_ApplyEdit(self, &edits[i]);
+}
+
+size_t IncrementalParser_FindItem(const IncrementalParser* self, const size_t offset)
+{
+	assert(self->items.size != 0 && offset <= self->length);
+
+	size_t low = 0;
+	size_t high = self->items.size;
+	while (high - low > 1)
+	{
+		const size_t middle = low + (high - low) / 2;
+		if (self->items.data[middle]->start <= offset)
+			low = middle;
+		else
+			high = middle;
+	}
+	return low;
+}
+
+String* IncrementalParser_GetText(const IncrementalParser* self)
+{
+	String* text = New(String);
+	for (size_t i = 0; i < self->items.size; i++)
+		String_AppendConstCharSpan(text, IncrementalParser_Item_GetText(self->items.data[i]));
+	return text;
+}
+
+void IncrementalParser_GetLineColumn(const IncrementalParser* self, const size_t itemIndex, const size_t offset, size_t* outLine,
+                                     size_t* outColumn)
+{
+	const IncrementalParser_Item* item = self->items.data[itemIndex];
+	SourceFile_GetLineColumn(&item->source, offset, outLine, outColumn);
+	const bool isFirstLine = *outLine == 1;
+	for (size_t i = 0; i < itemIndex; i++)
+		*outLine += self->items.data[i]->lineBreakCount;
+
+	// The item's first line starts in an earlier item; count the characters back to its line break
+	for (size_t i = itemIndex; isFirstLine && i-- > 0;)
+	{
+		const ConstCharSpan text = IncrementalParser_Item_GetText(self->items.data[i]);
+		size_t position = text.length;
+		while (position > 0 && text.data[position - 1] != '\n')
+			position--;
+		*outColumn += text.length - position;
+		if (position > 0)
+			break;
+	}
+}
+
+IncrementalParser_Item* IncrementalParser_Item_Init_WithText(IncrementalParser_Item* self, const char* path, const ConstCharSpan text,
+                                                             const size_t start)
+{
+	String* content = New(String);
+	String_AppendConstCharSpan(content, text);
+
+	size_t lineBreakCount = 0;
+	for (size_t i = 0; i < text.length; i++)
+		lineBreakCount += text.data[i] == '\n';
+
+	*self = (IncrementalParser_Item) {
+		.source = { .path = path, .content = content },
+		.start = start,
+		.lineBreakCount = lineBreakCount,
+		.tokens = New(TokenList),
+		.tokenData = New(Token_DataList),
+		.errors = New(CompilerErrorList),
+	};
+	IncrementalParser_NameList_Init(&self->names);
+	return self;
+}
+
+void IncrementalParser_Item_Fini(IncrementalParser_Item* self)
+{
+	Release(self->arena);
+	IncrementalParser_NameList_Fini(&self->names);
+	Release(self->errors);
+	Release(self->tokenData);
+	Release(self->tokens);
+	SourceFile_Fini(&self->source);
+}
+
+void IncrementalParser_ApplyEdit(IncrementalParser* self, const IncrementalParser_Edit* edit)
+{
+	assert(edit->offset <= self->length && edit->length <= self->length - edit->offset);
+
+	// Damaged items: those overlapping the replaced range, or the one an insertion goes into
+	const size_t first = IncrementalParser_FindItem(self, edit->offset);
+	const size_t last = edit->length != 0 ? IncrementalParser_FindItem(self, edit->offset + edit->length - 1) : first;
+
+	const size_t windowStart = self->items.data[first]->start;
+	String* window = New(String);
+	for (size_t i = first; i <= last; i++)
+		String_AppendConstCharSpan(window, IncrementalParser_Item_GetText(self->items.data[i]));
+
+	// Splice the edit into the damaged text
+	const ConstCharSpan damaged = String_AsConstCharSpan(window);
+	String* edited = New(String);
+	String_AppendConstCharSpan(edited, ConstCharSpan_SubSpan(damaged, 0, edit->offset - windowStart));
+	String_AppendConstCharSpan(edited, edit->text);
+	String_AppendConstCharSpan(edited, ConstCharSpan_SubSpan(damaged, edit->offset + edit->length - windowStart,
+	                                                         damaged.length - (edit->offset + edit->length - windowStart)));
+	Release(window);
+
+	self->length = self->length - edit->length + edit->text.length;
+	IncrementalParser_Rebuild(self, first, last + 1, edited);
+	Release(edited);
+}
+
+// Replaces items [first, end) by items lexed and parsed from window, which is their text after an edit. The window
+// grows by whole items until it ends where the old items did and the token stream resynchronizes there.
+void IncrementalParser_Rebuild(IncrementalParser* self, size_t first, size_t end, String* window)
+{
+	size_t windowStart = first < self->items.size ? self->items.data[first]->start : 0;
+	size_t oldLength = 0;
+	for (size_t i = first; i < end; i++)
+		oldLength += String_Length(self->items.data[i]->source.content);
+
+	using TokenList* tokens = New(TokenList);
+	using Token_DataList* tokenData = New(Token_DataList);
+	using CompilerErrorList* errors = New(CompilerErrorList);
+	ParallelParser_SpanList spans;
+	ParallelParser_SpanList_Init(&spans);
+	size_t growth = 1;
+
+	while (true)
+	{
+		const SourceFile source = { .path = self->path, .content = window };
+		tokens->size = 0;
+		tokenData->size = 0;
+		errors->size = 0;
+		Lexer lexer = Lexer_Create(&source, tokenData, NULL, errors);
+		while (true)
+		{
+			const Token token = Lexer_GetNextToken(&lexer, false, false);
+			TokenList_AppendFromPtr(tokens, &token);
+			if (token.type == TOKEN_EOF)
+				break;
+		}
+		self->lexedBytes += String_Length(window);
+
+		spans.size = 0;
+		ParallelParser_Scan(tokens, &spans);
+
+		if (end < self->items.size)
+		{
+			// The tokens after the window are unaffected only if the last item still ends with the window
+			const ParallelParser_Span*nullable lastSpan = spans.size != 0 ? &spans.data[spans.size - 1] : NULL;
+			const Token*nullable lastToken = lastSpan ? &tokens->data[lastSpan->end - 1] : NULL;
+			if (lastSpan && lastSpan->isTerminated && lastToken->offset + lastToken->length == String_Length(window))
+				break;
+
+			// Grow geometrically, so that damage running to the end of the text is not lexed once per item
+			for (size_t i = 0; i < growth && end < self->items.size; i++)
+			{
+				const IncrementalParser_Item* next = self->items.data[end++];
+				String_AppendConstCharSpan(window, IncrementalParser_Item_GetText(next));
+				oldLength += String_Length(next->source.content);
+			}
+			growth *= 2;
+			continue;
+		}
+
+		// Text without tokens at the end of the document is joined to the item before it
+		if (spans.size == 0 && first > 0)
+		{
+			const IncrementalParser_Item* previous = self->items.data[--first];
+			String* joined = New(String);
+			String_AppendConstCharSpan(joined, IncrementalParser_Item_GetText(previous));
+			String_AppendConstCharSpan(joined, String_AsConstCharSpan(window));
+			String_Resize(window, 0);
+			String_AppendConstCharSpan(window, String_AsConstCharSpan(joined));
+			Release(joined);
+			windowStart = previous->start;
+			oldLength += String_Length(previous->source.content);
+			continue;
+		}
+
+		break;
+	}
+
+	// Cut the window after the last token of each item; leading text goes to the first item, trailing text to the last
+	using IncrementalParser_ItemList* newItems = New(IncrementalParser_ItemList);
+	const ConstCharSpan text = String_AsConstCharSpan(window);
+	size_t cut = 0;
+	for (size_t i = 0; i < spans.size || (i == 0 && spans.size == 0); i++)
+	{
+		size_t nextCut = text.length;
+		if (i + 1 < spans.size)
+		{
+			const Token* lastToken = &tokens->data[spans.data[i].end - 1];
+			nextCut = lastToken->offset + lastToken->length;
+		}
+
+		IncrementalParser_Item* item = NewWith(IncrementalParser_Item, Text, self->path, ConstCharSpan_SubSpan(text, cut, nextCut - cut),
+		                                       windowStart + cut);
+		IncrementalParser_ItemList_Append(newItems, item);
+		cut = nextCut;
+	}
+	ParallelParser_SpanList_Fini(&spans);
+
+	// Typedef names visible at the window are those declared by the items before it
+	TypedefTable visible;
+	TypedefTable_Init(&visible);
+	for (size_t i = 0; i < first; i++)
+		IncrementalParser_DeclareNames(&visible, &self->items.data[i]->names);
+
+	IncrementalParser_NameList oldNames;
+	IncrementalParser_NameList newNames;
+	IncrementalParser_NameList_Init(&oldNames);
+	IncrementalParser_NameList_Init(&newNames);
+	for (size_t i = first; i < end; i++)
+	{
+		const IncrementalParser_NameList* names = &self->items.data[i]->names;
+		for (size_t j = 0; j < names->size; j++)
+			IncrementalParser_NameList_AppendFromPtr(&oldNames, &names->data[j]);
+	}
+	for (size_t i = 0; i < newItems->size; i++)
+	{
+		IncrementalParser_ParseItem(self, newItems->data[i], &visible);
+		const IncrementalParser_NameList* names = &newItems->data[i]->names;
+		for (size_t j = 0; j < names->size; j++)
+			IncrementalParser_NameList_AppendFromPtr(&newNames, &names->data[j]);
+	}
+
+	// Splice the new items in place of the old ones
+	for (size_t i = first; i < end; i++)
+		Release(self->items.data[i]);
+
+	const size_t oldCount = end - first;
+	const size_t tailCount = self->items.size - end;
+	const size_t newSize = self->items.size - oldCount + newItems->size;
+	if (newSize > self->items.size && !IncrementalParser_ItemList_Reserve(&self->items, newSize))
+		abort();
+	memmove(self->items.data + first + newItems->size, self->items.data + end, tailCount * sizeof(IncrementalParser_Item*));
+	memcpy(self->items.data + first, newItems->data, newItems->size * sizeof(IncrementalParser_Item*));
+	self->items.size = newSize;
+
+	const size_t tail = first + newItems->size;
+	const ptrdiff_t delta = (ptrdiff_t)text.length - (ptrdiff_t)oldLength;
+	for (size_t i = tail; i < self->items.size; i++)
+		self->items.data[i]->start = (size_t)((ptrdiff_t)self->items.data[i]->start + delta);
+
+	// Items after the window only need parsing again if they use a name whose meaning changed
+	if (!IncrementalParser_NamesEqual(&oldNames, &newNames))
+	{
+		UInt8List affected;
+		UInt8List_Init(&affected);
+		IncrementalParser_MarkNames(&affected, &oldNames);
+		IncrementalParser_MarkNames(&affected, &newNames);
+
+		for (size_t i = tail; i < self->items.size; i++)
+		{
+			IncrementalParser_Item* item = self->items.data[i];
+			if (!IncrementalParser_UsesAny(item, &affected))
+			{
+				IncrementalParser_DeclareNames(&visible, &item->names);
+				continue;
+			}
+
+			IncrementalParser_NameList previousNames = item->names;
+			IncrementalParser_NameList_Init(&item->names);
+			IncrementalParser_ParseItem(self, item, &visible);
+			if (!IncrementalParser_NamesEqual(&previousNames, &item->names))
+			{
+				IncrementalParser_MarkNames(&affected, &previousNames);
+				IncrementalParser_MarkNames(&affected, &item->names);
+			}
+			IncrementalParser_NameList_Fini(&previousNames);
+		}
+
+		UInt8List_Fini(&affected);
+	}
+
+	IncrementalParser_NameList_Fini(&oldNames);
+	IncrementalParser_NameList_Fini(&newNames);
+	TypedefTable_Fini(&visible);
+}
+
+// Lexes and parses the item with the typedef names in visible, then adds the names the item declares to visible
+void IncrementalParser_ParseItem(IncrementalParser* self, IncrementalParser_Item* item, TypedefTable* visible)
+{
+	Release(item->arena);
+	item->arena = NULL;
+	item->declaration = NULL;
+	item->statement = NULL;
+	item->tokens->size = 0;
+	item->tokenData->size = 0;
+	item->errors->size = 0;
+	item->names.size = 0;
+
+	Lexer lexer = Lexer_Create(&item->source, item->tokenData, self->interner, item->errors);
+	while (true)
+	{
+		const Token token = Lexer_GetNextToken(&lexer, false, false);
+		TokenList_AppendFromPtr(item->tokens, &token);
+		if (token.type == TOKEN_EOF)
+			break;
+	}
+	self->lexedBytes += String_Length(item->source.content);
+
+	if (item->tokens->data[0].type == TOKEN_EOF)
+		return;
+
+	// Items are small, so their arenas are too; the parser needs about a node per token
+	size_t blockSize = item->tokens->size * 128;
+	if (blockSize < 1024)
+		blockSize = 1024;
+	if (blockSize > ARENA_DEFAULT_BLOCK_SIZE)
+		blockSize = ARENA_DEFAULT_BLOCK_SIZE;
+	item->arena = NewWith(Arena, BlockSize, blockSize);
+
+	Parser parser = Parser_Create(&item->source, item->tokens, item->tokenData, item->arena, item->errors);
+	TypedefTable_CopyFileScope(&parser.typedefNames, visible);
+
+	TypedefTable_StartRecording(&parser.typedefNames);
+	const size_t errorCount = item->errors->size;
+	item->declaration = Parser_TryParseDeclaration(&parser);
+	if (!item->declaration && item->errors->size == errorCount)
+		item->statement = Parser_ParseStatement(&parser);
+	self->parsedItems++;
+
+	const UInt32List* declared = &parser.typedefNames.declared;
+	for (size_t i = 0; i < declared->size; i++)
+	{
+		const IncrementalParser_Name name = {
+			.symbol = declared->data[i],
+			.isTypedefName = TypedefTable_IsTypedefName(&parser.typedefNames, declared->data[i]),
+		};
+		IncrementalParser_NameList_AppendFromPtr(&item->names, &name);
+	}
+	Parser_Fini(&parser);
+
+	IncrementalParser_DeclareNames(visible, &item->names);
+}
+
+void IncrementalParser_DeclareNames(TypedefTable* table, const IncrementalParser_NameList* names)
+{
+	for (size_t i = 0; i < names->size; i++)
+		TypedefTable_Declare(table, names->data[i].symbol, names->data[i].isTypedefName);
+}
+
+bool IncrementalParser_NamesEqual(const IncrementalParser_NameList* first, const IncrementalParser_NameList* second)
+{
+	if (first->size != second->size)
+		return false;
+
+	for (size_t i = 0; i < first->size; i++)
+	{
+		if (first->data[i].symbol != second->data[i].symbol || first->data[i].isTypedefName != second->data[i].isTypedefName)
+			return false;
+	}
+	return true;
+}
+
+void IncrementalParser_MarkNames(UInt8List* affected, const IncrementalParser_NameList* names)
+{
+	for (size_t i = 0; i < names->size; i++)
+	{
+		const uint32_t symbol = names->data[i].symbol;
+		if (symbol >= affected->size)
+		{
+			const size_t oldSize = affected->size;
+			if (!UInt8List_Resize(affected, (size_t)symbol + 1))
+				abort();
+			memset(affected->data + oldSize, 0, affected->size - oldSize);
+		}
+		affected->data[symbol] = 1;
+	}
+}
+
+bool IncrementalParser_UsesAny(const IncrementalParser_Item* item, const UInt8List* affected)
+{
+	for (size_t i = 0; i < item->tokens->size; i++)
+	{
+		const Token* token = &item->tokens->data[i];
+		if (token->type == TOKEN_IDENTIFIER && token->symbol < affected->size && affected->data[token->symbol])
+			return true;
+	}
+	return false;
+}
+
+ConstCharSpan IncrementalParser_Item_GetText(const IncrementalParser_Item* item)
+{
+	return String_AsConstCharSpan((String*)item->source.content);
+}
+
+nullable_end
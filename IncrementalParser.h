@@ -0,0 +1,92 @@
+#pragma once
+
+#include "CompilerError.h"
+#include "Parser.h"
+#include "Token.h"
+#include "Util/Arena.h"
+#include "Util/Interner.h"
+
+nullable_begin
+
+// A declaration made by an item, replayed to know the typedef names visible to the items after it
+typedef struct
+{
+	uint32_t symbol;
+	bool isTypedefName;
+} IncrementalParser_Name;
+
+nullable_end
+
+#define LIST_TYPE IncrementalParser_NameList
+#define LIST_ELEMENT_TYPE IncrementalParser_Name
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+nullable_begin
+
+// One top-level declaration or statement with the text around it. Items are lexed and parsed on their own: offsets
+// in their tokens, nodes and errors are relative to the item's text, so edits elsewhere never touch them.
+typedef struct
+{
+	// The item's text; content is the document text [start, start + length)
+	SourceFile source;
+	size_t start;
+	// Line breaks in the text, for turning item offsets into document lines
+	size_t lineBreakCount;
+	TokenList* tokens;
+	Token_DataList* tokenData;
+	// Lexer errors, then parser errors
+	CompilerErrorList* errors;
+	IncrementalParser_NameList names;
+	// Holds the item's nodes, sized to the item
+	Arena*nullable arena;
+	// Neither is set for an item that failed to parse, or for a document without any tokens
+	AstDeclaration*nullable declaration;
+	AstStatement*nullable statement;
+} IncrementalParser_Item;
+
+#define LIST_TYPE IncrementalParser_ItemList
+#define LIST_ELEMENT_TYPE IncrementalParser_Item*
+nullable_end
+#include "Util/ListDef.h"
+nullable_begin
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+// Replaces text [offset, offset + length) with text
+typedef struct
+{
+	size_t offset;
+	size_t length;
+	ConstCharSpan text;
+} IncrementalParser_Edit;
+
+// Keeps a document split into top-level items, and after an edit re-lexes and reparses only the items it damaged.
+// The result always matches lexing the whole text and parsing it with ParallelParser.
+typedef struct
+{
+	const char* path;
+	Interner* interner;
+	// Covers the whole text, in order
+	IncrementalParser_ItemList items;
+	size_t length;
+	// Work done so far, for diagnostics
+	size_t lexedBytes;
+	size_t parsedItems;
+} IncrementalParser;
+
+IncrementalParser* IncrementalParser_Init_WithSource(IncrementalParser* self, const SourceFile* source);
+void IncrementalParser_Fini(const IncrementalParser* self);
+
+// Applies the edits one after the other; each one's offsets refer to the text left by the edits before it
+void IncrementalParser_ApplyEdits(IncrementalParser* self, const IncrementalParser_Edit* edits, size_t editCount);
+
+// Index of the item containing offset; an offset at the end of the text belongs to the last item
+size_t IncrementalParser_FindItem(const IncrementalParser* self, size_t offset);
+// The whole current text
+String* IncrementalParser_GetText(const IncrementalParser* self);
+// Document line and column of an offset within an item
+void IncrementalParser_GetLineColumn(const IncrementalParser* self, size_t itemIndex, size_t offset, size_t* outLine, size_t* outColumn);
+
+nullable_end
@@ -0,0 +1,249 @@
+#include "JsonExport.h"
+
+#include "AstTypeQualifier.h"
+
+nullable_begin
+
+static const char* const JsonExport_integerTypeNames[] = {
+	[TOKEN_LITERAL_INTEGER_TYPE_INT] = "INT",
+	[TOKEN_LITERAL_INTEGER_TYPE_LONG] = "LONG",
+	[TOKEN_LITERAL_INTEGER_TYPE_LONGLONG] = "LONGLONG",
+	[TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDINT] = "UNSIGNEDINT",
+	[TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONG] = "UNSIGNEDLONG",
+	[TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONGLONG] = "UNSIGNEDLONGLONG",
+};
+
+static const char* const JsonExport_floatTypeNames[] = {
+	[TOKEN_LITERAL_FLOAT_TYPE_DOUBLE] = "DOUBLE",
+	[TOKEN_LITERAL_FLOAT_TYPE_FLOAT] = "FLOAT",
+	[TOKEN_LITERAL_FLOAT_TYPE_LONGDOUBLE] = "LONGDOUBLE",
+	[TOKEN_LITERAL_FLOAT_TYPE_BINARY16] = "BINARY16",
+	[TOKEN_LITERAL_FLOAT_TYPE_BINARY32] = "BINARY32",
+	[TOKEN_LITERAL_FLOAT_TYPE_BINARY64] = "BINARY64",
+	[TOKEN_LITERAL_FLOAT_TYPE_DECIMAL32] = "DECIMAL32",
+	[TOKEN_LITERAL_FLOAT_TYPE_DECIMAL64] = "DECIMAL64",
+	[TOKEN_LITERAL_FLOAT_TYPE_DECIMAL128] = "DECIMAL128",
+};
+
+static void JsonExport_WriteTypeName(JsonWriter* writer, const FlatAst* ast, uint32_t typeName);
+static void JsonExport_WritePrimary(JsonWriter* writer, const FlatAst* ast, FlatAst_Node node);
+static bool JsonExport_EnterNode(void* context, const FlatAst* ast, FlatAst_Node node);
+static bool JsonExport_EnterChild(void* context, const FlatAst* ast, FlatAst_Node parent, size_t index);
+static void JsonExport_LeaveNode(void* context, const FlatAst* ast, FlatAst_Node node);
+
+void JsonExport_WriteToken(JsonWriter* writer, const Token* token, const SourceFile* source, const Token_DataList* tokenData)
+{
+	size_t line, column;
+	SourceFile_GetLineColumn(source, token->offset, &line, &column);
+
+	JsonWriter_BeginObject(writer);
+	JsonWriter_Key(writer, "type");
+	JsonWriter_CString(writer, Token_Type_ToString((Token_Type)token->type));
+	JsonWriter_Key(writer, "offset");
+	JsonWriter_UInt(writer, token->offset);
+	JsonWriter_Key(writer, "length");
+	JsonWriter_UInt(writer, token->length);
+	JsonWriter_Key(writer, "line");
+	JsonWriter_UInt(writer, line);
+	JsonWriter_Key(writer, "column");
+	JsonWriter_UInt(writer, column);
+	JsonWriter_Key(writer, "lexeme");
+	JsonWriter_String(writer, Token_GetLexeme(token, source));
+
+	if (token->type == TOKEN_LITERAL_INTEGER && Token_HasData(token))
+	{
+		const Token_LiteralInteger* literal = &Token_GetData(token, tokenData)->literalInteger;
+		JsonWriter_Key(writer, "value");
+		JsonWriter_UInt(writer, literal->decoded);
+		JsonWriter_Key(writer, "base");
+		JsonWriter_UInt(writer, literal->base);
+		JsonWriter_Key(writer, "integerType");
+		JsonWriter_CString(writer, JsonExport_integerTypeNames[literal->type]);
+	}
+	else if (token->type == TOKEN_LITERAL_FLOAT && Token_HasData(token))
+	{
+		const Token_LiteralFloat* literal = &Token_GetData(token, tokenData)->literalDecimalFloat;
+		JsonWriter_Key(writer, "value");
+		JsonWriter_Double(writer, literal->decoded);
+		JsonWriter_Key(writer, "floatType");
+		JsonWriter_CString(writer, JsonExport_floatTypeNames[literal->type]);
+	}
+
+	JsonWriter_EndObject(writer);
+}
+
+void JsonExport_WriteExpression(JsonWriter* writer, const FlatAst* ast, const FlatAst_Node node)
+{
+	const FlatAst_Visitor visitor = {
+		.context = writer,
+		.enter = JsonExport_EnterNode,
+		.enterChild = JsonExport_EnterChild,
+		.leave = JsonExport_LeaveNode,
+	};
+	FlatAst_Walk(ast, node, &visitor);
+}
+
+// {"qualifiers": [...], "specifiers": [...]}
+void JsonExport_WriteTypeName(JsonWriter* writer, const FlatAst* ast, const uint32_t typeName)
+{
+	const FlatAst_TypeName* type = FlatAst_GetTypeName(ast, typeName);
+	JsonWriter_BeginObject(writer);
+	JsonWriter_Key(writer, "qualifiers");
+	JsonWriter_BeginArray(writer);
+#define X(name, value) \
+	if ((value) != 0 && (type->qualifiers & (value))) \
+		JsonWriter_CString(writer, #name);
+	AST_TYPEQUALIFIERS_ENUM_VALUES
+#undef X
+	JsonWriter_EndArray(writer);
+
+	JsonWriter_Key(writer, "specifiers");
+	JsonWriter_BeginArray(writer);
+	for (size_t i = 0; i < type->specifierCount; i++)
+	{
+		const FlatAst_TypeSpecifier* specifier = &ast->typeSpecifiers.data[type->firstSpecifier + i];
+		JsonWriter_CString(writer, AstTypeSpecifier_Type_ToString((AstTypeSpecifier_Type)specifier->type));
+	}
+	JsonWriter_EndArray(writer);
+	JsonWriter_EndObject(writer);
+}
+
+// Folded constants have no lexeme, only a value
+void JsonExport_WritePrimary(JsonWriter* writer, const FlatAst* ast, const FlatAst_Node node)
+{
+	const FlatAst_Primary* primary = FlatAst_GetPrimary(ast, node);
+	JsonWriter_Key(writer, "token");
+	JsonWriter_CString(writer, Token_Type_ToString((Token_Type)primary->tokenType));
+	JsonWriter_Key(writer, "folded");
+	JsonWriter_Bool(writer, primary->isFolded);
+	if (!primary->isFolded)
+	{
+		JsonWriter_Key(writer, "lexeme");
+		JsonWriter_String(writer, FlatAst_GetLocation(ast, node).snippet);
+	}
+
+	if (primary->tokenType == TOKEN_LITERAL_INTEGER)
+	{
+		const bool isSigned = primary->literalType <= TOKEN_LITERAL_INTEGER_TYPE_LONGLONG;
+		JsonWriter_Key(writer, "value");
+		if (primary->isFolded && isSigned)
+			JsonWriter_Int(writer, (int64_t)primary->value.integer);
+		else
+			JsonWriter_UInt(writer, primary->value.integer);
+		JsonWriter_Key(writer, "integerType");
+		JsonWriter_CString(writer, JsonExport_integerTypeNames[primary->literalType]);
+	}
+	else if (primary->tokenType == TOKEN_LITERAL_FLOAT)
+	{
+		JsonWriter_Key(writer, "value");
+		JsonWriter_Double(writer, primary->value.floating);
+		JsonWriter_Key(writer, "floatType");
+		JsonWriter_CString(writer, JsonExport_floatTypeNames[primary->literalType]);
+	}
+}
+
+bool JsonExport_EnterNode(void* context, const FlatAst* ast, const FlatAst_Node node)
+{
+	JsonWriter* writer = (JsonWriter*)context;
+	const AstExpression_Type type = FlatAst_GetType(ast, node);
+	const FlatAst_Span location = ast->locations.data[node];
+	JsonWriter_BeginObject(writer);
+	JsonWriter_Key(writer, "kind");
+	JsonWriter_CString(writer, AstExpression_Type_ToString(type));
+	JsonWriter_Key(writer, "offset");
+	JsonWriter_UInt(writer, location.offset);
+	JsonWriter_Key(writer, "length");
+	JsonWriter_UInt(writer, location.length);
+
+	switch (type)
+	{
+		case AST_EXPR_UNARY:
+			JsonWriter_Key(writer, "operator");
+			JsonWriter_CString(writer, AstUnaryOperation_ToString((AstUnaryOperation)FlatAst_GetUnary(ast, node)->operation));
+			break;
+		case AST_EXPR_BINARY:
+			JsonWriter_Key(writer, "operator");
+			JsonWriter_CString(writer, AstBinaryOperation_ToString((AstBinaryOperation)FlatAst_GetBinary(ast, node)->operation));
+			break;
+		case AST_EXPR_TERNARY:
+			JsonWriter_Key(writer, "operator");
+			JsonWriter_CString(writer, AstTernaryOperation_ToString((AstTernaryOperation)FlatAst_GetTernary(ast, node)->operation));
+			break;
+		case AST_EXPR_CAST:
+			JsonWriter_Key(writer, "typeName");
+			JsonExport_WriteTypeName(writer, ast, FlatAst_GetCast(ast, node)->typeName);
+			break;
+		case AST_EXPR_SIZEOF_TYPE:
+			JsonWriter_Key(writer, "typeName");
+			JsonExport_WriteTypeName(writer, ast, FlatAst_GetSizeofType(ast, node)->typeName);
+			break;
+		case AST_EXPR_MEMBER_ACCESS:
+		{
+			const FlatAst_MemberAccess* memberAccess = FlatAst_GetMemberAccess(ast, node);
+			JsonWriter_Key(writer, "member");
+			JsonWriter_String(writer, SourceLocation_Create(ast->source, memberAccess->memberName.offset, memberAccess->memberName.length).snippet);
+			JsonWriter_Key(writer, "isPointerAccess");
+			JsonWriter_Bool(writer, memberAccess->isPointerAccess);
+			break;
+		}
+		case AST_EXPR_CALL:
+			break;
+		case AST_EXPR_PRIMARY:
+			JsonExport_WritePrimary(writer, ast, node);
+			break;
+		default:
+			assert(false && "unreachable");
+			break;
+	}
+	return true;
+}
+
+bool JsonExport_EnterChild(void* context, const FlatAst* ast, const FlatAst_Node parent, const size_t index)
+{
+	JsonWriter* writer = (JsonWriter*)context;
+	switch (FlatAst_GetType(ast, parent))
+	{
+		case AST_EXPR_UNARY:
+		case AST_EXPR_CAST:
+		case AST_EXPR_MEMBER_ACCESS:
+			JsonWriter_Key(writer, "operand");
+			break;
+		case AST_EXPR_BINARY:
+			JsonWriter_Key(writer, index == 0 ? "left" : "right");
+			break;
+		case AST_EXPR_TERNARY:
+			JsonWriter_Key(writer, index == 0 ? "left" : index == 1 ? "middle" : "right");
+			break;
+		case AST_EXPR_CALL:
+			if (index == 0)
+				JsonWriter_Key(writer, "callee");
+			else if (index == 1)
+			{
+				JsonWriter_Key(writer, "arguments");
+				JsonWriter_BeginArray(writer);
+			}
+			break;
+		default:
+			assert(false && "unreachable");
+			break;
+	}
+	return true;
+}
+
+void JsonExport_LeaveNode(void* context, const FlatAst* ast, const FlatAst_Node node)
+{
+	JsonWriter* writer = (JsonWriter*)context;
+	if (FlatAst_GetType(ast, node) == AST_EXPR_CALL)
+	{
+		// The arguments array is opened before the first argument, so a call without any opens it here
+		if (FlatAst_GetCall(ast, node)->argumentCount == 0)
+		{
+			JsonWriter_Key(writer, "arguments");
+			JsonWriter_BeginArray(writer);
+		}
+		JsonWriter_EndArray(writer);
+	}
+	JsonWriter_EndObject(writer);
+}
+
+nullable_end
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "FlatAst.h"
+#include "Token.h"
+#include "Util/JsonWriter.h"
+
+nullable_begin
+
+// JSON forms of tokens and expressions, for tools rather than people. Enumerations are written by the names of their
+// values (e.g. "LITERAL_INTEGER", "BINARY", "ADD"), and locations by byte offset and length into the source.
+#define JSON_EXPORT_SCHEMA_VERSION 1
+
+// {"type", "offset", "length", "line", "column", "lexeme"}, plus "value", "base" and "integerType" for integer
+// literals and "value" and "floatType" for floating literals
+void JsonExport_WriteToken(JsonWriter* writer, const Token* token, const SourceFile* source, const Token_DataList* tokenData);
+
+// {"kind", "offset", "length", ...}: the fields of the node, then its children by name ("operand", "left", "middle",
+// "right", "callee", "arguments")
+void JsonExport_WriteExpression(JsonWriter* writer, const FlatAst* ast, FlatAst_Node node);
+
+nullable_end
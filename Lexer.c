@@ -1,13 +1,19 @@
 #include "Lexer.h"
 
 #include <ctype.h>
+#include <limits.h>
 
 #include "SourceFile.h"
+#include "Util/Number.h"
+#include "Util/Scan.h"
 
 nullable_begin
 
-static char Lexer_PeekChar(const Lexer* self);
+static char Lexer_PeekChar(Lexer* self);
 static char Lexer_ConsumeChar(Lexer* self);
+static void Lexer_AdvanceTo(Lexer* self, size_t position);
+static Token Lexer_CreateToken(Lexer* self, Token_Type type, size_t offset, size_t length, const Token_Data*nullable data);
+static Token_LiteralInteger_Type Lexer_GetIntegerLiteralType(Token_LiteralInteger_Type suffixType, bool isDecimal, uint64_t value);
 
 static bool IsDigit(const char c)
 {
@@ -29,44 +35,52 @@ static bool IsHexDigit(const char c)
 	return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
 }
 
-Lexer Lexer_Create(const SourceFile* source, CompilerErrorList* errorList)
+Lexer Lexer_Create(const SourceFile* source, Token_DataList* tokenData, Interner*nullable interner, CompilerErrorList* errorList)
 {
+	const size_t length = source->content ? String_Length((String*)source->content) : 0;
+	return Lexer_Create_WithRange(source, 0, length, tokenData, interner, errorList);
+}
+
+Lexer Lexer_Create_WithRange(const SourceFile* source, const size_t begin, const size_t end, Token_DataList* tokenData,
+                             Interner*nullable interner, CompilerErrorList* errorList)
+{
+	// Token offsets and lengths are 32-bit
+	assert(!source->content || String_Length((String*)source->content) <= UINT32_MAX);
+	assert(begin <= end && (source->content ? end <= String_Length((String*)source->content) : end == 0));
+
 	return (Lexer) {
 		.source = source,
-		.position = 0,
-		.line = 1,
-		.column = 1,
+		.position = begin,
+		.end = end,
+		.overran = false,
+		.tokenData = tokenData,
+		.interner = interner,
 		.errors = errorList,
 	};
 }
 
 Token Lexer_GetNextToken(Lexer* self, const bool includeWhitespace, const bool includeComments)
 {
-	size_t startPosition, startLine, startColumn;
+	size_t startPosition;
 restart:
 	startPosition = self->position;
-	startLine = self->line;
-	startColumn = self->column;
 
 	String* content = self->source->content;
 
-	if (!content || self->position >= String_Length(content))
+	if (!content || self->position >= self->end)
 	{
-		return Token_Create(TOKEN_EOF, SourceLocation_Create(self->source, startPosition, 0, startLine, startColumn), (Token_Data) { 0 });
+		return Lexer_CreateToken(self, TOKEN_EOF, startPosition, 0, NULL);
 	}
 
 	// Whitespace
 	char c = Lexer_ConsumeChar(self);
 	if (c == ' ' || c == '\t' || c == '\n')
 	{
-		while (((c = Lexer_PeekChar(self))) && (c == ' ' || c == '\t' || c == '\n'))
-			Lexer_ConsumeChar(self);
+		Lexer_AdvanceTo(self, Scan_SkipWhitespace(String_AsCString(content), self->position, self->end));
 
 		if (includeWhitespace)
 		{
-			return Token_Create(TOKEN_WHITESPACE,
-			                    SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn),
-			                    (Token_Data) { 0 });
+			return Lexer_CreateToken(self, TOKEN_WHITESPACE, startPosition, self->position - startPosition, NULL);
 		}
 
 		goto restart;
@@ -74,8 +88,8 @@ restart:
 
 	char buf3[3];
 	buf3[0] = c;
-	buf3[1] = self->position < content->length ? String_AsCString(content)[self->position] : '\0';
-	buf3[2] = self->position + 1 < content->length ? String_AsCString(content)[self->position + 1] : '\0';
+	buf3[1] = self->position < self->end ? String_AsCString(content)[self->position] : '\0';
+	buf3[2] = self->position + 1 < self->end ? String_AsCString(content)[self->position + 1] : '\0';
 
 	// Comments
 	if (buf3[0] == '/' && buf3[1] == '/')
@@ -83,22 +97,23 @@ restart:
 		// Single-line comment
 		Lexer_ConsumeChar(self); // Consume second '/'
 
-		while (((c = Lexer_PeekChar(self))) && c != '\n')
+		while (true)
 		{
+			// Skip to the next byte that ends the comment or may continue it onto the next line
+			Lexer_AdvanceTo(self, Scan_FindSingleLineCommentStop(String_AsCString(content), self->position, self->end));
+
+			if (Lexer_PeekChar(self) != '\\')
+				break;
+
+			// Line continuation
 			Lexer_ConsumeChar(self);
-			if (c == '\\')
-			{
-				// Line continuation
-				if (Lexer_PeekChar(self) == '\n')
-					Lexer_ConsumeChar(self);
-			}
+			if (Lexer_PeekChar(self) == '\n')
+				Lexer_ConsumeChar(self);
 		}
 
 		if (includeComments)
 		{
-			return Token_Create(TOKEN_COMMENT_SINGLELINE,
-			                    SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn),
-			                    (Token_Data) { 0 });
+			return Lexer_CreateToken(self, TOKEN_COMMENT_SINGLELINE, startPosition, self->position - startPosition, NULL);
 		}
 
 		goto restart;
@@ -111,10 +126,13 @@ restart:
 
 		while (true)
 		{
+			// Skip to the next byte that may end the comment
+			Lexer_AdvanceTo(self, Scan_FindMultiLineCommentStop(String_AsCString(content), self->position, self->end));
+
 			c = Lexer_ConsumeChar(self);
 			if (c == '\0')
 			{
-				const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn);
+				const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition);
 				CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_UnterminatedComment, errorLoc));
 				break;
 			}
@@ -128,9 +146,7 @@ restart:
 
 		if (includeComments)
 		{
-			return Token_Create(TOKEN_COMMENT_MULTILINE,
-			                    SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn),
-			                    (Token_Data) { 0 });
+			return Lexer_CreateToken(self, TOKEN_COMMENT_MULTILINE, startPosition, self->position - startPosition, NULL);
 		}
 
 		goto restart;
@@ -178,7 +194,7 @@ restart:
 		// Invalid (floating-point literal cannot be binary)
 		if (!isInteger && isBin)
 		{
-			const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn);
+			const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition);
 			CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_InvalidNumericLiteral, errorLoc));
 		}
 
@@ -187,8 +203,8 @@ restart:
 		{
 			// Read suffix
 			buf3[0] = (char)tolower(Lexer_PeekChar(self));
-			buf3[1] = self->position + 1 < content->length ? (char)tolower(String_AsCString(content)[self->position + 1]) : '\0';
-			buf3[2] = self->position + 2 < content->length ? (char)tolower(String_AsCString(content)[self->position + 2]) : '\0';
+			buf3[1] = self->position + 1 < self->end ? (char)tolower(String_AsCString(content)[self->position + 1]) : '\0';
+			buf3[2] = self->position + 2 < self->end ? (char)tolower(String_AsCString(content)[self->position + 2]) : '\0';
 
 			// Determine type based on suffix
 			Token_LiteralInteger_Type type = TOKEN_LITERAL_INTEGER_TYPE_INT;
@@ -234,13 +250,21 @@ restart:
 			// Invalid octal literal
 			if (base == 8 && !isValidOctal)
 			{
-				const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn);
+				const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition);
 				CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_InvalidNumericLiteral, errorLoc));
 			}
 
-			return Token_Create(TOKEN_LITERAL_INTEGER,
-			                    SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn),
-			                    (Token_Data) { .literalInteger = { integerPart, base, type } });
+			// Decode the value, which may promote the type beyond the one given by the suffix
+			uint64_t decoded = 0;
+			if (!Number_ParseUnsigned(integerPart, (unsigned)base, &decoded))
+			{
+				const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition);
+				CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_IntegerLiteralTooLarge, errorLoc));
+			}
+			type = Lexer_GetIntegerLiteralType(type, base == 10, decoded);
+
+			return Lexer_CreateToken(self, TOKEN_LITERAL_INTEGER, startPosition, self->position - startPosition,
+			                         &(Token_Data) { .literalInteger = { integerPart, base, type, decoded } });
 		}
 
 		// Floating-point literal
@@ -256,7 +280,7 @@ restart:
 
 			// Consume fractional digits
 			const size_t fracStart = self->position;
-			while (((c = Lexer_PeekChar(self))) && IsHexDigit(c))
+			while (((c = Lexer_PeekChar(self))) && (isHex ? IsHexDigit(c) : IsDigit(c)))
 				Lexer_ConsumeChar(self);
 
 			// Determine if there actually is a fractional part
@@ -283,13 +307,26 @@ restart:
 			hasExponent = self->position > expStart;
 			if (!hasExponent)
 			{
-				const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn);
+				const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition);
 				CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_InvalidNumericLiteral, errorLoc));
 			}
 
 			exponent = ConstCharSpan_SubSpan(String_AsConstCharSpan(content), expStart, self->position - expStart);
 		}
 
+		// Decode the value; exponents far outside the range of double saturate
+		uint64_t exponentMagnitude = 0;
+		if (!Number_ParseUnsigned(exponent, 10, &exponentMagnitude) || exponentMagnitude > NUMBER_EXPONENT_LIMIT)
+			exponentMagnitude = NUMBER_EXPONENT_LIMIT;
+		const int64_t exponentValue = exponentIsNegative ? -(int64_t)exponentMagnitude : (int64_t)exponentMagnitude;
+
+		const ConstCharSpan integerDigits = hasIntegerPart ? integerPart : ConstCharSpan_Empty;
+		double decoded = 0.0;
+		if (isHex)
+			decoded = Number_HexToDouble(integerDigits, fractionalPart, exponentValue);
+		else if (isDecimalOrOctal)
+			decoded = Number_DecimalToDouble(integerDigits, fractionalPart, exponentValue);
+
 		Token_LiteralFloat_Type suffix = TOKEN_LITERAL_FLOAT_TYPE_DOUBLE;
 		// Consume suffix
 		char suffixChar = (char)tolower(Lexer_PeekChar(self));
@@ -311,7 +348,7 @@ restart:
 					break;
 				default:
 				{
-					const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn);
+					const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition);
 					CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_InvalidNumericLiteral, errorLoc));
 				}
 			}
@@ -326,7 +363,7 @@ restart:
 				case 'f':
 				{
 					buf3[0] = (char)tolower(Lexer_PeekChar(self));
-					buf3[1] = self->position + 1 < content->length
+					buf3[1] = self->position + 1 < self->end
 						          ? (char)tolower(String_AsCString(content)[self->position + 1])
 						          : '\0';
 					const bool isF16 = buf3[0] == '1' && buf3[1] == '6';
@@ -356,22 +393,22 @@ restart:
 			}
 		}
 
-		return Token_Create(TOKEN_LITERAL_FLOAT,
-		                    SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn),
-		                    (Token_Data) {
-			                    .literalDecimalFloat =
-			                    {
-				                    isHex,
-				                    hasIntegerPart,
-				                    integerPart,
-				                    hasFractionalPart,
-				                    fractionalPart,
-				                    hasExponent,
-				                    exponentIsNegative,
-				                    exponent,
-				                    suffix
-			                    }
-		                    });
+		return Lexer_CreateToken(self, TOKEN_LITERAL_FLOAT, startPosition, self->position - startPosition,
+		                         &(Token_Data) {
+			                         .literalDecimalFloat =
+			                         {
+				                         isHex,
+				                         hasIntegerPart,
+				                         integerPart,
+				                         hasFractionalPart,
+				                         fractionalPart,
+				                         hasExponent,
+				                         exponentIsNegative,
+				                         exponent,
+				                         suffix,
+				                         decoded
+			                         }
+		                         });
 	}
 
 	// String and character literals
@@ -384,7 +421,7 @@ restart:
 
 			if (c == '\0' || c == '\n')
 			{
-				const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn);
+				const SourceLocation errorLoc = SourceLocation_Create(self->source, startPosition, self->position - startPosition);
 				CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_UnterminatedStringLiteral, errorLoc));
 				goto restart;
 			}
@@ -399,26 +436,18 @@ restart:
 		}
 
 		const Token_Type type = quoteChar == '"' ? TOKEN_LITERAL_STRING : TOKEN_LITERAL_CHAR;
-		return Token_Create(type,
-		                    SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn),
-		                    (Token_Data) { 0 });
+		return Lexer_CreateToken(self, type, startPosition, self->position - startPosition, NULL);
 	}
 
 	// Punctuators
-	for (size_t i = 0; i < sizeof(punctuators) / sizeof(TokenStringMapEntry); i++)
+	Token_Type punctuator;
+	const size_t punctuatorLength = Token_MatchPunctuator(buf3, &punctuator);
+	if (punctuatorLength != 0)
 	{
-		const TokenStringMapEntry* entry = &punctuators[i];
-
-		const size_t len = strlen(entry->str);
-		if (strncmp(buf3, entry->str, len) == 0)
-		{
-			for (size_t k = 1; k < len; k++)
-				Lexer_ConsumeChar(self);
+		for (size_t k = 1; k < punctuatorLength; k++)
+			Lexer_ConsumeChar(self);
 
-			return Token_Create(entry->type,
-			                    SourceLocation_Create(self->source, startPosition, len, startLine, startColumn),
-			                    (Token_Data) { 0 });
-		}
+		return Lexer_CreateToken(self, punctuator, startPosition, punctuatorLength, NULL);
 	}
 
 	// Identifiers and keywords
@@ -427,35 +456,29 @@ restart:
 		while (((c = Lexer_PeekChar(self))) && ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'))
 			Lexer_ConsumeChar(self);
 
-		const SourceLocation lexeme = SourceLocation_Create(self->source, startPosition, self->position - startPosition, startLine, startColumn);
+		const ConstCharSpan lexeme = ConstCharSpan_SubSpan(String_AsConstCharSpan(content), startPosition, self->position - startPosition);
+		const Token_Type type = Token_LookupKeyword(lexeme);
 
-		for (size_t i = 0; i < sizeof(keywords) / sizeof(TokenStringMapEntry); i++)
-		{
-			const TokenStringMapEntry* entry = &keywords[i];
-
-			if (strlen(entry->str) == lexeme.snippet.length && memcmp(lexeme.snippet.data, entry->str, lexeme.snippet.length) == 0)
-				return Token_Create(entry->type,
-				                    lexeme,
-				                    (Token_Data) { 0 });
-		}
+		Token token = Lexer_CreateToken(self, type, startPosition, lexeme.length, NULL);
+		if (type == TOKEN_IDENTIFIER && self->interner)
+			token.symbol = Interner_Intern((Interner*)self->interner, lexeme);
 
-		return Token_Create(TOKEN_IDENTIFIER,
-		                    lexeme,
-		                    (Token_Data) { .literalIdentifier = { lexeme.snippet } });
+		return token;
 	}
 
 	// Unexpected character
-	return Token_Create(TOKEN_UNEXPECTED,
-	                    SourceLocation_Create(self->source, startPosition, 1, startLine, startColumn),
-	                    (Token_Data) { 0 });
+	return Lexer_CreateToken(self, TOKEN_UNEXPECTED, startPosition, 1, NULL);
 }
 
-char Lexer_PeekChar(const Lexer* self)
+char Lexer_PeekChar(Lexer* self)
 {
 	const String* content = (String*)self->source->content;
 
-	if (self->position >= content->length)
+	if (self->position >= self->end)
+	{
+		self->overran = true;
 		return '\0';
+	}
 
 	const char c = String_AsCString(content)[self->position];
 
@@ -469,31 +492,77 @@ char Lexer_ConsumeChar(Lexer* self)
 {
 	const String* content = (String*)self->source->content;
 
-	if (self->position >= content->length)
+	if (self->position >= self->end)
+	{
+		self->overran = true;
 		return '\0';
+	}
 
 	const char c = String_AsCString(content)[self->position++];
 	if (c == '\r')
 	{
-		if (self->position < content->length && String_AsCString(content)[self->position] == '\n')
+		if (self->position < self->end && String_AsCString(content)[self->position] == '\n')
 			self->position++;
 
-		self->line++;
-		self->column = 1;
 		return '\n';
 	}
 
-	if (c == '\n')
+	return c;
+}
+
+void Lexer_AdvanceTo(Lexer* self, const size_t position)
+{
+	assert(position >= self->position && position <= self->end);
+	self->position = position;
+}
+
+// First type in the C11 6.4.4.1 list for the suffix that can represent the value.
+// Decimal literals without a 'u' suffix only use signed types, falling back to unsigned long long like GCC.
+Token_LiteralInteger_Type Lexer_GetIntegerLiteralType(const Token_LiteralInteger_Type suffixType, const bool isDecimal, const uint64_t value)
+{
+	static const struct
+	{
+		Token_LiteralInteger_Type type;
+		bool isUnsigned;
+		uint64_t max;
+	} candidates[] = {
+		{ TOKEN_LITERAL_INTEGER_TYPE_INT, false, INT_MAX },
+		{ TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDINT, true, UINT_MAX },
+		{ TOKEN_LITERAL_INTEGER_TYPE_LONG, false, LONG_MAX },
+		{ TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONG, true, ULONG_MAX },
+		{ TOKEN_LITERAL_INTEGER_TYPE_LONGLONG, false, LLONG_MAX },
+		{ TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONGLONG, true, ULLONG_MAX },
+	};
+	const size_t candidateCount = sizeof(candidates) / sizeof(candidates[0]);
+
+	size_t first = 0;
+	while (candidates[first].type != suffixType)
+		first++;
+
+	const bool isUnsigned = candidates[first].isUnsigned;
+	for (size_t i = first; i < candidateCount; i++)
 	{
-		self->line++;
-		self->column = 1;
+		// Unsigned suffixes only allow unsigned types, decimal literals without one only signed types
+		if (candidates[i].isUnsigned != isUnsigned && (isUnsigned || isDecimal))
+			continue;
+
+		if (value <= candidates[i].max)
+			return candidates[i].type;
 	}
-	else
+
+	return TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONGLONG;
+}
+
+Token Lexer_CreateToken(Lexer* self, const Token_Type type, const size_t offset, const size_t length, const Token_Data*nullable data)
+{
+	uint32_t dataIndex = TOKEN_NO_DATA;
+	if (data)
 	{
-		self->column++;
+		dataIndex = (uint32_t)self->tokenData->size;
+		Token_DataList_AppendFromPtr(self->tokenData, data);
 	}
 
-	return c;
+	return Token_Create(type, offset, length, dataIndex);
 }
 
 nullable_end
@@ -3,6 +3,7 @@
 #include "CompilerError.h"
 #include "SourceFile.h"
 #include "Token.h"
+#include "Util/Interner.h"
 
 nullable_begin
 
@@ -10,12 +11,21 @@ typedef struct
 {
 	const SourceFile* source;
 	size_t position;
-	size_t line;
-	size_t column;
+	// Lexing stops here, as if the source ended at this offset
+	size_t end;
+	// Set when a token or comment needed input at or past end, i.e. it would continue past a range split
+	bool overran;
+	// Payloads of literal tokens, referenced by Token.dataIndex
+	Token_DataList* tokenData;
+	// Identifier spellings are interned here and their symbol IDs stored in Token.symbol, if set
+	Interner*nullable interner;
 	CompilerErrorList* errors;
 } Lexer;
 
-Lexer Lexer_Create(const SourceFile* source, CompilerErrorList* errorList);
+Lexer Lexer_Create(const SourceFile* source, Token_DataList* tokenData, Interner*nullable interner, CompilerErrorList* errorList);
+// Lexes only content[begin, end), reporting EOF at end
+Lexer Lexer_Create_WithRange(const SourceFile* source, size_t begin, size_t end, Token_DataList* tokenData,
+                             Interner*nullable interner, CompilerErrorList* errorList);
 Token Lexer_GetNextToken(Lexer* self, bool includeWhitespace, bool includeComments);
 
 nullable_end
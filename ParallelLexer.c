@@ -0,0 +1,195 @@
+#include "ParallelLexer.h"
+
+#include <pthread.h>
+
+#include "Lexer.h"
+#include "Util/Managed.h"
+#include "Util/Scan.h"
+
+nullable_begin
+
+typedef struct
+{
+	const SourceFile* source;
+	size_t begin;
+	size_t end;
+	TokenList* tokens;
+	Token_DataList* tokenData;
+	CompilerErrorList* errors;
+	// Something was still being lexed at end, so the split after this chunk was not a token boundary
+	bool overran;
+} ParallelLexer_Chunk;
+
+static size_t ParallelLexer_FindSplit(const char* data, size_t position, size_t length);
+static void ParallelLexer_LexChunk(ParallelLexer_Chunk* chunk);
+static void* ParallelLexer_Worker(void* chunk);
+static void ParallelLexer_AppendChunk(const ParallelLexer_Chunk* chunk, TokenList* tokens, Token_DataList* tokenData,
+                                      Interner*nullable interner, CompilerErrorList* errorList);
+
+void ParallelLexer_Tokenize(const SourceFile* source, const size_t threadCount, const size_t minChunkSize,
+                            TokenList* tokens, Token_DataList* tokenData, Interner*nullable interner, CompilerErrorList* errorList)
+{
+	const size_t length = source->content ? String_Length((String*)source->content) : 0;
+
+	size_t chunkCount = minChunkSize != 0 ? length / minChunkSize : threadCount;
+	if (chunkCount > threadCount)
+		chunkCount = threadCount;
+	if (chunkCount == 0)
+		chunkCount = 1;
+
+	ParallelLexer_Chunk* chunks = (ParallelLexer_Chunk*)calloc(chunkCount, sizeof(ParallelLexer_Chunk));
+	pthread_t* threads = (pthread_t*)calloc(chunkCount, sizeof(pthread_t));
+	if (chunks == NULL || threads == NULL)
+		abort();
+
+	// Pre-pass: pick a line break near each evenly spaced offset as a speculative split
+	size_t begin = 0;
+	size_t count = 0;
+	for (size_t i = 1; i <= chunkCount && begin < length; i++)
+	{
+		size_t end = length;
+		if (i < chunkCount)
+		{
+			const size_t target = length / chunkCount * i;
+			end = ParallelLexer_FindSplit(String_AsCString((String*)source->content), target > begin ? target : begin, length);
+		}
+
+		chunks[count++] = (ParallelLexer_Chunk) {
+			.source = source,
+			.begin = begin,
+			.end = end,
+			.tokens = New(TokenList),
+			.tokenData = New(Token_DataList),
+			.errors = New(CompilerErrorList),
+		};
+		begin = end;
+	}
+
+	// The calling thread lexes the first chunk itself
+	for (size_t i = 1; i < count; i++)
+	{
+		if (pthread_create(&threads[i], NULL, ParallelLexer_Worker, &chunks[i]) != 0)
+			abort();
+	}
+
+	if (count != 0)
+		ParallelLexer_LexChunk(&chunks[0]);
+
+	for (size_t i = 1; i < count; i++)
+		pthread_join(threads[i], NULL);
+
+	// Verify the splits while stitching the chunks together in order
+	for (size_t i = 0; i < count;)
+	{
+		size_t next = i + 1;
+
+		// The split was inside a comment or literal: lex this chunk again merged with the following one
+		while (chunks[i].overran && next < count)
+		{
+			chunks[i].end = chunks[next++].end;
+			ParallelLexer_LexChunk(&chunks[i]);
+		}
+
+		ParallelLexer_AppendChunk(&chunks[i], tokens, tokenData, interner, errorList);
+		i = next;
+	}
+
+	const Token eof = Token_Create(TOKEN_EOF, length, 0, TOKEN_NO_DATA);
+	TokenList_AppendFromPtr(tokens, &eof);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		Release(chunks[i].tokens);
+		Release(chunks[i].tokenData);
+		Release(chunks[i].errors);
+	}
+
+	free(chunks);
+	free(threads);
+}
+
+// Returns the offset just after the first '\n' at or after position that is likely outside of comments
+// and literals, or length if there is none
+size_t ParallelLexer_FindSplit(const char* data, size_t position, const size_t length)
+{
+	while (true)
+	{
+		position = Scan_FindLineBreak(data, position, length);
+		if (position >= length)
+			return length;
+
+		const size_t lineBreak = position++;
+		if (data[lineBreak] != '\n')
+			continue;
+
+		// Line continuations join the next line onto this one
+		size_t lineEnd = lineBreak;
+		if (lineEnd > 0 && data[lineEnd - 1] == '\r')
+			lineEnd--;
+		if (lineEnd > 0 && data[lineEnd - 1] == '\\')
+			continue;
+
+		// Lines starting with '*' are most likely inside a multi-line comment
+		const size_t lineStart = Scan_SkipWhitespace(data, position, length);
+		if (lineStart < length && data[lineStart] == '*')
+			continue;
+
+		return position;
+	}
+}
+
+void ParallelLexer_LexChunk(ParallelLexer_Chunk* chunk)
+{
+	chunk->tokens->size = 0;
+	chunk->tokenData->size = 0;
+	chunk->errors->size = 0;
+
+	// Interning is left to the (sequential) stitching step
+	Lexer lexer = Lexer_Create_WithRange(chunk->source, chunk->begin, chunk->end, chunk->tokenData, NULL, chunk->errors);
+	while (true)
+	{
+		const Token token = Lexer_GetNextToken(&lexer, false, false);
+		if (token.type == TOKEN_EOF)
+			break;
+
+		TokenList_AppendFromPtr(chunk->tokens, &token);
+	}
+
+	chunk->overran = lexer.overran;
+}
+
+void* ParallelLexer_Worker(void* chunk)
+{
+	ParallelLexer_LexChunk((ParallelLexer_Chunk*)chunk);
+	return NULL;
+}
+
+void ParallelLexer_AppendChunk(const ParallelLexer_Chunk* chunk, TokenList* tokens, Token_DataList* tokenData,
+                               Interner*nullable interner, CompilerErrorList* errorList)
+{
+	const uint32_t dataBase = (uint32_t)tokenData->size;
+
+	const size_t tokenBase = tokens->size;
+	if (!TokenList_Resize(tokens, tokenBase + chunk->tokens->size))
+		abort();
+
+	for (size_t i = 0; i < chunk->tokens->size; i++)
+	{
+		Token token = chunk->tokens->data[i];
+		if (Token_HasData(&token))
+			token.dataIndex += dataBase;
+		else if (token.type == TOKEN_IDENTIFIER && interner)
+			token.symbol = Interner_Intern((Interner*)interner, Token_GetLexeme(&token, chunk->source));
+
+		tokens->data[tokenBase + i] = token;
+	}
+
+	if (!Token_DataList_Resize(tokenData, dataBase + chunk->tokenData->size))
+		abort();
+	memcpy(tokenData->data + dataBase, chunk->tokenData->data, chunk->tokenData->size * sizeof(Token_Data));
+
+	for (size_t i = 0; i < chunk->errors->size; i++)
+		CompilerErrorList_AppendFromPtr(errorList, &chunk->errors->data[i]);
+}
+
+nullable_end
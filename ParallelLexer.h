@@ -0,0 +1,17 @@
+#pragma once
+
+#include "CompilerError.h"
+#include "SourceFile.h"
+#include "Token.h"
+#include "Util/Interner.h"
+
+nullable_begin
+
+// Splits the source into chunks at line breaks and lexes them on up to threadCount threads.
+// Produces exactly the tokens (ending with EOF), payloads and errors of a sequential Lexer run
+// without whitespace and comments, appended to tokens, tokenData and errorList.
+// Identifiers are interned in source order while the chunks are stitched, so symbol IDs match as well.
+void ParallelLexer_Tokenize(const SourceFile* source, size_t threadCount, size_t minChunkSize,
+                            TokenList* tokens, Token_DataList* tokenData, Interner*nullable interner, CompilerErrorList* errorList);
+
+nullable_end
@@ -0,0 +1,239 @@
+#include "ParallelParser.h"
+
+#include <pthread.h>
+
+#include "Util/Managed.h"
+
+nullable_begin
+
+typedef struct
+{
+	const SourceFile* source;
+	TokenList* tokens;
+	const Token_DataList* tokenData;
+	const ParallelParser_Span* spans;
+	size_t spanCount;
+	// Typedef names visible before the first item
+	TypedefTable typedefNames;
+	Arena* arena;
+	CompilerErrorList* errors;
+	ParallelParser_ItemList items;
+} ParallelParser_Chunk;
+
+static void ParallelParser_ParseChunk(ParallelParser_Chunk* chunk);
+static void* ParallelParser_Worker(void* chunk);
+
+ParallelParser_Result* ParallelParser_Result_Init(ParallelParser_Result* self)
+{
+	ParallelParser_ItemList_Init(&self->items);
+	ArenaList_Init(&self->arenas);
+	return self;
+}
+
+void ParallelParser_Result_Fini(const ParallelParser_Result* self)
+{
+	ParallelParser_ItemList_Fini(&self->items);
+	for (size_t i = 0; i < self->arenas.size; i++)
+		Release(self->arenas.data[i]);
+	ArenaList_Fini(&self->arenas);
+}
+
+ParallelParser_Result* ParallelParser_Parse(const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData,
+                                            const size_t threadCount, const size_t minChunkTokens, CompilerErrorList* errorList)
+{
+	ParallelParser_Result* result = New(ParallelParser_Result);
+
+	ParallelParser_SpanList spans;
+	ParallelParser_SpanList_Init(&spans);
+	ParallelParser_Scan(tokens, &spans);
+
+	size_t chunkCount = minChunkTokens != 0 ? tokens->size / minChunkTokens : threadCount;
+	if (chunkCount > threadCount)
+		chunkCount = threadCount;
+	if (chunkCount > spans.size)
+		chunkCount = spans.size;
+	if (chunkCount == 0)
+		chunkCount = 1;
+
+	ParallelParser_Chunk* chunks = (ParallelParser_Chunk*)calloc(chunkCount, sizeof(ParallelParser_Chunk));
+	pthread_t* threads = (pthread_t*)calloc(chunkCount, sizeof(pthread_t));
+	if (chunks == NULL || threads == NULL)
+		abort();
+
+	// Typedef names are resolved in order before anything runs in parallel: only typedef declarations are parsed,
+	// and each chunk gets a copy of the names declared before it. Ordinary file scope declarations cannot hide
+	// a typedef name of the same scope, so they are skipped here.
+	using CompilerErrorList* resolverErrors = New(CompilerErrorList);
+	using Arena* resolverArena = New(Arena);
+	Parser resolver = Parser_Create(source, tokens, tokenData, resolverArena, resolverErrors);
+
+	size_t spanIndex = 0;
+	size_t count = 0;
+	for (size_t i = 0; i < chunkCount && spanIndex < spans.size; i++)
+	{
+		// Split evenly by token count, on item boundaries
+		const size_t first = spanIndex;
+		const size_t targetEnd = i + 1 == chunkCount ? tokens->size : tokens->size / chunkCount * (i + 1);
+		while (spanIndex < spans.size && (spanIndex == first || spans.data[spanIndex].end <= targetEnd))
+			spanIndex++;
+		if (i + 1 == chunkCount)
+			spanIndex = spans.size;
+
+		ParallelParser_Chunk* chunk = &chunks[count++];
+		*chunk = (ParallelParser_Chunk) {
+			.source = source,
+			.tokens = tokens,
+			.tokenData = tokenData,
+			.spans = spans.data + first,
+			.spanCount = spanIndex - first,
+			.arena = New(Arena),
+			.errors = New(CompilerErrorList),
+		};
+		TypedefTable_Init(&chunk->typedefNames);
+		TypedefTable_CopyFileScope(&chunk->typedefNames, &resolver.typedefNames);
+		ParallelParser_ItemList_Init(&chunk->items);
+
+		for (size_t j = first; j < spanIndex; j++)
+		{
+			if (!spans.data[j].isTypedef)
+				continue;
+
+			resolver.currentTokenIndex = spans.data[j].begin;
+			Release(Parser_TryParseDeclaration(&resolver));
+		}
+	}
+	Parser_Fini(&resolver);
+
+	// The calling thread parses the first chunk itself
+	for (size_t i = 1; i < count; i++)
+	{
+		if (pthread_create(&threads[i], NULL, ParallelParser_Worker, &chunks[i]) != 0)
+			abort();
+	}
+
+	if (count != 0)
+		ParallelParser_ParseChunk(&chunks[0]);
+
+	for (size_t i = 1; i < count; i++)
+		pthread_join(threads[i], NULL);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const ParallelParser_Chunk* chunk = &chunks[i];
+		for (size_t j = 0; j < chunk->items.size; j++)
+			ParallelParser_ItemList_AppendFromPtr(&result->items, &chunk->items.data[j]);
+		for (size_t j = 0; j < chunk->errors->size; j++)
+			CompilerErrorList_AppendFromPtr(errorList, &chunk->errors->data[j]);
+		ArenaList_Append(&result->arenas, chunk->arena);
+
+		ParallelParser_ItemList_Fini(&chunk->items);
+		TypedefTable_Fini(&chunk->typedefNames);
+		Release(chunk->errors);
+	}
+
+	ParallelParser_SpanList_Fini(&spans);
+	free(chunks);
+	free(threads);
+	return result;
+}
+
+void ParallelParser_Scan(const TokenList* tokens, ParallelParser_SpanList* spans)
+{
+	size_t depth = 0;
+	size_t begin = 0;
+	bool isTypedef = false;
+	bool inFunctionBody = false;
+	// Last '(' opened outside of any brackets
+	size_t parenOpen = SIZE_MAX;
+
+	for (size_t i = 0; i < tokens->size; i++)
+	{
+		bool isEnd = false;
+		switch ((Token_Type)tokens->data[i].type)
+		{
+			case TOKEN_PUNCTUATOR_PARENOPEN:
+				if (depth == 0)
+					parenOpen = i;
+				depth++;
+				break;
+			case TOKEN_PUNCTUATOR_BRACKETOPEN:
+				depth++;
+				break;
+			case TOKEN_PUNCTUATOR_BRACEOPEN:
+				// A parameter list follows the declarator name; anything else before '(' makes this a compound literal
+				if (depth == 0 && i > begin && tokens->data[i - 1].type == TOKEN_PUNCTUATOR_PARENCLOSE &&
+				    parenOpen != SIZE_MAX && parenOpen > begin &&
+				    (tokens->data[parenOpen - 1].type == TOKEN_IDENTIFIER || tokens->data[parenOpen - 1].type == TOKEN_PUNCTUATOR_PARENCLOSE))
+					inFunctionBody = true;
+				depth++;
+				break;
+			case TOKEN_PUNCTUATOR_PARENCLOSE:
+			case TOKEN_PUNCTUATOR_BRACKETCLOSE:
+				// Unbalanced closing brackets are left for the parser to report
+				if (depth != 0)
+					depth--;
+				break;
+			case TOKEN_PUNCTUATOR_BRACECLOSE:
+				if (depth != 0)
+					depth--;
+				isEnd = depth == 0 && inFunctionBody;
+				break;
+			case TOKEN_PUNCTUATOR_SEMICOLON:
+				isEnd = depth == 0;
+				break;
+			case TOKEN_KEYWORD_TYPEDEF:
+				isTypedef |= depth == 0;
+				break;
+			case TOKEN_EOF:
+				// Whatever is left is an unterminated item
+				if (i > begin)
+				{
+					const ParallelParser_Span span = { begin, i, isTypedef, false };
+					ParallelParser_SpanList_AppendFromPtr(spans, &span);
+				}
+				return;
+			default:
+				break;
+		}
+
+		if (isEnd)
+		{
+			const ParallelParser_Span span = { begin, i + 1, isTypedef, true };
+			ParallelParser_SpanList_AppendFromPtr(spans, &span);
+			begin = i + 1;
+			isTypedef = false;
+			inFunctionBody = false;
+			parenOpen = SIZE_MAX;
+		}
+	}
+}
+
+void ParallelParser_ParseChunk(ParallelParser_Chunk* chunk)
+{
+	Parser parser = Parser_Create(chunk->source, chunk->tokens, chunk->tokenData, chunk->arena, chunk->errors);
+	TypedefTable_CopyFileScope(&parser.typedefNames, &chunk->typedefNames);
+
+	for (size_t i = 0; i < chunk->spanCount; i++)
+	{
+		// Each item is parsed from its first token, so an error cannot spill over into the next one
+		parser.currentTokenIndex = chunk->spans[i].begin;
+
+		const size_t errorCount = chunk->errors->size;
+		ParallelParser_Item item = { .declaration = Parser_TryParseDeclaration(&parser) };
+		if (!item.declaration && chunk->errors->size == errorCount)
+			item.statement = Parser_ParseStatement(&parser);
+
+		if (item.declaration || item.statement)
+			ParallelParser_ItemList_AppendFromPtr(&chunk->items, &item);
+	}
+
+	Parser_Fini(&parser);
+}
+
+void* ParallelParser_Worker(void* chunk)
+{
+	ParallelParser_ParseChunk((ParallelParser_Chunk*)chunk);
+	return NULL;
+}
+
+nullable_end
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "CompilerError.h"
+#include "Parser.h"
+#include "Token.h"
+#include "Util/Arena.h"
+
+nullable_begin
+
+// A top-level declaration, or a top-level expression statement (function definitions are not parsed yet)
+typedef struct
+{
+	AstDeclaration*nullable declaration;
+	AstStatement*nullable statement;
+} ParallelParser_Item;
+
+// Tokens [begin, end) of one top-level item
+typedef struct
+{
+	size_t begin;
+	size_t end;
+	bool isTypedef;
+	// Ended by its ';' or '}', rather than by the end of the tokens
+	bool isTerminated;
+} ParallelParser_Span;
+
+nullable_end
+
+#define LIST_TYPE ParallelParser_ItemList
+#define LIST_ELEMENT_TYPE ParallelParser_Item
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE ParallelParser_SpanList
+#define LIST_ELEMENT_TYPE ParallelParser_Span
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+#define LIST_TYPE ArenaList
+#define LIST_ELEMENT_TYPE Arena*
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+nullable_begin
+
+typedef struct
+{
+	// Successfully parsed items, in source order
+	ParallelParser_ItemList items;
+	// The items' nodes live in these, one per chunk
+	ArenaList arenas;
+} ParallelParser_Result;
+
+ParallelParser_Result* ParallelParser_Result_Init(ParallelParser_Result* self);
+void ParallelParser_Result_Fini(const ParallelParser_Result* self);
+
+// Splits the tokens into top-level items by matching brackets: an item ends with a ';' outside of any brackets,
+// or with the '}' closing a function body, which is a '{' after a parameter list
+void ParallelParser_Scan(const TokenList* tokens, ParallelParser_SpanList* spans);
+
+// Parses the top-level items of a fully lexed token list on up to threadCount threads.
+// A bracket-matching pre-scan splits the tokens at top-level ';' and function body '}' tokens, typedef declarations
+// are then resolved in order so that each chunk starts with the typedef names visible at its first item, and the
+// chunks are parsed in parallel, each with its own arena and error list. Items and errors are merged in source order
+// and match those of parsing every item sequentially. Chunks have at least minChunkTokens tokens where possible.
+ParallelParser_Result* ParallelParser_Parse(const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData,
+                                            size_t threadCount, size_t minChunkTokens, CompilerErrorList* errorList);
+
+nullable_end
@@ -14,30 +14,145 @@
 
 nullable_begin
 
-static Token* Parser_PeekToken(const Parser* self);
-static Token* Parser_ConsumeToken(Parser* self);
-static bool Parser_MatchToken(Parser* self, Token_Type type, SourceLocation*nullable outLocation);
+// Binding strength of binary operators, from loosest to tightest
+typedef enum
+{
+	PARSER_PRECEDENCE_NONE, // Not a binary operator
+	PARSER_PRECEDENCE_ASSIGNMENT,
+	PARSER_PRECEDENCE_CONDITIONAL,
+	PARSER_PRECEDENCE_LOGICAL_OR,
+	PARSER_PRECEDENCE_LOGICAL_AND,
+	PARSER_PRECEDENCE_BITWISE_OR,
+	PARSER_PRECEDENCE_BITWISE_XOR,
+	PARSER_PRECEDENCE_BITWISE_AND,
+	PARSER_PRECEDENCE_EQUALITY,
+	PARSER_PRECEDENCE_RELATIONAL,
+	PARSER_PRECEDENCE_SHIFT,
+	PARSER_PRECEDENCE_ADDITIVE,
+	PARSER_PRECEDENCE_MULTIPLICATIVE,
+} Parser_Precedence;
+
+typedef struct
+{
+	AstBinaryOperation operation;
+	Parser_Precedence precedence;
+} Parser_BinaryOperator;
+
+// The conditional operator '?' is listed without an operation, it is parsed as a ternary expression
+static const Parser_BinaryOperator binaryOperators[TOKEN_MAX] = {
+	[TOKEN_PUNCTUATOR_EQUAL] = { AST_BINOP_ASSIGN, PARSER_PRECEDENCE_ASSIGNMENT },
+	[TOKEN_PUNCTUATOR_ASTERISK_EQUAL] = { AST_BINOP_ASSIGN_MULTIPLY, PARSER_PRECEDENCE_ASSIGNMENT },
+	[TOKEN_PUNCTUATOR_SLASH_EQUAL] = { AST_BINOP_ASSIGN_DIVIDE, PARSER_PRECEDENCE_ASSIGNMENT },
+	[TOKEN_PUNCTUATOR_PERCENT_EQUAL] = { AST_BINOP_ASSIGN_MODULO, PARSER_PRECEDENCE_ASSIGNMENT },
+	[TOKEN_PUNCTUATOR_PLUS_EQUAL] = { AST_BINOP_ASSIGN_ADD, PARSER_PRECEDENCE_ASSIGNMENT },
+	[TOKEN_PUNCTUATOR_MINUS_EQUAL] = { AST_BINOP_ASSIGN_SUBTRACT, PARSER_PRECEDENCE_ASSIGNMENT },
+	[TOKEN_PUNCTUATOR_LESS_LESS_EQUAL] = { AST_BINOP_ASSIGN_LEFT_SHIFT, PARSER_PRECEDENCE_ASSIGNMENT },
+	[TOKEN_PUNCTUATOR_GREATER_GREATER_EQUAL] = { AST_BINOP_ASSIGN_RIGHT_SHIFT, PARSER_PRECEDENCE_ASSIGNMENT },
+	[TOKEN_PUNCTUATOR_AMPERSAND_EQUAL] = { AST_BINOP_ASSIGN_AND, PARSER_PRECEDENCE_ASSIGNMENT },
+	[TOKEN_PUNCTUATOR_CARET_EQUAL] = { AST_BINOP_ASSIGN_XOR, PARSER_PRECEDENCE_ASSIGNMENT },
+	[TOKEN_PUNCTUATOR_PIPE_EQUAL] = { AST_BINOP_ASSIGN_OR, PARSER_PRECEDENCE_ASSIGNMENT },
+	[TOKEN_PUNCTUATOR_QUESTION] = { AST_BINOP_NONE, PARSER_PRECEDENCE_CONDITIONAL },
+	[TOKEN_PUNCTUATOR_PIPE_PIPE] = { AST_BINOP_LOGICAL_OR, PARSER_PRECEDENCE_LOGICAL_OR },
+	[TOKEN_PUNCTUATOR_AMPERSAND_AMPERSAND] = { AST_BINOP_LOGICAL_AND, PARSER_PRECEDENCE_LOGICAL_AND },
+	[TOKEN_PUNCTUATOR_PIPE] = { AST_BINOP_BITWISE_OR, PARSER_PRECEDENCE_BITWISE_OR },
+	[TOKEN_PUNCTUATOR_CARET] = { AST_BINOP_BITWISE_XOR, PARSER_PRECEDENCE_BITWISE_XOR },
+	[TOKEN_PUNCTUATOR_AMPERSAND] = { AST_BINOP_BITWISE_AND, PARSER_PRECEDENCE_BITWISE_AND },
+	[TOKEN_PUNCTUATOR_EQUAL_EQUAL] = { AST_BINOP_TEST_EQUAL, PARSER_PRECEDENCE_EQUALITY },
+	[TOKEN_PUNCTUATOR_EXCLAMATION_EQUAL] = { AST_BINOP_TEST_NOT_EQUAL, PARSER_PRECEDENCE_EQUALITY },
+	[TOKEN_PUNCTUATOR_LESS] = { AST_BINOP_TEST_LESS, PARSER_PRECEDENCE_RELATIONAL },
+	[TOKEN_PUNCTUATOR_GREATER] = { AST_BINOP_TEST_GREATER, PARSER_PRECEDENCE_RELATIONAL },
+	[TOKEN_PUNCTUATOR_LESS_EQUAL] = { AST_BINOP_TEST_LESS_EQUAL, PARSER_PRECEDENCE_RELATIONAL },
+	[TOKEN_PUNCTUATOR_GREATER_EQUAL] = { AST_BINOP_TEST_GREATER_EQUAL, PARSER_PRECEDENCE_RELATIONAL },
+	[TOKEN_PUNCTUATOR_LESS_LESS] = { AST_BINOP_SHIFT_LEFT, PARSER_PRECEDENCE_SHIFT },
+	[TOKEN_PUNCTUATOR_GREATER_GREATER] = { AST_BINOP_SHIFT_RIGHT, PARSER_PRECEDENCE_SHIFT },
+	[TOKEN_PUNCTUATOR_PLUS] = { AST_BINOP_ADD, PARSER_PRECEDENCE_ADDITIVE },
+	[TOKEN_PUNCTUATOR_MINUS] = { AST_BINOP_SUBTRACT, PARSER_PRECEDENCE_ADDITIVE },
+	[TOKEN_PUNCTUATOR_ASTERISK] = { AST_BINOP_MULTIPLY, PARSER_PRECEDENCE_MULTIPLICATIVE },
+	[TOKEN_PUNCTUATOR_SLASH] = { AST_BINOP_DIVIDE, PARSER_PRECEDENCE_MULTIPLICATIVE },
+	[TOKEN_PUNCTUATOR_PERCENT] = { AST_BINOP_MODULO, PARSER_PRECEDENCE_MULTIPLICATIVE },
+};
+
+// What the expression parser is about to parse
+typedef enum
+{
+	PARSER_GOAL_EXPRESSION, // Comma-separated assignment expressions
+	PARSER_GOAL_BINARY, // Binary and conditional operators binding at least as tight as minPrecedence
+	PARSER_GOAL_CAST,
+	PARSER_GOAL_UNARY,
+	PARSER_GOAL_POSTFIX,
+} Parser_GoalType;
+
+typedef struct
+{
+	Parser_GoalType type;
+	Parser_Precedence minPrecedence;
+} Parser_Goal;
+
+// What an expression frame waits for; the parser resumes it with that operand, or NULL if it failed to parse
+typedef enum
+{
+	PARSER_FRAME_COMMA, // The next operand of a comma expression
+	PARSER_FRAME_BINARY, // The next operand of op, or the branches of '?:'
+	PARSER_FRAME_CAST, // The operand of a cast to typeName
+	PARSER_FRAME_UNARY, // The operand of a prefix operator or sizeof
+	PARSER_FRAME_PARENTHESIZED, // The expression inside parentheses
+	PARSER_FRAME_POSTFIX, // A primary expression to apply postfix operators to
+	PARSER_FRAME_SUBSCRIPT, // The subscript of expression
+	PARSER_FRAME_ARGUMENT, // The next argument of a call to expression
+} Parser_FrameType;
+
+// Operator of the expression parser's explicit stack that is waiting for an operand
+struct Parser_ExpressionFrame
+{
+	Parser_FrameType type;
+	// BINARY: precedences that can continue the expression, and the operator waiting for its right operand
+	Parser_Precedence minPrecedence;
+	Parser_Precedence maxPrecedence;
+	Parser_BinaryOperator op;
+	// The expression parsed so far: the left operand, or the operand of postfix operators
+	AstExpression*nullable expression;
+	union
+	{
+		AstExpression*nullable ifTrue; // BINARY: middle operand of '?:'
+		AstTypeName* typeName; // CAST
+		AstExpressionList* arguments; // ARGUMENT
+		AstUnaryOperation operation; // UNARY
+	};
+	// CAST, UNARY: location of the first token; ARGUMENT: location of the parenthesis opening the call
+	SourceLocation location;
+};
+
+nullable_end
+
+#define LIST_TYPE Parser_ExpressionFrameList
+#define LIST_ELEMENT_TYPE Parser_ExpressionFrame
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+nullable_begin
 
-static AstExpression*nullable Parser_ParsePrimaryExpression(Parser* self);
-static AstExpression*nullable Parser_ParsePostfixExpression(Parser* self);
-static AstExpression*nullable Parser_ParseUnaryExpression(Parser* self);
-static AstExpression*nullable Parser_ParseCastExpression(Parser* self);
-static AstExpression*nullable Parser_ParseMultiplicativeExpression(Parser* self);
-static AstExpression*nullable Parser_ParseAdditiveExpression(Parser* self);
-static AstExpression*nullable Parser_ParseShiftExpression(Parser* self);
-static AstExpression*nullable Parser_ParseRelationalExpression(Parser* self);
-static AstExpression*nullable Parser_ParseEqualityExpression(Parser* self);
-static AstExpression*nullable Parser_ParseBitwiseAndExpression(Parser* self);
-static AstExpression*nullable Parser_ParseBitwiseXorExpression(Parser* self);
-static AstExpression*nullable Parser_ParseBitwiseOrExpression(Parser* self);
-static AstExpression*nullable Parser_ParseLogicalAndExpression(Parser* self);
-static AstExpression*nullable Parser_ParseLogicalOrExpression(Parser* self);
-static AstExpression*nullable Parser_ParseConditionalExpression(Parser* self);
-static AstExpression*nullable Parser_ParseAssignmentExpression(Parser* self);
-static AstDeclaration*nullable Parser_TryParseDeclaration(Parser* self);
+static Token Parser_PeekToken(Parser* self);
+static Token Parser_PeekTokenAhead(Parser* self, size_t offset);
+static Token Parser_ConsumeToken(Parser* self);
+static bool Parser_MatchToken(Parser* self, Token_Type type, SourceLocation*nullable outLocation);
+static SourceLocation Parser_GetTokenLocation(const Parser* self, const Token* token);
+static const Token_Data* Parser_GetTokenData(const Parser* self, const Token* token);
+static void* Parser_Adopt(Parser* self, void* object);
+static bool Parser_IsTypeNameStart(const Parser* self, const Token* token);
+static bool Parser_IsDeclarationStart(const Parser* self, const Token* token);
+static void Parser_DeclareName(Parser* self, const AstDeclarator* declarator, bool isTypedefName);
+
+static Parser_ExpressionFrame* Parser_PushFrame(Parser* self, Parser_FrameType type);
+static void Parser_AbandonFrame(Parser* self);
+static AstExpression*nullable Parser_ParseExpressionFrom(Parser* self, Parser_Goal goal);
+static AstExpression*nullable Parser_DescendExpression(Parser* self, Parser_Goal goal);
+static bool Parser_ResumeExpression(Parser* self, AstExpression*nullable* value, Parser_Goal* outGoal);
+static bool Parser_ResumeBinaryExpression(Parser* self, Parser_ExpressionFrame* frame, AstExpression*nullable* value, Parser_Goal* outGoal);
+static bool Parser_ResumePostfixExpression(Parser* self, Parser_ExpressionFrame* frame, AstExpression*nullable* value, Parser_Goal* outGoal);
 static AstDeclarationSpecifiers*nullable Parser_ParseDeclarationSpecifiers(Parser* self);
 static AstStorageClassSpecifier*nullable Parser_TryParseStorageClassSpecifier(Parser* self);
-static AstTypeSpecifier*nullable Parser_TryParseTypeSpecifier(Parser* self);
+static AstTypeSpecifier*nullable Parser_TryParseTypeSpecifier(Parser* self, bool allowTypedefName);
 static AstTypeSpecifierQualifierList*nullable Parser_TryParseSpecifierQualifierList(Parser* self);
 static AstTypeQualifiers Parser_TryParseTypeQualifier(Parser* self, SourceLocation*nullable outLocation);
 static AstFunctionSpecifiers Parser_TryParseFunctionSpecifier(Parser* self, SourceLocation*nullable outLocation);
@@ -46,739 +161,721 @@ static AstDirectDeclarator*nullable Parser_TryParseDirectDeclarator(Parser* self
 static AstPointer*nullable Parser_TryParsePointer(Parser* self);
 static AstTypeQualifiers Parser_TryParseTypeQualifierList(Parser* self, SourceLocation*nullable outLocation);
 static AstTypeName*nullable Parser_TryParseTypeName(Parser* self);
-static AstStatement*nullable Parser_ParseStatement(Parser* self);
 
-Token* Parser_PeekToken(const Parser* self)
+Token Parser_PeekToken(Parser* self)
 {
-	if (self->currentTokenIndex >= self->tokens->size)
-		return &self->tokens->data[self->tokens->size - 1]; // Return EOF token
-
-	return &self->tokens->data[self->currentTokenIndex];
+	return Parser_PeekTokenAhead(self, 0);
 }
 
-Token* Parser_ConsumeToken(Parser* self)
+Token Parser_PeekTokenAhead(Parser* self, const size_t offset)
 {
-	if (self->currentTokenIndex >= self->tokens->size)
-		return &self->tokens->data[self->tokens->size - 1]; // Return EOF token
+	const size_t index = self->currentTokenIndex + offset;
+
+	// The parser never backtracks, so a stream only has to keep the tokens from the current one on
+	if (self->stream)
+		return TokenStream_Get((TokenStream*)self->stream, index, self->currentTokenIndex);
 
-	return &self->tokens->data[self->currentTokenIndex++];
+	const TokenList* tokens = (TokenList*)self->tokens;
+	if (index >= tokens->size)
+		return tokens->data[tokens->size - 1]; // Return EOF token
+
+	return tokens->data[index];
 }
 
-bool Parser_MatchToken(Parser* self, const Token_Type type, SourceLocation*nullable outLocation)
+Token Parser_ConsumeToken(Parser* self)
 {
-	const Token* token = Parser_PeekToken(self);
-	if (token->type != type)
-		return false;
+	const Token token = Parser_PeekToken(self);
+	self->currentTokenIndex++;
+	return token;
+}
 
-	Parser_ConsumeToken(self);
-	if (outLocation != NULL)
-		*outLocation = token->location;
-	return true;
+SourceLocation Parser_GetTokenLocation(const Parser* self, const Token* token)
+{
+	return Token_GetLocation(token, self->source);
 }
 
-AstExpression* Parser_ParsePrimaryExpression(Parser* self)
+const Token_Data* Parser_GetTokenData(const Parser* self, const Token* token)
 {
-	const Token* token = Parser_PeekToken(self);
-	if (token->type == TOKEN_PUNCTUATOR_PARENOPEN)
-	{
-		// (<expression>)
-		Parser_ConsumeToken(self);
+	if (self->stream)
+		return TokenStream_GetData((TokenStream*)self->stream, token);
 
-		AstExpression* expr = Parser_ParseExpression(self);
-		if (!expr)
-			return NULL;
+	return Token_GetData(token, (Token_DataList*)self->tokenData);
+}
 
-		if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENCLOSE, NULL))
-		{
-			CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedClosingParenthesisInParenthesizedExpression, expr->location));
-			return NULL;
-		}
+// Nodes in the arena are never finalized, so heap objects they own are released along with the arena instead
+void* Parser_Adopt(Parser* self, void* object)
+{
+	if (self->arena)
+		Arena_AddCleanup((Arena*)self->arena, ReleaseImpl, object);
+	return object;
+}
 
-		return expr;
+// Whether token starts a specifier-qualifier-list, and with it a type-name rather than an expression
+bool Parser_IsTypeNameStart(const Parser* self, const Token* token)
+{
+	switch (token->type)
+	{
+		case TOKEN_KEYWORD_VOID:
+		case TOKEN_KEYWORD_CHAR:
+		case TOKEN_KEYWORD_SHORT:
+		case TOKEN_KEYWORD_INT:
+		case TOKEN_KEYWORD_LONG:
+		case TOKEN_KEYWORD_FLOAT:
+		case TOKEN_KEYWORD_DOUBLE:
+		case TOKEN_KEYWORD_SIGNED:
+		case TOKEN_KEYWORD_UNSIGNED:
+		case TOKEN_KEYWORD_STRUCT:
+		case TOKEN_KEYWORD_UNION:
+		case TOKEN_KEYWORD_ENUM:
+		case TOKEN_KEYWORD_CONST:
+		case TOKEN_KEYWORD_VOLATILE:
+		case TOKEN_KEYWORD_RESTRICT:
+			return true;
+		case TOKEN_IDENTIFIER:
+			return TypedefTable_IsTypedefName(&self->typedefNames, token->symbol);
+		default:
+			return false;
 	}
+}
 
-	if (token->type == TOKEN_LITERAL_INTEGER || // integer-constant
-	    token->type == TOKEN_LITERAL_FLOAT || // floating-constant
-	    token->type == TOKEN_LITERAL_CHAR || // character-constant
-	    token->type == TOKEN_LITERAL_STRING || // string-literal
-	    token->type == TOKEN_IDENTIFIER) // identifier or constant (enumeration-constant)
+bool Parser_IsDeclarationStart(const Parser* self, const Token* token)
+{
+	switch (token->type)
 	{
-		Parser_ConsumeToken(self);
-
-		return NewWith(AstExpression, Primary, *token, token->location);
+		case TOKEN_KEYWORD_AUTO:
+		case TOKEN_KEYWORD_EXTERN:
+		case TOKEN_KEYWORD_REGISTER:
+		case TOKEN_KEYWORD_STATIC:
+		case TOKEN_KEYWORD_TYPEDEF:
+		case TOKEN_KEYWORD_INLINE:
+			return true;
+		default:
+			return Parser_IsTypeNameStart(self, token);
 	}
+}
 
-	// TODO: generic-selection
+// Records the name introduced by declarator, so later uses of it are known to be (or not be) type names
+void Parser_DeclareName(Parser* self, const AstDeclarator* declarator, const bool isTypedefName)
+{
+	const AstDirectDeclarator* directDeclarator = declarator->directDeclarator;
+	while (directDeclarator->type == AST_DIRECTDECLARATOR_PARENTHESIZED)
+		directDeclarator = directDeclarator->parenthesized->directDeclarator;
 
-	return NULL;
+	if (directDeclarator->type == AST_DIRECTDECLARATOR_IDENTIFIER)
+		TypedefTable_Declare(&self->typedefNames, directDeclarator->symbol, isTypedefName);
 }
 
-AstExpression* Parser_ParsePostfixExpression(Parser* self)
+bool Parser_MatchToken(Parser* self, const Token_Type type, SourceLocation*nullable outLocation)
 {
-	const size_t savedTokenIndex = self->currentTokenIndex;
+	const Token token = Parser_PeekToken(self);
+	if (token.type != type)
+		return false;
 
-	AstExpression* expression = NULL;
-	if (true)
-	{
-		if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENOPEN, NULL))
-			goto primary;
+	Parser_ConsumeToken(self);
+	if (outLocation != NULL)
+		*outLocation = Parser_GetTokenLocation(self, &token);
+	return true;
+}
 
-		using AstTypeName* type = Parser_TryParseTypeName(self);
-		if (!type)
-			goto primary;
+Parser_ExpressionFrame* Parser_PushFrame(Parser* self, const Parser_FrameType type)
+{
+	Parser_ExpressionFrameList* frames = self->expressionFrames;
+	if (frames->size == frames->capacity && !Parser_ExpressionFrameList_Reserve(frames, frames->capacity * 2))
+		abort();
 
-		if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENCLOSE, NULL))
-			goto primary;
+	Parser_ExpressionFrame* frame = &frames->data[frames->size++];
+	if (frames->size > self->maxExpressionFrameCount)
+		self->maxExpressionFrameCount = frames->size;
 
-		if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_BRACEOPEN, NULL))
-			goto primary;
+	frame->type = type;
+	frame->expression = NULL;
+	frame->ifTrue = NULL;
+	return frame;
+}
 
-		// TODO: initializer list
-		Retain(type);
-		abort();
-	}
-	else
+// Pops the innermost frame after a failed operand, releasing the expressions it holds
+void Parser_AbandonFrame(Parser* self)
+{
+	Parser_ExpressionFrameList* frames = self->expressionFrames;
+	const Parser_ExpressionFrame* frame = &frames->data[--frames->size];
+	Release(frame->expression);
+	if (frame->type == PARSER_FRAME_ARGUMENT)
 	{
-	primary:
-		self->currentTokenIndex = savedTokenIndex;
-		expression = Parser_ParsePrimaryExpression(self);
+		for (size_t i = 0; i < frame->arguments->size; i++)
+			Release(frame->arguments->data[i]);
+		Release(frame->arguments);
 	}
+}
 
-	if (!expression)
-		return NULL;
-
+AstExpression* Parser_DescendExpression(Parser* self, Parser_Goal goal)
+{
+	// Goals go from the loosest to the tightest binding; one that pushes no operator falls through to the next
 	while (true)
 	{
-		const Token* token = Parser_PeekToken(self);
-		if (token->type == TOKEN_PUNCTUATOR_BRACKETOPEN)
+		if (goal.type == PARSER_GOAL_EXPRESSION)
 		{
-			// Subscript expression
-			Parser_ConsumeToken(self);
-			AstExpression* indexExpr = Parser_ParseExpression(self);
-			if (!indexExpr)
-				return NULL;
-
-			if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_BRACKETCLOSE, NULL))
-			{
-				CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedClosingBracketInSubscriptExpression, indexExpr->location));
-				return NULL;
-			}
-
-			expression = NewWith(AstExpression, Binary,
-			                     AST_BINOP_SUBSCRIPT, expression, indexExpr,
-			                     SourceLocation_Concat(&expression->location, &indexExpr->location));
-			continue;
+			Parser_PushFrame(self, PARSER_FRAME_COMMA);
+			goal = (Parser_Goal) { PARSER_GOAL_BINARY, PARSER_PRECEDENCE_ASSIGNMENT };
 		}
 
-		if (token->type == TOKEN_PUNCTUATOR_PERIOD || token->type == TOKEN_PUNCTUATOR_MINUS_GREATER)
+		if (goal.type == PARSER_GOAL_BINARY)
 		{
-			// Member access
-			Parser_ConsumeToken(self);
-
-			const Token* indentifier = Parser_PeekToken(self);
+			Parser_ExpressionFrame* frame = Parser_PushFrame(self, PARSER_FRAME_BINARY);
+			frame->minPrecedence = goal.minPrecedence;
+			frame->maxPrecedence = PARSER_PRECEDENCE_MULTIPLICATIVE;
+			goal.type = PARSER_GOAL_CAST;
+		}
 
-			if (indentifier == NULL || indentifier->type != TOKEN_IDENTIFIER)
+		const Token token = Parser_PeekToken(self);
+		if (goal.type == PARSER_GOAL_CAST)
+		{
+			// One token after the parenthesis tells a cast from a parenthesized expression
+			const Token nextToken = Parser_PeekTokenAhead(self, 1);
+			if (token.type == TOKEN_PUNCTUATOR_PARENOPEN && Parser_IsTypeNameStart(self, &nextToken))
 			{
-				CompilerErrorList_Append(
-					self->errors, CompilerError_Create("expected identifier after '.' or '->' in member access expression", token->location));
-				return NULL;
-			}
+				Parser_ConsumeToken(self);
 
-			Parser_ConsumeToken(self);
-
-			expression = NewWith(AstExpression, MemberAccess,
-			                     expression, indentifier->data.literalIdentifier.value, token->type == TOKEN_PUNCTUATOR_MINUS_GREATER,
-			                     SourceLocation_Concat(&expression->location, &indentifier->location));
-			continue;
-		}
+				AstTypeName* type = Parser_TryParseTypeName(self);
+				assert(type && "type name start was checked");
 
-		if (token->type == TOKEN_PUNCTUATOR_PLUS_PLUS || token->type == TOKEN_PUNCTUATOR_MINUS_MINUS)
-		{
-			// Postfix increment/decrement
-			Parser_ConsumeToken(self);
+				if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENCLOSE, NULL))
+				{
+					CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedClosingParenthesisInCastExpression, type->location));
+					Release(type);
+					return NULL;
+				}
 
-			const AstUnaryOperation op = (token->type == TOKEN_PUNCTUATOR_PLUS_PLUS) ? AST_UNOP_POST_INCREMENT : AST_UNOP_POST_DECREMENT;
+				Parser_ExpressionFrame* frame = Parser_PushFrame(self, PARSER_FRAME_CAST);
+				frame->typeName = type;
+				frame->location = Parser_GetTokenLocation(self, &token);
+				continue;
+			}
 
-			expression = NewWith(AstExpression, Unary,
-			                     op, expression,
-			                     SourceLocation_Concat(&expression->location, &token->location));
-			continue;
+			goal.type = PARSER_GOAL_UNARY;
 		}
 
-		if (token->type == TOKEN_PUNCTUATOR_PARENOPEN)
+		if (goal.type == PARSER_GOAL_UNARY)
 		{
-			// Function call
-			Parser_ConsumeToken(self);
-
-			using AstExpressionList* args = New(AstExpressionList);
-			while (true)
+			// "sizeof(<type>)" or "sizeof <expression>"
+			if (token.type == TOKEN_KEYWORD_SIZEOF)
 			{
-				if (Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENCLOSE, NULL))
-					break;
+				Parser_ConsumeToken(self);
+				const SourceLocation tokenLocation = Parser_GetTokenLocation(self, &token);
 
-				AstExpression* argExpr = Parser_ParseAssignmentExpression(self);
-				if (!argExpr)
-					return NULL;
+				// sizeof(<type>)
+				const Token nextToken = Parser_PeekTokenAhead(self, 1);
+				if (Parser_PeekToken(self).type == TOKEN_PUNCTUATOR_PARENOPEN && Parser_IsTypeNameStart(self, &nextToken))
+				{
+					Parser_ConsumeToken(self);
 
-				AstExpressionList_Append(args, argExpr);
+					using AstTypeName* type = Parser_TryParseTypeName(self);
+					assert(type && "type name start was checked");
 
-				if (Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENCLOSE, NULL))
-					break;
+					if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENCLOSE, NULL))
+					{
+						CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedClosingParenthesisInSizeofTypeExpression, type->location));
+						return NULL;
+					}
 
-				if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_COMMA, NULL))
-				{
-					CompilerErrorList_Append(self->errors, CompilerError_Create("expected ',' or ')' in function call argument list", argExpr->location));
-					return NULL;
+					return NewWithIn(self->arena, AstExpression, SizeofType,
+					                 Retain(type),
+					                 SourceLocation_Concat(&tokenLocation, &type->location));
 				}
-			}
 
-			expression = NewWith(AstExpression, Call,
-			                     expression, Retain(args),
-			                     SourceLocation_Concat(&expression->location, &token->location));
-			continue;
-		}
-		break;
-	}
-
-	return expression;
-}
+				// sizeof <expression>
+				Parser_ExpressionFrame* frame = Parser_PushFrame(self, PARSER_FRAME_UNARY);
+				frame->operation = AST_UNOP_SIZEOF;
+				frame->location = tokenLocation;
+				continue;
+			}
 
-AstExpression* Parser_ParseUnaryExpression(Parser* self)
-{
-	const Token* token = Parser_PeekToken(self);
+			// Prefix expressions
+			AstUnaryOperation op;
+			switch (token.type)
+			{
+				case TOKEN_PUNCTUATOR_AMPERSAND:
+					op = AST_UNOP_ADDRESS_OF;
+					break;
+				case TOKEN_PUNCTUATOR_ASTERISK:
+					op = AST_UNOP_DEREFERENCE;
+					break;
+				case TOKEN_PUNCTUATOR_PLUS:
+					op = AST_UNOP_PLUS;
+					break;
+				case TOKEN_PUNCTUATOR_MINUS:
+					op = AST_UNOP_MINUS;
+					break;
+				case TOKEN_PUNCTUATOR_TILDE:
+					op = AST_UNOP_BITWISE_NOT;
+					break;
+				case TOKEN_PUNCTUATOR_EXCLAMATION:
+					op = AST_UNOP_LOGICAL_NOT;
+					break;
+				case TOKEN_PUNCTUATOR_PLUS_PLUS:
+					op = AST_UNOP_PRE_INCREMENT;
+					break;
+				case TOKEN_PUNCTUATOR_MINUS_MINUS:
+					op = AST_UNOP_PRE_DECREMENT;
+					break;
+				default:
+					op = AST_UNOP_NONE;
+			}
 
-	// "sizeof(<type>)" or "sizeof <expression>"
-	if (token->type == TOKEN_KEYWORD_SIZEOF)
-	{
-		Parser_ConsumeToken(self);
+			if (op != AST_UNOP_NONE)
+			{
+				// Increment and decrement take a unary expression, the other operators a cast expression
+				Parser_ConsumeToken(self);
+				Parser_ExpressionFrame* frame = Parser_PushFrame(self, PARSER_FRAME_UNARY);
+				frame->operation = op;
+				frame->location = Parser_GetTokenLocation(self, &token);
+				if (op != AST_UNOP_PRE_INCREMENT && op != AST_UNOP_PRE_DECREMENT)
+					goal.type = PARSER_GOAL_CAST;
+				continue;
+			}
+		}
 
-		// sizeof(<type>)
-		if (Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENOPEN, NULL))
+		// "(<type>) {<initializer-list>}", a compound literal, if the parenthesis opens a type name
+		const Token nextToken = Parser_PeekTokenAhead(self, 1);
+		if (token.type == TOKEN_PUNCTUATOR_PARENOPEN && Parser_IsTypeNameStart(self, &nextToken))
 		{
+			Parser_ConsumeToken(self);
+
 			using AstTypeName* type = Parser_TryParseTypeName(self);
-			if (!type)
-				return NULL;
+			assert(type && "type name start was checked");
 
 			if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENCLOSE, NULL))
 			{
-				CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedClosingParenthesisInSizeofTypeExpression, type->location));
+				CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedClosingParenthesisInCompoundLiteral, type->location));
 				return NULL;
 			}
 
-			return NewWith(AstExpression, SizeofType,
-			               Retain(type),
-			               SourceLocation_Concat(&token->location, &type->location));
-		}
+			if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_BRACEOPEN, NULL))
+			{
+				CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedInitializerListInCompoundLiteral, type->location));
+				return NULL;
+			}
 
-		// sizeof <expression>
-		AstExpression* expr = Parser_ParseUnaryExpression(self);
-		if (!expr)
-			return NULL;
+			// TODO: initializer list
+			abort();
+		}
 
-		return NewWith(AstExpression, Unary,
-		               AST_UNOP_SIZEOF, expr,
-		               SourceLocation_Concat(&token->location, &expr->location));
-	}
+		if (token.type == TOKEN_PUNCTUATOR_PARENOPEN)
+		{
+			// (<expression>)
+			Parser_ConsumeToken(self);
+			Parser_PushFrame(self, PARSER_FRAME_PARENTHESIZED);
+			goal.type = PARSER_GOAL_EXPRESSION;
+			continue;
+		}
 
-	// Prefix expressions
-	AstUnaryOperation op;
-	switch (token->type)
-	{
-		case TOKEN_PUNCTUATOR_AMPERSAND:
-			op = AST_UNOP_ADDRESS_OF;
-			break;
-		case TOKEN_PUNCTUATOR_ASTERISK:
-			op = AST_UNOP_DEREFERENCE;
-			break;
-		case TOKEN_PUNCTUATOR_PLUS:
-			op = AST_UNOP_PLUS;
-			break;
-		case TOKEN_PUNCTUATOR_MINUS:
-			op = AST_UNOP_MINUS;
-			break;
-		case TOKEN_PUNCTUATOR_TILDE:
-			op = AST_UNOP_BITWISE_NOT;
-			break;
-		case TOKEN_PUNCTUATOR_EXCLAMATION:
-			op = AST_UNOP_LOGICAL_NOT;
-			break;
-		case TOKEN_PUNCTUATOR_PLUS_PLUS:
-			op = AST_UNOP_PRE_INCREMENT;
-			break;
-		case TOKEN_PUNCTUATOR_MINUS_MINUS:
-			op = AST_UNOP_PRE_DECREMENT;
-			break;
-		default:
-			op = AST_UNOP_NONE;
-	}
+		if (token.type == TOKEN_LITERAL_INTEGER || // integer-constant
+		    token.type == TOKEN_LITERAL_FLOAT || // floating-constant
+		    token.type == TOKEN_LITERAL_CHAR || // character-constant
+		    token.type == TOKEN_LITERAL_STRING || // string-literal
+		    token.type == TOKEN_IDENTIFIER) // identifier or constant (enumeration-constant)
+		{
+			Parser_ConsumeToken(self);
 
-	if (op == AST_UNOP_PRE_INCREMENT || op == AST_UNOP_PRE_DECREMENT)
-	{
-		Parser_ConsumeToken(self);
-		AstExpression* expr = Parser_ParseUnaryExpression(self);
-		if (!expr)
-			return NULL;
+			// Most operands have no postfix operators, and need no frame for them
+			switch (Parser_PeekToken(self).type)
+			{
+				case TOKEN_PUNCTUATOR_BRACKETOPEN:
+				case TOKEN_PUNCTUATOR_PERIOD:
+				case TOKEN_PUNCTUATOR_MINUS_GREATER:
+				case TOKEN_PUNCTUATOR_PLUS_PLUS:
+				case TOKEN_PUNCTUATOR_MINUS_MINUS:
+				case TOKEN_PUNCTUATOR_PARENOPEN:
+					Parser_PushFrame(self, PARSER_FRAME_POSTFIX);
+					break;
+				default:
+					break;
+			}
 
-		return NewWith(AstExpression, Unary,
-		               op, expr,
-		               SourceLocation_Concat(&token->location, &expr->location));
-	}
+			const Token_Data data = Token_HasData(&token) ? *Parser_GetTokenData(self, &token) : (Token_Data) { 0 };
+			return NewWithIn(self->arena, AstExpression, Primary, token, data, Parser_GetTokenLocation(self, &token));
+		}
 
-	if (op != AST_UNOP_NONE)
-	{
-		Parser_ConsumeToken(self);
-		AstExpression* expr = Parser_ParseCastExpression(self);
-		if (!expr)
-			return NULL;
+		// TODO: generic-selection
 
-		return NewWith(AstExpression, Unary,
-		               op, expr,
-		               SourceLocation_Concat(&token->location, &expr->location));
+		return NULL;
 	}
-
-	return Parser_ParsePostfixExpression(self);
 }
 
-AstExpression* Parser_ParseCastExpression(Parser* self)
+bool Parser_ResumeExpression(Parser* self, AstExpression*nullable* value, Parser_Goal* outGoal)
 {
-	const size_t savedTokenIndex = self->currentTokenIndex;
-
-	SourceLocation startLocation;
-	if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENOPEN, &startLocation))
-		return Parser_ParseUnaryExpression(self);
-
-	AstTypeName* type = Parser_TryParseTypeName(self);
-	if (!type)
-	{
-		// Not a cast expression, rewind and parse as unary expression
-		self->currentTokenIndex = savedTokenIndex;
-		return Parser_ParseUnaryExpression(self);
-	}
-
-	if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENCLOSE, NULL))
+	Parser_ExpressionFrameList* frames = self->expressionFrames;
+	Parser_ExpressionFrame* frame = &frames->data[frames->size - 1];
+	AstExpression*nullable operand = *value;
+	switch (frame->type)
 	{
-		CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedClosingParenthesisInCastExpression, type->location));
-		return NULL;
-	}
-
-	AstExpression* expr = Parser_ParseCastExpression(self);
-	if (!expr)
-		return NULL;
-	return NewWith(AstExpression, Cast, Retain(type), expr, SourceLocation_Concat(&startLocation, &expr->location));
-}
+		case PARSER_FRAME_COMMA:
+			if (!operand)
+			{
+				// A failed first operand fails the expression, a later one ends it
+				*value = frame->expression;
+				frames->size--;
+				return false;
+			}
 
-AstExpression* Parser_ParseMultiplicativeExpression(Parser* self)
-{
-	AstExpression* lhs = Parser_ParseCastExpression(self);
-	if (!lhs)
-		return NULL;
+			frame->expression = frame->expression
+				                    ? NewWithIn(self->arena, AstExpression, Binary, AST_BINOP_COMMA, frame->expression, operand,
+				                                SourceLocation_Concat(&frame->expression->location, &operand->location))
+				                    : operand;
+			if (Parser_MatchToken(self, TOKEN_PUNCTUATOR_COMMA, NULL))
+			{
+				*outGoal = (Parser_Goal) { PARSER_GOAL_BINARY, PARSER_PRECEDENCE_ASSIGNMENT };
+				return true;
+			}
 
-	while (true)
-	{
-		const Token* token = Parser_PeekToken(self);
+			*value = frame->expression;
+			frames->size--;
+			return false;
+		case PARSER_FRAME_BINARY:
+			return Parser_ResumeBinaryExpression(self, frame, value, outGoal);
+		case PARSER_FRAME_CAST:
+		{
+			AstTypeName* type = frame->typeName;
+			const SourceLocation startLocation = frame->location;
+			frames->size--;
+			if (!operand)
+			{
+				Release(type);
+				return false;
+			}
 
-		AstBinaryOperation op;
-		switch (token->type)
+			*value = NewWithIn(self->arena, AstExpression, Cast, type, operand, SourceLocation_Concat(&startLocation, &operand->location));
+			return false;
+		}
+		case PARSER_FRAME_UNARY:
 		{
-			case TOKEN_PUNCTUATOR_ASTERISK:
-				op = AST_BINOP_MULTIPLY;
-				break;
-			case TOKEN_PUNCTUATOR_SLASH:
-				op = AST_BINOP_DIVIDE;
-				break;
-			case TOKEN_PUNCTUATOR_PERCENT:
-				op = AST_BINOP_MODULO;
-				break;
-			default:
-				op = AST_BINOP_NONE;
+			const AstUnaryOperation op = frame->operation;
+			const SourceLocation tokenLocation = frame->location;
+			frames->size--;
+			if (!operand)
+				return false;
+
+			*value = NewWithIn(self->arena, AstExpression, Unary,
+			                   op, operand,
+			                   SourceLocation_Concat(&tokenLocation, &operand->location));
+			return false;
 		}
+		case PARSER_FRAME_PARENTHESIZED:
+			if (!operand)
+			{
+				frames->size--;
+				return false;
+			}
 
-		if (op == AST_BINOP_NONE)
-			break;
-
-		Parser_ConsumeToken(self);
-		AstExpression* rhs = Parser_ParseCastExpression(self);
-		if (!rhs)
-			return lhs;
-
-		lhs = NewWith(AstExpression, Binary, op, lhs, rhs, SourceLocation_Concat(&lhs->location, &rhs->location));
-	}
+			if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENCLOSE, NULL))
+			{
+				CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedClosingParenthesisInParenthesizedExpression, operand->location));
+				Release(operand);
+				frames->size--;
+				*value = NULL;
+				return false;
+			}
 
-	return lhs;
-}
+			frame->type = PARSER_FRAME_POSTFIX;
+			frame->expression = operand;
+			return Parser_ResumePostfixExpression(self, frame, value, outGoal);
+		case PARSER_FRAME_POSTFIX:
+			frame->expression = operand;
+			return Parser_ResumePostfixExpression(self, frame, value, outGoal);
+		case PARSER_FRAME_SUBSCRIPT:
+			if (!operand)
+			{
+				Parser_AbandonFrame(self);
+				return false;
+			}
 
-AstExpression* Parser_ParseAdditiveExpression(Parser* self)
-{
-	AstExpression* lhs = Parser_ParseMultiplicativeExpression(self);
-	if (!lhs)
-		return NULL;
+			if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_BRACKETCLOSE, NULL))
+			{
+				CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedClosingBracketInSubscriptExpression, operand->location));
+				Release(operand);
+				Parser_AbandonFrame(self);
+				*value = NULL;
+				return false;
+			}
 
-	while (true)
-	{
-		const Token* token = Parser_PeekToken(self);
+			frame->type = PARSER_FRAME_POSTFIX;
+			frame->expression = NewWithIn(self->arena, AstExpression, Binary,
+			                              AST_BINOP_SUBSCRIPT, frame->expression, operand,
+			                              SourceLocation_Concat(&frame->expression->location, &operand->location));
+			return Parser_ResumePostfixExpression(self, frame, value, outGoal);
+		case PARSER_FRAME_ARGUMENT:
+			if (!operand)
+			{
+				Parser_AbandonFrame(self);
+				return false;
+			}
 
-		AstBinaryOperation op;
-		switch (token->type)
-		{
-			case TOKEN_PUNCTUATOR_PLUS:
-				op = AST_BINOP_ADD;
-				break;
-			case TOKEN_PUNCTUATOR_MINUS:
-				op = AST_BINOP_SUBTRACT;
-				break;
-			default:
-				op = AST_BINOP_NONE;
-		}
+			AstExpressionList_Append(frame->arguments, operand);
 
-		if (op == AST_BINOP_NONE)
-			break;
+			if (Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENCLOSE, NULL))
+			{
+				frame->type = PARSER_FRAME_POSTFIX;
+				frame->expression = NewWithIn(self->arena, AstExpression, Call,
+				                              frame->expression, Parser_Adopt(self, frame->arguments),
+				                              SourceLocation_Concat(&frame->expression->location, &frame->location));
+				frame->arguments = NULL;
+				return Parser_ResumePostfixExpression(self, frame, value, outGoal);
+			}
 
-		Parser_ConsumeToken(self);
-		AstExpression* rhs = Parser_ParseMultiplicativeExpression(self);
-		if (!rhs)
-			return lhs;
+			if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_COMMA, NULL))
+			{
+				CompilerErrorList_Append(self->errors, CompilerError_Create("expected ',' or ')' in function call argument list", operand->location));
+				Parser_AbandonFrame(self);
+				*value = NULL;
+				return false;
+			}
 
-		lhs = NewWith(AstExpression, Binary, op, lhs, rhs, SourceLocation_Concat(&lhs->location, &rhs->location));
+			*outGoal = (Parser_Goal) { PARSER_GOAL_BINARY, PARSER_PRECEDENCE_ASSIGNMENT };
+			return true;
+		default:
+			assert(false && "unreachable");
+			return false;
 	}
-
-	return lhs;
 }
 
-AstExpression* Parser_ParseShiftExpression(Parser* self)
+bool Parser_ResumeBinaryExpression(Parser* self, Parser_ExpressionFrame* frame, AstExpression*nullable* value, Parser_Goal* outGoal)
 {
-	AstExpression* lhs = Parser_ParseAdditiveExpression(self);
-	if (!lhs)
-		return NULL;
-
-	while (true)
+	// Precedence climbing: one loop per operand instead of one function per grammar level.
+	// maxPrecedence mirrors how the one-function-per-level grammar unwinds: once an operator of some level is
+	// reduced (or its operand fails to parse), only operators binding no tighter can continue this expression.
+	AstExpression*nullable operand = *value;
+	if (!frame->expression)
 	{
-		const Token* token = Parser_PeekToken(self);
-
-		AstBinaryOperation op;
-		switch (token->type)
+		if (!operand)
 		{
-			case TOKEN_PUNCTUATOR_LESS_LESS:
-				op = AST_BINOP_SHIFT_LEFT;
-				break;
-			case TOKEN_PUNCTUATOR_GREATER_GREATER:
-				op = AST_BINOP_SHIFT_RIGHT;
-				break;
-			default:
-				op = AST_BINOP_NONE;
+			self->expressionFrames->size--;
+			return false;
 		}
-
-		if (op == AST_BINOP_NONE)
-			break;
-
-		Parser_ConsumeToken(self);
-		AstExpression* rhs = Parser_ParseAdditiveExpression(self);
-		if (!rhs)
-			return lhs;
-
-		lhs = NewWith(AstExpression, Binary, op, lhs, rhs, SourceLocation_Concat(&lhs->location, &rhs->location));
+		frame->expression = operand;
 	}
-
-	return lhs;
-}
-
-AstExpression* Parser_ParseRelationalExpression(Parser* self)
-{
-	AstExpression* lhs = Parser_ParseShiftExpression(self);
-	if (!lhs)
-		return NULL;
-
-	while (true)
+	else if (frame->op.precedence == PARSER_PRECEDENCE_CONDITIONAL && !frame->ifTrue)
 	{
-		const Token* token = Parser_PeekToken(self);
-
-		AstBinaryOperation op;
-		switch (token->type)
+		// Middle operand of '?:'; a missing one leaves the condition as it is
+		if (operand && !Parser_MatchToken(self, TOKEN_PUNCTUATOR_COLON, NULL))
 		{
-			case TOKEN_PUNCTUATOR_LESS:
-				op = AST_BINOP_TEST_LESS;
-				break;
-			case TOKEN_PUNCTUATOR_GREATER:
-				op = AST_BINOP_TEST_GREATER;
-				break;
-			case TOKEN_PUNCTUATOR_LESS_EQUAL:
-				op = AST_BINOP_TEST_LESS_EQUAL;
-				break;
-			case TOKEN_PUNCTUATOR_GREATER_EQUAL:
-				op = AST_BINOP_TEST_GREATER_EQUAL;
-				break;
-			default:
-				op = AST_BINOP_NONE;
+			CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedColonInConditionalExpression, frame->expression->location));
+			Release(operand);
 		}
-
-		if (op == AST_BINOP_NONE)
-			break;
-
-		Parser_ConsumeToken(self);
-		AstExpression* rhs = Parser_ParseShiftExpression(self);
-		if (!rhs)
-			return lhs;
-
-		lhs = NewWith(AstExpression, Binary, op, lhs, rhs, SourceLocation_Concat(&lhs->location, &rhs->location));
-	}
-
-	return lhs;
-}
-
-AstExpression* Parser_ParseEqualityExpression(Parser* self)
-{
-	AstExpression* lhs = Parser_ParseRelationalExpression(self);
-	if (!lhs)
-		return NULL;
-
-	while (true)
-	{
-		const Token* token = Parser_PeekToken(self);
-
-		AstBinaryOperation op;
-		switch (token->type)
+		else if (operand)
 		{
-			case TOKEN_PUNCTUATOR_EQUAL_EQUAL:
-				op = AST_BINOP_TEST_EQUAL;
-				break;
-			case TOKEN_PUNCTUATOR_EXCLAMATION_EQUAL:
-				op = AST_BINOP_TEST_NOT_EQUAL;
-				break;
-			default:
-				op = AST_BINOP_NONE;
+			frame->ifTrue = operand;
+			*outGoal = (Parser_Goal) { PARSER_GOAL_BINARY, PARSER_PRECEDENCE_CONDITIONAL };
+			return true;
 		}
-
-		if (op == AST_BINOP_NONE)
-			break;
-
-		Parser_ConsumeToken(self);
-		AstExpression* rhs = Parser_ParseRelationalExpression(self);
-		if (!rhs)
-			return lhs;
-
-		lhs = NewWith(AstExpression, Binary, op, lhs, rhs, SourceLocation_Concat(&lhs->location, &rhs->location));
 	}
-
-	return lhs;
-}
-
-AstExpression* Parser_ParseBitwiseAndExpression(Parser* self)
-{
-	AstExpression* lhs = Parser_ParseEqualityExpression(self);
-	if (!lhs)
-		return NULL;
-
-	while (Parser_MatchToken(self, TOKEN_PUNCTUATOR_AMPERSAND, NULL))
+	else if (frame->op.precedence == PARSER_PRECEDENCE_CONDITIONAL)
 	{
-		AstExpression* rhs = Parser_ParseEqualityExpression(self);
-		if (!rhs)
-			return lhs;
-
-		lhs = NewWith(AstExpression, Binary, AST_BINOP_BITWISE_AND, lhs, rhs, SourceLocation_Concat(&lhs->location, &rhs->location));
+		if (operand)
+		{
+			frame->expression = NewWithIn(self->arena, AstExpression, Ternary,
+			                              AST_TERNOP_CONDITIONAL, frame->expression, frame->ifTrue, operand,
+			                              SourceLocation_Concat(&frame->expression->location, &operand->location));
+			frame->maxPrecedence = PARSER_PRECEDENCE_CONDITIONAL;
+		}
+		else
+			Release(frame->ifTrue);
+		frame->ifTrue = NULL;
 	}
-
-	return lhs;
-}
-
-AstExpression* Parser_ParseBitwiseXorExpression(Parser* self)
-{
-	AstExpression* lhs = Parser_ParseBitwiseAndExpression(self);
-	if (!lhs)
-		return NULL;
-
-	while (Parser_MatchToken(self, TOKEN_PUNCTUATOR_CARET, NULL))
+	else
 	{
-		AstExpression* rhs = Parser_ParseBitwiseAndExpression(self);
-		if (!rhs)
-			return lhs;
-
-		lhs = NewWith(AstExpression, Binary, AST_BINOP_BITWISE_XOR, lhs, rhs, SourceLocation_Concat(&lhs->location, &rhs->location));
+		const bool rightAssociative = frame->op.precedence == PARSER_PRECEDENCE_ASSIGNMENT;
+		if (operand)
+		{
+			frame->expression = NewWithIn(self->arena, AstExpression, Binary, frame->op.operation, frame->expression, operand,
+			                              SourceLocation_Concat(&frame->expression->location, &operand->location));
+			frame->maxPrecedence = rightAssociative ? frame->op.precedence - 1 : frame->op.precedence;
+		}
+		else
+			frame->maxPrecedence = frame->op.precedence - 1;
 	}
 
-	return lhs;
-}
-
-AstExpression* Parser_ParseBitwiseOrExpression(Parser* self)
-{
-	AstExpression* lhs = Parser_ParseBitwiseXorExpression(self);
-	if (!lhs)
-		return NULL;
-
-	while (Parser_MatchToken(self, TOKEN_PUNCTUATOR_PIPE, NULL))
+	const Token token = Parser_PeekToken(self);
+	const Parser_BinaryOperator op = binaryOperators[token.type];
+	if (op.precedence == PARSER_PRECEDENCE_NONE || op.precedence < frame->minPrecedence || op.precedence > frame->maxPrecedence)
 	{
-		AstExpression* rhs = Parser_ParseBitwiseXorExpression(self);
-		if (!rhs)
-			return lhs;
-
-		lhs = NewWith(AstExpression, Binary, AST_BINOP_BITWISE_OR, lhs, rhs, SourceLocation_Concat(&lhs->location, &rhs->location));
+		*value = frame->expression;
+		self->expressionFrames->size--;
+		return false;
 	}
 
-	return lhs;
-}
-
-AstExpression* Parser_ParseLogicalAndExpression(Parser* self)
-{
-	AstExpression* lhs = Parser_ParseBitwiseOrExpression(self);
-	if (!lhs)
-		return NULL;
+	Parser_ConsumeToken(self);
+	frame->op = op;
 
-	while (Parser_MatchToken(self, TOKEN_PUNCTUATOR_AMPERSAND_AMPERSAND, NULL))
+	if (op.precedence == PARSER_PRECEDENCE_CONDITIONAL)
 	{
-		AstExpression* rhs = Parser_ParseBitwiseOrExpression(self);
-		if (!rhs)
-			return lhs;
-
-		lhs = NewWith(AstExpression, Binary, AST_BINOP_LOGICAL_AND, lhs, rhs, SourceLocation_Concat(&lhs->location, &rhs->location));
+		frame->maxPrecedence = PARSER_PRECEDENCE_ASSIGNMENT;
+		*outGoal = (Parser_Goal) { PARSER_GOAL_EXPRESSION, PARSER_PRECEDENCE_NONE };
+		return true;
 	}
 
-	return lhs;
+	// NOTE: Technically, according to the C standard, the left side of an assignment is a unary expression.
+	// This enforces that only l-values can be assigned to within the language grammar.
+	// However, for simplicity, we accept any operand here and perform l-value checking later during semantic analysis.
+	const bool rightAssociative = op.precedence == PARSER_PRECEDENCE_ASSIGNMENT;
+	*outGoal = (Parser_Goal) { PARSER_GOAL_BINARY, rightAssociative ? op.precedence : op.precedence + 1 };
+	return true;
 }
 
-AstExpression* Parser_ParseLogicalOrExpression(Parser* self)
+bool Parser_ResumePostfixExpression(Parser* self, Parser_ExpressionFrame* frame, AstExpression*nullable* value, Parser_Goal* outGoal)
 {
-	AstExpression* lhs = Parser_ParseLogicalAndExpression(self);
-	if (!lhs)
-		return NULL;
-
-	while (Parser_MatchToken(self, TOKEN_PUNCTUATOR_PIPE_PIPE, NULL))
+	while (true)
 	{
-		AstExpression* rhs = Parser_ParseLogicalAndExpression(self);
-		if (!rhs)
-			return lhs;
+		const Token token = Parser_PeekToken(self);
+		if (token.type == TOKEN_PUNCTUATOR_BRACKETOPEN)
+		{
+			// Subscript expression
+			Parser_ConsumeToken(self);
+			frame->type = PARSER_FRAME_SUBSCRIPT;
+			*outGoal = (Parser_Goal) { PARSER_GOAL_EXPRESSION, PARSER_PRECEDENCE_NONE };
+			return true;
+		}
 
-		lhs = NewWith(AstExpression, Binary, AST_BINOP_LOGICAL_OR, lhs, rhs, SourceLocation_Concat(&lhs->location, &rhs->location));
-	}
+		if (token.type == TOKEN_PUNCTUATOR_PERIOD || token.type == TOKEN_PUNCTUATOR_MINUS_GREATER)
+		{
+			// Member access
+			Parser_ConsumeToken(self);
 
-	return lhs;
-}
+			const Token indentifier = Parser_PeekToken(self);
 
-AstExpression* Parser_ParseConditionalExpression(Parser* self)
-{
-	AstExpression* lhs = Parser_ParseLogicalOrExpression(self);
-	if (!lhs)
-		return NULL;
+			if (indentifier.type != TOKEN_IDENTIFIER)
+			{
+				CompilerErrorList_Append(
+					self->errors, CompilerError_Create("expected identifier after '.' or '->' in member access expression", Parser_GetTokenLocation(self, &token)));
+				Parser_AbandonFrame(self);
+				*value = NULL;
+				return false;
+			}
 
-	while (Parser_MatchToken(self, TOKEN_PUNCTUATOR_QUESTION, NULL))
-	{
-		AstExpression* ifTrue = Parser_ParseExpression(self);
-		if (!ifTrue)
-			break;
+			Parser_ConsumeToken(self);
 
-		if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_COLON, NULL))
-		{
-			CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedColonInConditionalExpression, lhs->location));
-			break;
+			const SourceLocation identifierLocation = Parser_GetTokenLocation(self, &indentifier);
+			frame->expression = NewWithIn(self->arena, AstExpression, MemberAccess,
+			                              frame->expression, identifierLocation.snippet, indentifier.symbol, token.type == TOKEN_PUNCTUATOR_MINUS_GREATER,
+			                              SourceLocation_Concat(&frame->expression->location, &identifierLocation));
+			continue;
 		}
 
-		AstExpression* ifFalse = Parser_ParseConditionalExpression(self);
-		if (!ifFalse)
-			break;
-
-		lhs = NewWith(AstExpression, Ternary,
-		              AST_TERNOP_CONDITIONAL, lhs, ifTrue, ifFalse,
-		              SourceLocation_Concat(&lhs->location, &ifFalse->location));
-	}
-
-	return lhs;
-}
+		if (token.type == TOKEN_PUNCTUATOR_PLUS_PLUS || token.type == TOKEN_PUNCTUATOR_MINUS_MINUS)
+		{
+			// Postfix increment/decrement
+			Parser_ConsumeToken(self);
 
-AstExpression* Parser_ParseAssignmentExpression(Parser* self)
-{
-	// NOTE: Technically, according to the C standard, this is either
-	//  - a unary expression or
-	//  - a conditional expression followed by an assignment operator and another assignment expression.
-	// This definition enforces that only l-values can be assigned to within the language grammar.
-	// However, for simplicity, we will parse it as a conditional expression followed by an optional
-	// assignment operator and another assignment expression, and perform l-value checking later during semantic analysis.
-	AstExpression* lhs = Parser_ParseConditionalExpression(self);
-	if (!lhs)
-		return NULL;
+			const AstUnaryOperation op = (token.type == TOKEN_PUNCTUATOR_PLUS_PLUS) ? AST_UNOP_POST_INCREMENT : AST_UNOP_POST_DECREMENT;
 
-	const Token* token = Parser_PeekToken(self);
-	if (token != NULL)
-	{
-		AstBinaryOperation op;
-		switch (token->type)
-		{
-			case TOKEN_PUNCTUATOR_EQUAL:
-				op = AST_BINOP_ASSIGN;
-				break;
-			case TOKEN_PUNCTUATOR_ASTERISK_EQUAL:
-				op = AST_BINOP_ASSIGN_MULTIPLY;
-				break;
-			case TOKEN_PUNCTUATOR_SLASH_EQUAL:
-				op = AST_BINOP_ASSIGN_DIVIDE;
-				break;
-			case TOKEN_PUNCTUATOR_PERCENT_EQUAL:
-				op = AST_BINOP_ASSIGN_MODULO;
-				break;
-			case TOKEN_PUNCTUATOR_PLUS_EQUAL:
-				op = AST_BINOP_ASSIGN_ADD;
-				break;
-			case TOKEN_PUNCTUATOR_MINUS_EQUAL:
-				op = AST_BINOP_ASSIGN_SUBTRACT;
-				break;
-			case TOKEN_PUNCTUATOR_LESS_LESS_EQUAL:
-				op = AST_BINOP_ASSIGN_LEFT_SHIFT;
-				break;
-			case TOKEN_PUNCTUATOR_GREATER_GREATER_EQUAL:
-				op = AST_BINOP_ASSIGN_RIGHT_SHIFT;
-				break;
-			case TOKEN_PUNCTUATOR_AMPERSAND_EQUAL:
-				op = AST_BINOP_ASSIGN_AND;
-				break;
-			case TOKEN_PUNCTUATOR_CARET_EQUAL:
-				op = AST_BINOP_ASSIGN_XOR;
-				break;
-			case TOKEN_PUNCTUATOR_PIPE_EQUAL:
-				op = AST_BINOP_ASSIGN_OR;
-				break;
-			default:
-				op = AST_BINOP_NONE;
+			const SourceLocation tokenLocation = Parser_GetTokenLocation(self, &token);
+			frame->expression = NewWithIn(self->arena, AstExpression, Unary,
+			                              op, frame->expression,
+			                              SourceLocation_Concat(&frame->expression->location, &tokenLocation));
+			continue;
 		}
 
-		if (op != AST_BINOP_NONE)
+		if (token.type == TOKEN_PUNCTUATOR_PARENOPEN)
 		{
+			// Function call
 			Parser_ConsumeToken(self);
-			AstExpression* rhs = Parser_ParseAssignmentExpression(self);
-			if (!rhs)
-				return lhs;
 
-			lhs = NewWith(AstExpression, Binary,
-			              op, lhs, rhs,
-			              SourceLocation_Concat(&lhs->location, &rhs->location));
+			frame->location = Parser_GetTokenLocation(self, &token);
+			if (Parser_MatchToken(self, TOKEN_PUNCTUATOR_PARENCLOSE, NULL))
+			{
+				frame->expression = NewWithIn(self->arena, AstExpression, Call,
+				                              frame->expression, Parser_Adopt(self, New(AstExpressionList)),
+				                              SourceLocation_Concat(&frame->expression->location, &frame->location));
+				continue;
+			}
+
+			frame->type = PARSER_FRAME_ARGUMENT;
+			frame->arguments = New(AstExpressionList);
+			*outGoal = (Parser_Goal) { PARSER_GOAL_BINARY, PARSER_PRECEDENCE_ASSIGNMENT };
+			return true;
 		}
+		break;
 	}
 
-	return lhs;
+	*value = frame->expression;
+	self->expressionFrames->size--;
+	return false;
 }
 
 AstExpression* Parser_ParseExpression(Parser* self)
 {
-	AstExpression* lhs = Parser_ParseAssignmentExpression(self);
-	if (!lhs)
-		return NULL;
+	return Parser_ParseExpressionFrom(self, (Parser_Goal) { PARSER_GOAL_EXPRESSION, PARSER_PRECEDENCE_NONE });
+}
 
-	while (Parser_MatchToken(self, TOKEN_PUNCTUATOR_COMMA, NULL))
+AstExpression* Parser_ParseExpressionFrom(Parser* self, Parser_Goal goal)
+{
+	// Operators waiting for an operand are kept on an explicit stack instead of the C stack, so nesting depth only
+	// costs frames. The stack is kept between calls.
+	if (!self->expressionFrames)
+		self->expressionFrames = New(Parser_ExpressionFrameList);
+
+	const size_t base = self->expressionFrames->size;
+	while (true)
 	{
-		AstExpression* rhs = Parser_ParseAssignmentExpression(self);
-		if (!rhs)
-			return lhs;
+		AstExpression*nullable value = Parser_DescendExpression(self, goal);
 
-		lhs = NewWith(AstExpression, Binary, AST_BINOP_COMMA, lhs, rhs, SourceLocation_Concat(&lhs->location, &rhs->location));
+		// Hand the operand down the stack until a frame needs another one
+		do
+		{
+			if (self->expressionFrames->size == base)
+				return value;
+		} while (!Parser_ResumeExpression(self, &value, &goal));
 	}
-
-	return lhs;
 }
 
 AstDeclaration* Parser_TryParseDeclaration(Parser* self)
 {
 	// TODO: static_assert-declaration
 
-	AstDeclarationSpecifiers* declSpecs = Parser_ParseDeclarationSpecifiers(self);
+	const Token token = Parser_PeekToken(self);
+	if (!Parser_IsDeclarationStart(self, &token))
+		return NULL;
+
+	using AstDeclarationSpecifiers* declSpecs = Parser_ParseDeclarationSpecifiers(self);
 	if (!declSpecs)
 		return NULL;
 
-	// TODO: init-declarator-list
+	bool isTypedef = false;
+	for (size_t i = 0; i < declSpecs->storageClassSpecifiers->size; i++)
+		isTypedef |= declSpecs->storageClassSpecifiers->data[i]->type == AST_STORAGECLASSSPECIFIER_TYPEDEF;
+
+	// init-declarator-list
+	using AstDeclaratorList* declarators = New(AstDeclaratorList);
+	if (Parser_PeekToken(self).type != TOKEN_PUNCTUATOR_SEMICOLON)
+	{
+		do
+		{
+			AstDeclarator* declarator = Parser_TryParseDeclarator(self);
+			if (!declarator)
+				return NULL;
+
+			// The name is in scope from the end of its declarator on, so later declarators can already use it
+			Parser_DeclareName(self, declarator, isTypedef);
+			AstDeclaratorList_Append(declarators, declarator);
+
+			// "= <assignment-expression>"; the comma after it separates declarators
+			if (Parser_MatchToken(self, TOKEN_PUNCTUATOR_EQUAL, NULL))
+			{
+				if (Parser_PeekToken(self).type == TOKEN_PUNCTUATOR_BRACEOPEN)
+				{
+					CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_InitializerListNotSupported, declarator->location));
+					return NULL;
+				}
+
+				const size_t errorCount = self->errors->size;
+				declarator->initializer = Parser_ParseExpressionFrom(self, (Parser_Goal) { PARSER_GOAL_BINARY, PARSER_PRECEDENCE_ASSIGNMENT });
+				if (!declarator->initializer)
+				{
+					if (self->errors->size == errorCount)
+						CompilerErrorList_Append(self->errors, CompilerError_Create(ErrorMsg_ExpectedInitializer, declarator->location));
+					return NULL;
+				}
+			}
+		} while (Parser_MatchToken(self, TOKEN_PUNCTUATOR_COMMA, NULL));
+	}
 
 	SourceLocation endLocation = { 0 };
 	if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_SEMICOLON, &endLocation))
@@ -786,8 +883,8 @@ AstDeclaration* Parser_TryParseDeclaration(Parser* self)
 		CompilerErrorList_Append(self->errors, CompilerError_Create("expected ';' at end of declaration", declSpecs->location));
 		return NULL;
 	}
-	return NewWith(AstDeclaration, Args, Retain(declSpecs),
-	               SourceLocation_Concat(&declSpecs->location, &endLocation));
+	return NewWithIn(self->arena, AstDeclaration, Args, Retain(declSpecs), Parser_Adopt(self, Retain(declarators)),
+	                 SourceLocation_Concat(&declSpecs->location, &endLocation));
 }
 
 AstDeclarationSpecifiers* Parser_ParseDeclarationSpecifiers(Parser* self)
@@ -805,23 +902,23 @@ AstDeclarationSpecifiers* Parser_ParseDeclarationSpecifiers(Parser* self)
 		AstStorageClassSpecifier* storageClassSpecifier = Parser_TryParseStorageClassSpecifier(self);
 		if (storageClassSpecifier)
 		{
+			locationEnd = storageClassSpecifier->location;
+
 			if (!locationStart.sourceFile)
 				locationStart = locationEnd;
 
-			locationEnd = storageClassSpecifier->location;
-
 			AstStorageClassSpecifierList_Append(storageClassSpecifiers, storageClassSpecifier);
 			continue;
 		}
 
-		AstTypeSpecifier* typeSpecifier = Parser_TryParseTypeSpecifier(self);
+		AstTypeSpecifier* typeSpecifier = Parser_TryParseTypeSpecifier(self, typeSpecifiers->size == 0);
 		if (typeSpecifier)
 		{
+			locationEnd = typeSpecifier->location;
+
 			if (!locationStart.sourceFile)
 				locationStart = locationEnd;
 
-			locationEnd = typeSpecifier->location;
-
 			AstTypeSpecifierList_Append(typeSpecifiers, typeSpecifier);
 			continue;
 		}
@@ -853,21 +950,22 @@ AstDeclarationSpecifiers* Parser_ParseDeclarationSpecifiers(Parser* self)
 
 	if (storageClassSpecifiers->size == 0 && typeSpecifiers->size == 0 && !typeQualifiers && !functionSpecifiers)
 	{
-		const Token* token = Parser_PeekToken(self);
-		CompilerErrorList_Append(self->errors, CompilerError_Create("expected declaration specifier", token->location));
+		const Token token = Parser_PeekToken(self);
+		CompilerErrorList_Append(self->errors, CompilerError_Create("expected declaration specifier", Parser_GetTokenLocation(self, &token)));
 		return NULL;
 	}
 
-	return NewWith(AstDeclarationSpecifiers, Args, Retain(storageClassSpecifiers), Retain(typeSpecifiers), typeQualifiers, functionSpecifiers,
-	               SourceLocation_Concat(&locationStart, &locationEnd));
+	return NewWithIn(self->arena, AstDeclarationSpecifiers, Args, Parser_Adopt(self, Retain(storageClassSpecifiers)),
+	                 Parser_Adopt(self, Retain(typeSpecifiers)), typeQualifiers, functionSpecifiers,
+	                 SourceLocation_Concat(&locationStart, &locationEnd));
 }
 
 AstStorageClassSpecifier* Parser_TryParseStorageClassSpecifier(Parser* self)
 {
-	const Token* token = Parser_PeekToken(self);
+	const Token token = Parser_PeekToken(self);
 
 	AstStorageClassSpecifier_Type type;
-	switch (token->type)
+	switch (token.type)
 	{
 		case TOKEN_KEYWORD_AUTO:
 			type = AST_STORAGECLASSSPECIFIER_AUTO;
@@ -894,18 +992,18 @@ AstStorageClassSpecifier* Parser_TryParseStorageClassSpecifier(Parser* self)
 	if (type != AST_STORAGECLASSSPECIFIER_NONE)
 	{
 		Parser_ConsumeToken(self);
-		return NewWith(AstStorageClassSpecifier, Args, type, token->location);
+		return NewWithIn(self->arena, AstStorageClassSpecifier, Args, type, Parser_GetTokenLocation(self, &token));
 	}
 
 	return NULL;
 }
 
-AstTypeSpecifier* Parser_TryParseTypeSpecifier(Parser* self)
+AstTypeSpecifier* Parser_TryParseTypeSpecifier(Parser* self, const bool allowTypedefName)
 {
-	const Token* token = Parser_PeekToken(self);
+	const Token token = Parser_PeekToken(self);
 
 	AstTypeSpecifier_Type type;
-	switch (token->type)
+	switch (token.type)
 	{
 		case TOKEN_KEYWORD_VOID:
 			type = AST_TYPESPECIFIER_VOID;
@@ -943,12 +1041,23 @@ AstTypeSpecifier* Parser_TryParseTypeSpecifier(Parser* self)
 		case TOKEN_KEYWORD_ENUM:
 			type = AST_TYPESPECIFIER_ENUM;
 			break;
+		case TOKEN_IDENTIFIER:
+			// A typedef name after another type specifier is the declarator, as in "typedef int T; long T;"
+			type = allowTypedefName && TypedefTable_IsTypedefName(&self->typedefNames, token.symbol)
+				       ? AST_TYPESPECIFIER_TYPEDEF_NAME
+				       : AST_TYPESPECIFIER_NONE;
+			break;
 		default:
-			// TODO: check if identifier is a typedef-name
 			type = AST_TYPESPECIFIER_NONE;
 			break;
 	}
 
+	if (type == AST_TYPESPECIFIER_TYPEDEF_NAME)
+	{
+		Parser_ConsumeToken(self);
+		return NewWithIn(self->arena, AstTypeSpecifier, TypedefName, token.symbol, Parser_GetTokenLocation(self, &token));
+	}
+
 	if (type == AST_TYPESPECIFIER_STRUCT ||
 	    type == AST_TYPESPECIFIER_UNION ||
 	    type == AST_TYPESPECIFIER_ENUM)
@@ -960,7 +1069,7 @@ AstTypeSpecifier* Parser_TryParseTypeSpecifier(Parser* self)
 	if (type != AST_TYPESPECIFIER_NONE)
 	{
 		Parser_ConsumeToken(self);
-		return NewWith(AstTypeSpecifier, Args, type, token->location);
+		return NewWithIn(self->arena, AstTypeSpecifier, Args, type, Parser_GetTokenLocation(self, &token));
 	}
 
 	return NULL;
@@ -976,7 +1085,7 @@ AstTypeSpecifierQualifierList* Parser_TryParseSpecifierQualifierList(Parser* sel
 
 	while (true)
 	{
-		AstTypeSpecifier* specifier = Parser_TryParseTypeSpecifier(self);
+		AstTypeSpecifier* specifier = Parser_TryParseTypeSpecifier(self, specifiers->size == 0);
 		if (specifier)
 		{
 			locationEnd = specifier->location;
@@ -1006,15 +1115,15 @@ AstTypeSpecifierQualifierList* Parser_TryParseSpecifierQualifierList(Parser* sel
 	if (specifiers->size == 0 && !qualifiers)
 		return NULL;
 
-	return NewWith(AstTypeSpecifierQualifierList, Args, Retain(specifiers), qualifiers, SourceLocation_Concat(&locationStart, &locationEnd));
+	return NewWithIn(self->arena, AstTypeSpecifierQualifierList, Args, Parser_Adopt(self, Retain(specifiers)), qualifiers, SourceLocation_Concat(&locationStart, &locationEnd));
 }
 
 AstTypeQualifiers Parser_TryParseTypeQualifier(Parser* self, SourceLocation*nullable outLocation)
 {
-	const Token* token = Parser_PeekToken(self);
+	const Token token = Parser_PeekToken(self);
 
 	AstTypeQualifiers type;
-	switch (token->type)
+	switch (token.type)
 	{
 		case TOKEN_KEYWORD_CONST:
 			type = AST_TYPEQUALIFIERS_CONST;
@@ -1034,7 +1143,7 @@ AstTypeQualifiers Parser_TryParseTypeQualifier(Parser* self, SourceLocation*null
 	{
 		Parser_ConsumeToken(self);
 		if (outLocation)
-			*outLocation = token->location;
+			*outLocation = Parser_GetTokenLocation(self, &token);
 		return type;
 	}
 
@@ -1043,10 +1152,10 @@ AstTypeQualifiers Parser_TryParseTypeQualifier(Parser* self, SourceLocation*null
 
 AstFunctionSpecifiers Parser_TryParseFunctionSpecifier(Parser* self, SourceLocation*nullable outLocation)
 {
-	const Token* token = Parser_PeekToken(self);
+	const Token token = Parser_PeekToken(self);
 
 	AstFunctionSpecifiers type;
-	switch (token->type)
+	switch (token.type)
 	{
 		case TOKEN_KEYWORD_INLINE:
 			type = AST_FUNCTIONSPECIFIERS_INLINE;
@@ -1060,7 +1169,7 @@ AstFunctionSpecifiers Parser_TryParseFunctionSpecifier(Parser* self, SourceLocat
 	{
 		Parser_ConsumeToken(self);
 		if (outLocation)
-			*outLocation = token->location;
+			*outLocation = Parser_GetTokenLocation(self, &token);
 		return type;
 	}
 
@@ -1076,20 +1185,21 @@ AstDeclarator* Parser_TryParseDeclarator(Parser* self)
 
 	const SourceLocation locationStart = pointer ? pointer->location : directDeclarator->location;
 	const SourceLocation loc = SourceLocation_Concat(&locationStart, &directDeclarator->location);
-	return NewWith(AstDeclarator, Args, Retain(pointer), directDeclarator, loc);
+	return NewWithIn(self->arena, AstDeclarator, Args, Retain(pointer), directDeclarator, loc);
 }
 
 AstDirectDeclarator* Parser_TryParseDirectDeclarator(Parser* self)
 {
-	const Token* token = Parser_PeekToken(self);
+	const Token token = Parser_PeekToken(self);
+	const SourceLocation tokenLocation = Parser_GetTokenLocation(self, &token);
 
-	if (token->type == TOKEN_IDENTIFIER)
+	if (token.type == TOKEN_IDENTIFIER)
 	{
 		Parser_ConsumeToken(self);
-		return NewWith(AstDirectDeclarator, Identifier, token->data.literalIdentifier.value, token->location);
+		return NewWithIn(self->arena, AstDirectDeclarator, Identifier, tokenLocation.snippet, token.symbol, tokenLocation);
 	}
 
-	if (token->type == TOKEN_PUNCTUATOR_PARENOPEN)
+	if (token.type == TOKEN_PUNCTUATOR_PARENOPEN)
 	{
 		Parser_ConsumeToken(self);
 
@@ -1104,29 +1214,29 @@ AstDirectDeclarator* Parser_TryParseDirectDeclarator(Parser* self)
 			return NULL;
 		}
 
-		return NewWith(AstDirectDeclarator, Parenthesized, declarator, SourceLocation_Concat(&token->location, &declarator->location));
+		return NewWithIn(self->arena, AstDirectDeclarator, Parenthesized, declarator, SourceLocation_Concat(&tokenLocation, &declarator->location));
 	}
 
 	// TODO: array declarators, function declarators, etc.
-	abort();
+	CompilerErrorList_Append(self->errors, CompilerError_Create("expected identifier or '(' in declarator", tokenLocation));
+	return NULL;
 }
 
 AstPointer* Parser_TryParsePointer(Parser* self)
 {
+	// "* <type-qualifier-list>opt <pointer>opt"
 	SourceLocation locationStart = { 0 };
-	const size_t savedTokenIndex = self->currentTokenIndex;
 	if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_ASTERISK, &locationStart))
 		return NULL;
 
-	SourceLocation locationEnd = { 0 };
+	SourceLocation locationEnd = locationStart;
 	const AstTypeQualifiers typeQualifiers = Parser_TryParseTypeQualifierList(self, &locationEnd);
-	if (!typeQualifiers)
-	{
-		self->currentTokenIndex = savedTokenIndex;
-		return NULL;
-	}
 
-	return NewWith(AstPointer, Args, typeQualifiers, SourceLocation_Concat(&locationStart, &locationEnd));
+	AstPointer* pointer = Parser_TryParsePointer(self);
+	if (pointer)
+		locationEnd = pointer->location;
+
+	return NewWithIn(self->arena, AstPointer, Args, typeQualifiers, pointer, SourceLocation_Concat(&locationStart, &locationEnd));
 }
 
 AstTypeQualifiers Parser_TryParseTypeQualifierList(Parser* self, SourceLocation*nullable outLocation)
@@ -1167,7 +1277,7 @@ AstTypeName* Parser_TryParseTypeName(Parser* self) // type-name
 
 	// TODO: optional abstract-declarator
 
-	return NewWith(AstTypeName, Args, specifierQualifierList, specifierQualifierList->location);
+	return NewWithIn(self->arena, AstTypeName, Args, specifierQualifierList, specifierQualifierList->location);
 }
 
 AstStatement*nullable Parser_ParseStatement(Parser* self)
@@ -1175,15 +1285,18 @@ AstStatement*nullable Parser_ParseStatement(Parser* self)
 	// TODO: statements other than expression-statements
 	SourceLocation locSemicolon = { 0 };
 	if (Parser_MatchToken(self, TOKEN_PUNCTUATOR_SEMICOLON, &locSemicolon))
-		return NewWith(AstStatement, Expression, NULL, locSemicolon);
+		return NewWithIn(self->arena, AstStatement, Expression, NULL, locSemicolon);
 
 	AstExpression* expr = Parser_ParseExpression(self);
 	if (!expr)
 		return NULL;
 	if (!Parser_MatchToken(self, TOKEN_PUNCTUATOR_SEMICOLON, &locSemicolon))
+	{
 		CompilerErrorList_Append(self->errors, CompilerError_Create("expected ';' at end of expression statement", expr->location));
+		return NewWithIn(self->arena, AstStatement, Expression, expr, expr->location);
+	}
 
-	return NewWith(AstStatement, Expression, expr, SourceLocation_Concat(&expr->location, &locSemicolon));
+	return NewWithIn(self->arena, AstStatement, Expression, expr, SourceLocation_Concat(&expr->location, &locSemicolon));
 }
 
 nullable_end
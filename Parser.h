@@ -1,26 +1,73 @@
 #pragma once
 
 #include "CompilerError.h"
+#include "AstDeclaration.h"
 #include "AstExpression.h"
+#include "AstStatement.h"
 #include "Token.h"
+#include "TokenStream.h"
+#include "TypedefTable.h"
+#include "Util/Arena.h"
 
 nullable_begin
 
+typedef struct Parser_ExpressionFrame Parser_ExpressionFrame;
+typedef struct Parser_ExpressionFrameList Parser_ExpressionFrameList;
+
 typedef struct
 {
-	TokenList* tokens;
+	const SourceFile* source;
+	// Either a fully lexed token list or a stream that lexes tokens on demand
+	TokenList*nullable tokens;
+	const Token_DataList*nullable tokenData;
+	TokenStream*nullable stream;
+	// AST nodes are allocated from this arena and live as long as it does; NULL allocates reference-counted nodes
+	Arena*nullable arena;
+	// Names declared by typedef declarations; needs identifiers lexed with an interner
+	TypedefTable typedefNames;
 	CompilerErrorList* errors;
 	size_t currentTokenIndex;
+	// Explicit stack of the expression parser, kept between expressions; created on first use
+	Parser_ExpressionFrameList*nullable expressionFrames;
+	// Most frames the expression stack has held at once; the nesting depth the parser has needed, which callers may reset
+	size_t maxExpressionFrameCount;
 } Parser;
 
-static Parser Parser_Create(TokenList* tokens, CompilerErrorList* errorList)
+static Parser Parser_Create(const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData, Arena*nullable arena,
+                            CompilerErrorList* errorList)
 {
-	return (Parser) {
+	Parser parser = {
+		.source = source,
 		.tokens = tokens,
+		.tokenData = tokenData,
+		.arena = arena,
 		.errors = errorList,
 	};
+	TypedefTable_Init(&parser.typedefNames);
+	return parser;
+}
+
+static Parser Parser_Create_WithStream(const SourceFile* source, TokenStream* stream, Arena*nullable arena, CompilerErrorList* errorList)
+{
+	Parser parser = {
+		.source = source,
+		.stream = stream,
+		.arena = arena,
+		.errors = errorList,
+	};
+	TypedefTable_Init(&parser.typedefNames);
+	return parser;
+}
+
+static void Parser_Fini(const Parser* self)
+{
+	TypedefTable_Fini(&self->typedefNames);
+	Release(self->expressionFrames);
 }
 
 AstExpression*nullable Parser_ParseExpression(Parser* self);
+// Returns NULL without consuming anything if the next token cannot start a declaration
+AstDeclaration*nullable Parser_TryParseDeclaration(Parser* self);
+AstStatement*nullable Parser_ParseStatement(Parser* self);
 
 nullable_end
@@ -0,0 +1,147 @@
+#include "SourceFile.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "Util/Scan.h"
+
+nullable_begin
+
+// Maps a regular file copy-on-write, so that its pages are shared with the page cache rather than copied. The file is
+// mapped over an anonymous reservation at least SOURCEFILE_ZERO_TAIL_SIZE bytes longer: the kernel zero-fills the end of
+// the file's last page, and the reserved pages after it are zero. The file must not shrink while it is mapped.
+static String*nullable SourceFile_MapContent(SourceFile* self, const char* path)
+{
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return NULL;
+
+	struct stat status;
+	if (fstat(fd, &status) != 0 || !S_ISREG(status.st_mode) || status.st_size == 0)
+	{
+		close(fd);
+		return NULL;
+	}
+
+	const size_t size = (size_t)status.st_size;
+	const size_t pageSize = (size_t)sysconf(_SC_PAGESIZE);
+	const size_t mappingSize = (size + SOURCEFILE_ZERO_TAIL_SIZE + pageSize - 1) / pageSize * pageSize;
+	void* reservation = mmap(NULL, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	void* data = reservation == MAP_FAILED
+		             ? MAP_FAILED
+		             : mmap(reservation, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+	{
+		if (reservation != MAP_FAILED)
+			munmap(reservation, mappingSize);
+		return NULL;
+	}
+
+	self->mapping = data;
+	self->mappingSize = mappingSize;
+	return NewWith(String, BorrowedBuffer, (char*)data, size, mappingSize - 1);
+}
+
+static String*nullable SourceFile_ReadContent(const char* path)
+{
+	String* content = File_ReadAllText(path);
+	if (!content)
+		return NULL;
+
+	// Zero the tail through the string's spare capacity, then shrink back to the content
+	const size_t length = String_Length(content);
+	String_Resize(content, length + SOURCEFILE_ZERO_TAIL_SIZE);
+	memset(String_GetBuffer(content) + length, 0, SOURCEFILE_ZERO_TAIL_SIZE);
+	String_Resize(content, length);
+	return content;
+}
+
+SourceFile* SourceFile_Init_WithPath(SourceFile* self, const char* path)
+{
+	self->path = path;
+	self->lineStarts = NULL;
+	self->mapping = NULL;
+	self->mappingSize = 0;
+	self->content = SourceFile_MapContent(self, path);
+	if (!self->content)
+		self->content = SourceFile_ReadContent(path);
+	return self;
+}
+
+void SourceFile_Fini(SourceFile* self)
+{
+	if (self->content)
+	{
+		Release(self->content);
+		self->content = NULL;
+	}
+
+	if (self->lineStarts)
+	{
+		Release(self->lineStarts);
+		self->lineStarts = NULL;
+	}
+
+	// After the content, which borrows it
+	if (self->mapping)
+	{
+		munmap(self->mapping, self->mappingSize);
+		self->mapping = NULL;
+	}
+}
+
+static SizeList* SourceFile_BuildLineStarts(const SourceFile* self)
+{
+	SizeList* lineStarts = New(SizeList);
+	SizeList_Append(lineStarts, 0);
+
+	if (!self->content)
+		return lineStarts;
+
+	const String* content = (String*)self->content;
+	const char* data = String_AsCString(content);
+	const size_t length = String_Length(content);
+
+	size_t position = 0;
+	while ((position = Scan_FindLineBreak(data, position, length)) < length)
+	{
+		// "\r\n" is a single line break
+		if (data[position] == '\r' && position + 1 < length && data[position + 1] == '\n')
+			position++;
+
+		position++;
+		SizeList_Append(lineStarts, position);
+	}
+
+	return lineStarts;
+}
+
+void SourceFile_GetLineColumn(const SourceFile* self, const size_t offset, size_t* outLine, size_t* outColumn)
+{
+	const SizeList* lineStarts = self->lineStarts;
+	if (!lineStarts)
+	{
+		lineStarts = SourceFile_BuildLineStarts(self);
+		((SourceFile*)self)->lineStarts = (SizeList*)lineStarts;
+	}
+
+	// Find the last line that starts at or before the offset
+	size_t low = 0;
+	size_t high = lineStarts->size;
+	while (high - low > 1)
+	{
+		const size_t mid = low + (high - low) / 2;
+		if (lineStarts->data[mid] <= offset)
+			low = mid;
+		else
+			high = mid;
+	}
+
+	*outLine = low + 1;
+	*outColumn = offset - lineStarts->data[low] + 1;
+}
+
+nullable_end
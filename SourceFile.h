@@ -5,42 +5,36 @@
 
 nullable_begin
 
+// Content loaded from a path is followed by at least this many zero bytes, so that it can be read past its end
+#define SOURCEFILE_ZERO_TAIL_SIZE 64
+
 typedef struct
 {
 	const char* path;
 	String*nullable content;
+	// Offsets at which each line starts, built on first use by SourceFile_GetLineColumn
+	SizeList*nullable lineStarts;
+	// The mapping the content borrows, if the file could be mapped
+	void*nullable mapping;
+	size_t mappingSize;
 } SourceFile;
 
+// Locations only carry byte offsets; line and column are resolved on demand with SourceLocation_GetLineColumn
 typedef struct
 {
 	const SourceFile* sourceFile;
 	ConstCharSpan snippet;
 	size_t offset;
-	size_t line;
-	size_t column;
 } SourceLocation;
 
-static SourceFile* SourceFile_Init_WithPath(SourceFile* self, const char* path)
-{
-	self->path = path;
-	self->content = File_ReadAllText(path);
-	return self;
-}
-
-static void SourceFile_Fini(SourceFile* self)
-{
-	if (self->content)
-	{
-		Release(self->content);
-		self->content = NULL;
-	}
-}
+// Maps a regular file, and reads anything else (a pipe, a terminal) into memory; content is NULL if neither works
+SourceFile* SourceFile_Init_WithPath(SourceFile* self, const char* path);
+void SourceFile_Fini(SourceFile* self);
+void SourceFile_GetLineColumn(const SourceFile* self, size_t offset, size_t* outLine, size_t* outColumn);
 
 static SourceLocation SourceLocation_Create(const SourceFile* sourceFile,
                                             const size_t offset,
-                                            const size_t length,
-                                            const size_t line,
-                                            const size_t column)
+                                            const size_t length)
 {
 	const ConstCharSpan snippet = sourceFile->content
 		                              ? ConstCharSpan_SubSpan(String_AsConstCharSpan((String*)sourceFile->content), offset, length)
@@ -49,8 +43,6 @@ static SourceLocation SourceLocation_Create(const SourceFile* sourceFile,
 		.sourceFile = sourceFile,
 		.snippet = snippet,
 		.offset = offset,
-		.line = line,
-		.column = column,
 	};
 }
 
@@ -67,9 +59,13 @@ static SourceLocation SourceLocation_Concat(const SourceLocation* first, const S
 	return (SourceLocation) {
 		.sourceFile = first->sourceFile,
 		.snippet = snippet,
-		.line = first->line,
-		.column = first->column,
+		.offset = first->offset,
 	};
 }
 
+static void SourceLocation_GetLineColumn(const SourceLocation* self, size_t* outLine, size_t* outColumn)
+{
+	SourceFile_GetLineColumn(self->sourceFile, self->offset, outLine, outColumn);
+}
+
 nullable_end
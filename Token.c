@@ -1,13 +1,184 @@
 #include "Token.h"
 
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
 #include "Lexer.h"
 #include "Util/Managed.h"
 
 nullable_begin
 
-String* Token_LiteralString_GetValue(const Token* token)
+// Perfect hash over keywords[], keyed on the length and the first, second and last character.
+// The multipliers were chosen so that every keyword lands in its own slot; Token_BuildKeywordHashTable aborts otherwise.
+#define KEYWORD_HASH_TABLE_SIZE 128
+
+typedef struct
+{
+	const char*nullable str;
+	size_t length;
+	Token_Type type;
+} KeywordHashEntry;
+
+static KeywordHashEntry keywordHashTable[KEYWORD_HASH_TABLE_SIZE];
+static size_t keywordMinLength = SIZE_MAX;
+static size_t keywordMaxLength = 0;
+
+static size_t Token_KeywordHash(const char* str, const size_t length)
+{
+	const size_t first = (unsigned char)str[0];
+	const size_t second = (unsigned char)str[1];
+	const size_t last = (unsigned char)str[length - 1];
+	return (length * 7 + first * 2 + second + last * 9) & (KEYWORD_HASH_TABLE_SIZE - 1);
+}
+
+__attribute__((constructor))
+static void Token_BuildKeywordHashTable(void)
+{
+	for (size_t i = 0; i < sizeof(keywords) / sizeof(TokenStringMapEntry); i++)
+	{
+		const TokenStringMapEntry* entry = &keywords[i];
+		const size_t length = strlen(entry->str);
+
+		KeywordHashEntry* slot = &keywordHashTable[Token_KeywordHash(entry->str, length)];
+		if (slot->str != NULL)
+		{
+			fprintf(stderr, "Keyword hash collision between '%s' and '%s'\n", slot->str, entry->str);
+			abort();
+		}
+
+		*slot = (KeywordHashEntry) { entry->str, length, entry->type };
+
+		if (length < keywordMinLength)
+			keywordMinLength = length;
+		if (length > keywordMaxLength)
+			keywordMaxLength = length;
+	}
+}
+
+Token_Type Token_LookupKeyword(const ConstCharSpan lexeme)
 {
-	const ConstCharSpan lexeme = token->location.snippet;
+	if (lexeme.length < keywordMinLength || lexeme.length > keywordMaxLength)
+		return TOKEN_IDENTIFIER;
+
+	const KeywordHashEntry* slot = &keywordHashTable[Token_KeywordHash(lexeme.data, lexeme.length)];
+	if (slot->length == lexeme.length && memcmp(slot->str, lexeme.data, lexeme.length) == 0)
+		return slot->type;
+
+	return TOKEN_IDENTIFIER;
+}
+
+// Punctuator trie built from punctuators[]: the first character is dispatched through a 256-entry table,
+// the (at most two) following characters are matched against the few continuations of that prefix.
+#define PUNCTUATOR_TRIE_MAX_NODES 64
+#define PUNCTUATOR_TRIE_MAX_CHILDREN 4
+#define PUNCTUATOR_MAX_LENGTH 3
+
+typedef struct
+{
+	Token_Type type; // TOKEN_UNEXPECTED if the prefix is not a punctuator by itself
+	size_t childCount;
+	char childChars[PUNCTUATOR_TRIE_MAX_CHILDREN];
+	uint8_t children[PUNCTUATOR_TRIE_MAX_CHILDREN];
+} PunctuatorTrieNode;
+
+static PunctuatorTrieNode punctuatorTrieNodes[PUNCTUATOR_TRIE_MAX_NODES];
+static size_t punctuatorTrieNodeCount = 1; // Node 0 means "no node"
+static uint8_t punctuatorTrieRoots[256];
+
+static uint8_t Token_NewPunctuatorTrieNode(void)
+{
+	if (punctuatorTrieNodeCount >= PUNCTUATOR_TRIE_MAX_NODES)
+	{
+		fprintf(stderr, "Too many punctuator trie nodes\n");
+		abort();
+	}
+
+	const uint8_t index = (uint8_t)punctuatorTrieNodeCount++;
+	punctuatorTrieNodes[index] = (PunctuatorTrieNode) { .type = TOKEN_UNEXPECTED };
+	return index;
+}
+
+__attribute__((constructor))
+static void Token_BuildPunctuatorTrie(void)
+{
+	for (size_t i = 0; i < sizeof(punctuators) / sizeof(TokenStringMapEntry); i++)
+	{
+		const TokenStringMapEntry* entry = &punctuators[i];
+		const size_t length = strlen(entry->str);
+		assert(length >= 1 && length <= PUNCTUATOR_MAX_LENGTH);
+
+		uint8_t* root = &punctuatorTrieRoots[(unsigned char)entry->str[0]];
+		if (*root == 0)
+			*root = Token_NewPunctuatorTrieNode();
+
+		uint8_t nodeIndex = *root;
+		for (size_t k = 1; k < length; k++)
+		{
+			PunctuatorTrieNode* node = &punctuatorTrieNodes[nodeIndex];
+
+			uint8_t childIndex = 0;
+			for (size_t j = 0; j < node->childCount; j++)
+			{
+				if (node->childChars[j] == entry->str[k])
+					childIndex = node->children[j];
+			}
+
+			if (childIndex == 0)
+			{
+				if (node->childCount >= PUNCTUATOR_TRIE_MAX_CHILDREN)
+				{
+					fprintf(stderr, "Too many continuations of punctuator prefix '%.*s'\n", (int)k, entry->str);
+					abort();
+				}
+
+				childIndex = Token_NewPunctuatorTrieNode();
+				node = &punctuatorTrieNodes[nodeIndex];
+				node->childChars[node->childCount] = entry->str[k];
+				node->children[node->childCount] = childIndex;
+				node->childCount++;
+			}
+
+			nodeIndex = childIndex;
+		}
+
+		punctuatorTrieNodes[nodeIndex].type = entry->type;
+	}
+}
+
+size_t Token_MatchPunctuator(const char str[3], Token_Type* outType)
+{
+	size_t matchLength = 0;
+
+	uint8_t nodeIndex = punctuatorTrieRoots[(unsigned char)str[0]];
+	for (size_t depth = 0; nodeIndex != 0; depth++)
+	{
+		const PunctuatorTrieNode* node = &punctuatorTrieNodes[nodeIndex];
+
+		// Longest match wins
+		if (node->type != TOKEN_UNEXPECTED)
+		{
+			*outType = node->type;
+			matchLength = depth + 1;
+		}
+
+		if (depth + 1 == PUNCTUATOR_MAX_LENGTH)
+			break;
+
+		nodeIndex = 0;
+		for (size_t j = 0; j < node->childCount; j++)
+		{
+			if (node->childChars[j] == str[depth + 1])
+				nodeIndex = node->children[j];
+		}
+	}
+
+	return matchLength;
+}
+
+String* Token_LiteralString_GetValue(const Token* token, const SourceFile* source)
+{
+	const ConstCharSpan lexeme = Token_GetLexeme(token, source);
 
 	assert(lexeme.data[0] == '\"');
 	assert(lexeme.data[lexeme.length - 1] == '\"');
@@ -157,99 +328,177 @@ String* Token_LiteralString_GetValue(const Token* token)
 	return str;
 }
 
-void Token_Print(const Token* token)
+// Writes span the way "%.*s" prints it, which stops at the first NUL byte
+static void Token_WriteSpan(Writer* output, const ConstCharSpan span)
+{
+	const char* nul = memchr(span.data, '\0', span.length);
+	Writer_Write(output, span.data, nul ? (size_t)(nul - span.data) : span.length);
+}
+
+static const char* Token_LiteralIntegerType_ToString(const Token_LiteralInteger_Type type)
+{
+	switch (type)
+	{
+		case TOKEN_LITERAL_INTEGER_TYPE_INT:
+			return "int";
+		case TOKEN_LITERAL_INTEGER_TYPE_LONG:
+			return "long";
+		case TOKEN_LITERAL_INTEGER_TYPE_LONGLONG:
+			return "long long";
+		case TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDINT:
+			return "unsigned int";
+		case TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONG:
+			return "unsigned long";
+		case TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONGLONG:
+			return "unsigned long long";
+		default:
+			assert(false && "unreachable");
+			return "";
+	}
+}
+
+static const char* Token_LiteralFloatType_ToString(const Token_LiteralFloat_Type type)
+{
+	switch (type)
+	{
+		case TOKEN_LITERAL_FLOAT_TYPE_DOUBLE:
+			return "double";
+		case TOKEN_LITERAL_FLOAT_TYPE_FLOAT:
+			return "float";
+		case TOKEN_LITERAL_FLOAT_TYPE_LONGDOUBLE:
+			return "long double";
+		case TOKEN_LITERAL_FLOAT_TYPE_BINARY16:
+			return "binary16";
+		case TOKEN_LITERAL_FLOAT_TYPE_BINARY32:
+			return "binary32";
+		case TOKEN_LITERAL_FLOAT_TYPE_BINARY64:
+			return "binary64";
+		case TOKEN_LITERAL_FLOAT_TYPE_DECIMAL32:
+			return "decimal32";
+		case TOKEN_LITERAL_FLOAT_TYPE_DECIMAL64:
+			return "decimal64";
+		case TOKEN_LITERAL_FLOAT_TYPE_DECIMAL128:
+			return "decimal128";
+		default:
+			assert(false && "unreachable");
+			return "";
+	}
+}
+
+void Token_Print(const Token* token, const SourceFile* source, const Token_DataList* tokenData)
 {
+	size_t line, column;
+	SourceFile_GetLineColumn(source, token->offset, &line, &column);
+
+	const ConstCharSpan lexeme = Token_GetLexeme(token, source);
 	printf("%s: Lexeme='%.*s', Line=%zu, Column=%zu\n",
 	       Token_Type_ToString(token->type),
-	       Span_AsFormat(&token->location.snippet),
-	       token->location.line,
-	       token->location.column);
+	       Span_AsFormat(&lexeme),
+	       line,
+	       column);
 
 	if (token->type == TOKEN_LITERAL_STRING)
 	{
-		using const String* value = Token_LiteralString_GetValue(token);
+		using const String* value = Token_LiteralString_GetValue(token, source);
 		printf("  -> Value: '%s'\n", String_AsCString(value));
 	}
 	else if (token->type == TOKEN_LITERAL_INTEGER)
 	{
-		printf("  -> Value: '%.*s'\n", Span_AsFormat(&token->data.literalInteger.value));
-		printf("  -> Base: %zu\n", token->data.literalInteger.base);
-		printf("  -> Type: ");
-		switch (token->data.literalInteger.type)
-		{
-			case TOKEN_LITERAL_INTEGER_TYPE_INT:
-				printf("int\n");
-				break;
-			case TOKEN_LITERAL_INTEGER_TYPE_LONG:
-				printf("long\n");
-				break;
-			case TOKEN_LITERAL_INTEGER_TYPE_LONGLONG:
-				printf("long long\n");
-				break;
-			case TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDINT:
-				printf("unsigned int\n");
-				break;
-			case TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONG:
-				printf("unsigned long\n");
-				break;
-			case TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONGLONG:
-				printf("unsigned long long\n");
-				break;
-			default:
-				assert(false && "unreachable");
-		}
+		const Token_LiteralInteger* literal = &Token_GetData(token, tokenData)->literalInteger;
+		printf("  -> Value: '%.*s'\n", Span_AsFormat(&literal->value));
+		printf("  -> Decoded: %" PRIu64 "\n", literal->decoded);
+		printf("  -> Base: %zu\n", literal->base);
+		printf("  -> Type: %s\n", Token_LiteralIntegerType_ToString(literal->type));
 	}
 	else if (token->type == TOKEN_LITERAL_FLOAT)
 	{
-		printf("  -> Hexadecimal: %s\n", token->data.literalDecimalFloat.isHex ? "true" : "false");
+		const Token_LiteralFloat* literal = &Token_GetData(token, tokenData)->literalDecimalFloat;
+		printf("  -> Hexadecimal: %s\n", literal->isHex ? "true" : "false");
 
-		if (token->data.literalDecimalFloat.hasIntegerPart)
-			printf("  -> Integer Part: %.*s\n", Span_AsFormat(&token->data.literalDecimalFloat.integerPart));
+		if (literal->hasIntegerPart)
+			printf("  -> Integer Part: %.*s\n", Span_AsFormat(&literal->integerPart));
 		else
 			printf("  -> Integer Part: <none>\n");
-		if (token->data.literalDecimalFloat.hasFractionalPart)
-			printf("  -> Fractional Part: %.*s\n", Span_AsFormat(&token->data.literalDecimalFloat.fractionalPart));
+		if (literal->hasFractionalPart)
+			printf("  -> Fractional Part: %.*s\n", Span_AsFormat(&literal->fractionalPart));
 		else
 			printf("  -> Fractional Part: <none>\n");
-		if (token->data.literalDecimalFloat.hasExponent)
-			printf("  -> Exponent Part: %c%.*s\n", token->data.literalDecimalFloat.exponentIsNegative ? '-' : '+',
-			       Span_AsFormat(&token->data.literalDecimalFloat.exponentPart));
+		if (literal->hasExponent)
+			printf("  -> Exponent Part: %c%.*s\n", literal->exponentIsNegative ? '-' : '+',
+			       Span_AsFormat(&literal->exponentPart));
 		else
 			printf("  -> Exponent Part: <none>\n");
+		printf("  -> Decoded: %.17g\n", literal->decoded);
+		printf("  -> Type: %s\n", Token_LiteralFloatType_ToString(literal->type));
+	}
+}
+
+void Token_Write(const Token* token, const SourceFile* source, const Token_DataList* tokenData, Writer* output)
+{
+	size_t line, column;
+	SourceFile_GetLineColumn(source, token->offset, &line, &column);
+
+	Writer_WriteCString(output, Token_Type_ToString(token->type));
+	Writer_WriteCString(output, ": Lexeme='");
+	Token_WriteSpan(output, Token_GetLexeme(token, source));
+	Writer_WriteCString(output, "', Line=");
+	Writer_WriteUInt(output, line);
+	Writer_WriteCString(output, ", Column=");
+	Writer_WriteUInt(output, column);
+	Writer_WriteChar(output, '\n');
 
-		printf("  -> Type: ");
-		switch (token->data.literalDecimalFloat.type)
+	if (token->type == TOKEN_LITERAL_STRING)
+	{
+		using const String* value = Token_LiteralString_GetValue(token, source);
+		Writer_WriteCString(output, "  -> Value: '");
+		Writer_WriteCString(output, String_AsCString(value));
+		Writer_WriteCString(output, "'\n");
+	}
+	else if (token->type == TOKEN_LITERAL_INTEGER)
+	{
+		const Token_LiteralInteger* literal = &Token_GetData(token, tokenData)->literalInteger;
+		Writer_WriteCString(output, "  -> Value: '");
+		Token_WriteSpan(output, literal->value);
+		Writer_WriteCString(output, "'\n  -> Decoded: ");
+		Writer_WriteUInt(output, literal->decoded);
+		Writer_WriteCString(output, "\n  -> Base: ");
+		Writer_WriteUInt(output, literal->base);
+		Writer_WriteCString(output, "\n  -> Type: ");
+		Writer_WriteCString(output, Token_LiteralIntegerType_ToString(literal->type));
+		Writer_WriteChar(output, '\n');
+	}
+	else if (token->type == TOKEN_LITERAL_FLOAT)
+	{
+		const Token_LiteralFloat* literal = &Token_GetData(token, tokenData)->literalDecimalFloat;
+		Writer_WriteCString(output, literal->isHex ? "  -> Hexadecimal: true\n" : "  -> Hexadecimal: false\n");
+
+		Writer_WriteCString(output, "  -> Integer Part: ");
+		if (literal->hasIntegerPart)
+			Token_WriteSpan(output, literal->integerPart);
+		else
+			Writer_WriteCString(output, "<none>");
+		Writer_WriteCString(output, "\n  -> Fractional Part: ");
+		if (literal->hasFractionalPart)
+			Token_WriteSpan(output, literal->fractionalPart);
+		else
+			Writer_WriteCString(output, "<none>");
+		Writer_WriteCString(output, "\n  -> Exponent Part: ");
+		if (literal->hasExponent)
 		{
-			case TOKEN_LITERAL_FLOAT_TYPE_DOUBLE:
-				printf("double\n");
-				break;
-			case TOKEN_LITERAL_FLOAT_TYPE_FLOAT:
-				printf("float\n");
-				break;
-			case TOKEN_LITERAL_FLOAT_TYPE_LONGDOUBLE:
-				printf("long double\n");
-				break;
-			case TOKEN_LITERAL_FLOAT_TYPE_BINARY16:
-				printf("binary16\n");
-				break;
-			case TOKEN_LITERAL_FLOAT_TYPE_BINARY32:
-				printf("binary32\n");
-				break;
-			case TOKEN_LITERAL_FLOAT_TYPE_BINARY64:
-				printf("binary64\n");
-				break;
-			case TOKEN_LITERAL_FLOAT_TYPE_DECIMAL32:
-				printf("decimal32\n");
-				break;
-			case TOKEN_LITERAL_FLOAT_TYPE_DECIMAL64:
-				printf("decimal64\n");
-				break;
-			case TOKEN_LITERAL_FLOAT_TYPE_DECIMAL128:
-				printf("decimal128\n");
-				break;
-			default:
-				assert(false && "unreachable");
+			Writer_WriteChar(output, literal->exponentIsNegative ? '-' : '+');
+			Token_WriteSpan(output, literal->exponentPart);
 		}
+		else
+			Writer_WriteCString(output, "<none>");
+
+		// Shortest round-trip formatting by hand would not match printf digit for digit
+		char buffer[32];
+		const int length = snprintf(buffer, sizeof(buffer), "%.17g", literal->decoded);
+		Writer_WriteCString(output, "\n  -> Decoded: ");
+		Writer_Write(output, buffer, (size_t)length);
+		Writer_WriteCString(output, "\n  -> Type: ");
+		Writer_WriteCString(output, Token_LiteralFloatType_ToString(literal->type));
+		Writer_WriteChar(output, '\n');
 	}
 }
 
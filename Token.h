@@ -1,6 +1,9 @@
 #pragma once
+#include <assert.h>
+
 #include "SourceFile.h"
 #include "Util/Span.h"
+#include "Util/Writer.h"
 
 nullable_begin
 
@@ -298,6 +301,8 @@ typedef struct
 	ConstCharSpan value;
 	size_t base;
 	Token_LiteralInteger_Type type;
+	// Value decoded by the lexer (truncated if it does not fit in 64 bits, which is reported as an error)
+	uint64_t decoded;
 } Token_LiteralInteger;
 
 typedef struct
@@ -315,43 +320,89 @@ typedef struct
 	ConstCharSpan exponentPart;
 
 	Token_LiteralFloat_Type type;
+	// Value decoded by the lexer, correctly rounded to double regardless of the literal's type
+	double decoded;
 } Token_LiteralFloat;
 
-typedef struct
-{
-	ConstCharSpan value;
-} Token_LiteralIdentifier;
-
 typedef union
 {
 	Token_LiteralInteger literalInteger;
 	Token_LiteralFloat literalDecimalFloat;
-	Token_LiteralIdentifier literalIdentifier;
 } Token_Data;
 
+#define TOKEN_NO_DATA UINT32_MAX
+
+// Compact token: the lexeme is derived from the offset and length within the source file,
+// literal payloads live in a side table (Token_DataList) referenced by dataIndex.
 typedef struct
 {
-	Token_Type type;
-	SourceLocation location;
-	Token_Data data;
+	uint32_t offset;
+	uint32_t length;
+	union
+	{
+		// Literals: index of the payload, or TOKEN_NO_DATA
+		uint32_t dataIndex;
+		// Identifiers: interned symbol ID, or INTERNER_NO_SYMBOL
+		uint32_t symbol;
+	};
+	uint8_t type;
 } Token;
 
-static Token Token_Create(const Token_Type type, const SourceLocation location, const Token_Data data)
+static_assert(TOKEN_MAX <= UINT8_MAX, "Token_Type must fit into Token.type");
+static_assert(sizeof(Token) == 16, "Token must stay 16 bytes");
+
+static Token Token_Create(const Token_Type type, const size_t offset, const size_t length, const uint32_t dataIndex)
 {
 	return (Token) {
-		.type = type,
-		.location = location,
-		.data = data,
+		.offset = (uint32_t)offset,
+		.length = (uint32_t)length,
+		.dataIndex = dataIndex,
+		.type = (uint8_t)type,
 	};
 }
 
-void Token_Print(const Token* token);
-String* Token_LiteralString_GetValue(const Token* token);
+static bool Token_HasData(const Token* token)
+{
+	return token->type != TOKEN_IDENTIFIER && token->dataIndex != TOKEN_NO_DATA;
+}
+
+static SourceLocation Token_GetLocation(const Token* token, const SourceFile* source)
+{
+	return SourceLocation_Create(source, token->offset, token->length);
+}
+
+static ConstCharSpan Token_GetLexeme(const Token* token, const SourceFile* source)
+{
+	return ConstCharSpan_SubSpan(String_AsConstCharSpan((String*)source->content), token->offset, token->length);
+}
 
 nullable_end
 
+#define LIST_TYPE Token_DataList
+#define LIST_ELEMENT_TYPE Token_Data
+#include "Util/ListDef.h"
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
 #define LIST_TYPE TokenList
 #define LIST_ELEMENT_TYPE Token
 #include "Util/ListDef.h"
 #undef LIST_TYPE
 #undef LIST_ELEMENT_TYPE
+
+nullable_begin
+
+static const Token_Data* Token_GetData(const Token* token, const Token_DataList* tokenData)
+{
+	assert(Token_HasData(token) && token->dataIndex < tokenData->size);
+	return &tokenData->data[token->dataIndex];
+}
+
+void Token_Print(const Token* token, const SourceFile* source, const Token_DataList* tokenData);
+// Writes what Token_Print prints, byte for byte, without going through stdio
+void Token_Write(const Token* token, const SourceFile* source, const Token_DataList* tokenData, Writer* output);
+String* Token_LiteralString_GetValue(const Token* token, const SourceFile* source);
+Token_Type Token_LookupKeyword(ConstCharSpan lexeme);
+size_t Token_MatchPunctuator(const char str[3], Token_Type* outType);
+
+nullable_end
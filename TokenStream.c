@@ -0,0 +1,111 @@
+#include "TokenStream.h"
+
+#include "Util/Managed.h"
+
+nullable_begin
+
+#define TOKEN_STREAM_INITIAL_CAPACITY 64
+
+static void TokenStream_Grow(TokenStream* self);
+static void TokenStream_Pull(TokenStream* self, size_t keepFrom);
+
+TokenStream* TokenStream_Init_WithSource(TokenStream* self, const SourceFile* source, Interner*nullable interner, CompilerErrorList* errorList)
+{
+	self->lexerTokenData = New(Token_DataList);
+	self->lexer = Lexer_Create(source, self->lexerTokenData, interner, errorList);
+
+	self->capacity = TOKEN_STREAM_INITIAL_CAPACITY;
+	self->tokens = (Token*)malloc(sizeof(Token) * self->capacity);
+	self->tokenData = (Token_Data*)malloc(sizeof(Token_Data) * self->capacity);
+	if (self->tokens == NULL || self->tokenData == NULL)
+		abort();
+
+	self->start = 0;
+	self->end = 0;
+	self->reachedEof = false;
+	return self;
+}
+
+void TokenStream_Fini(const TokenStream* self)
+{
+	Release(self->lexerTokenData);
+	free(self->tokens);
+	free(self->tokenData);
+}
+
+Token TokenStream_Get(TokenStream* self, const size_t index, const size_t keepFrom)
+{
+	assert(index >= self->start && keepFrom <= index);
+
+	while (index >= self->end && !self->reachedEof)
+		TokenStream_Pull(self, keepFrom);
+
+	// Past the end, keep returning the EOF token
+	const size_t available = index < self->end ? index : self->end - 1;
+	return self->tokens[available & (self->capacity - 1)];
+}
+
+const Token_Data* TokenStream_GetData(const TokenStream* self, const Token* token)
+{
+	assert(Token_HasData(token) && token->dataIndex < self->capacity);
+	return &self->tokenData[token->dataIndex];
+}
+
+void TokenStream_Pull(TokenStream* self, const size_t keepFrom)
+{
+	if (self->end - self->start == self->capacity)
+	{
+		// Recycle the oldest slot unless it is still needed (e.g. by a parser checkpoint)
+		if (self->start < keepFrom)
+			self->start++;
+		else
+			TokenStream_Grow(self);
+	}
+
+	Token token = Lexer_GetNextToken(&self->lexer, false, false);
+
+	const size_t slot = self->end & (self->capacity - 1);
+	if (Token_HasData(&token))
+	{
+		self->tokenData[slot] = self->lexerTokenData->data[token.dataIndex];
+		self->lexerTokenData->size = 0;
+		token.dataIndex = (uint32_t)slot;
+	}
+
+	self->tokens[slot] = token;
+	self->end++;
+
+	if (token.type == TOKEN_EOF)
+		self->reachedEof = true;
+}
+
+void TokenStream_Grow(TokenStream* self)
+{
+	const size_t newCapacity = self->capacity * 2;
+
+	Token* newTokens = (Token*)malloc(sizeof(Token) * newCapacity);
+	Token_Data* newTokenData = (Token_Data*)malloc(sizeof(Token_Data) * newCapacity);
+	if (newTokens == NULL || newTokenData == NULL)
+		abort();
+
+	for (size_t i = self->start; i < self->end; i++)
+	{
+		const size_t oldSlot = i & (self->capacity - 1);
+		const size_t newSlot = i & (newCapacity - 1);
+
+		newTokens[newSlot] = self->tokens[oldSlot];
+		if (Token_HasData(&newTokens[newSlot]))
+		{
+			newTokenData[newSlot] = self->tokenData[oldSlot];
+			newTokens[newSlot].dataIndex = (uint32_t)newSlot;
+		}
+	}
+
+	free(self->tokens);
+	free(self->tokenData);
+	self->tokens = newTokens;
+	self->tokenData = newTokenData;
+	self->capacity = newCapacity;
+}
+
+nullable_end
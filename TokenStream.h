@@ -0,0 +1,35 @@
+#pragma once
+
+#include "CompilerError.h"
+#include "Lexer.h"
+#include "Token.h"
+
+nullable_begin
+
+// Pulls tokens from a Lexer on demand and keeps only a window of them in a ring buffer.
+// Tokens are addressed by their absolute index in the token sequence; tokens before the index
+// the caller asks to keep are recycled, so memory does not grow with the size of the input.
+typedef struct
+{
+	Lexer lexer;
+	// Scratch payload table for the lexer, emptied after every token
+	Token_DataList* lexerTokenData;
+
+	Token* tokens;
+	// Payloads of buffered tokens; a buffered token's dataIndex is the ring slot of its payload
+	Token_Data* tokenData;
+	size_t capacity; // Power of two
+	size_t start; // Absolute index of the oldest buffered token
+	size_t end; // Absolute index one past the newest buffered token
+	bool reachedEof;
+} TokenStream;
+
+TokenStream* TokenStream_Init_WithSource(TokenStream* self, const SourceFile* source, Interner*nullable interner, CompilerErrorList* errorList);
+void TokenStream_Fini(const TokenStream* self);
+
+// Returns the token at the given absolute index (or EOF past the end), lexing ahead as needed.
+// Tokens before keepFrom may be dropped from the buffer and must not be requested again.
+Token TokenStream_Get(TokenStream* self, size_t index, size_t keepFrom);
+const Token_Data* TokenStream_GetData(const TokenStream* self, const Token* token);
+
+nullable_end
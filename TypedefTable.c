@@ -0,0 +1,66 @@
+#include "TypedefTable.h"
+
+#include <string.h>
+
+#include "Util/Interner.h"
+
+nullable_begin
+
+TypedefTable* TypedefTable_Init(TypedefTable* self)
+{
+	UInt8List_Init(&self->isTypedefName);
+	UInt32List_Init(&self->declared);
+	self->isRecording = false;
+	return self;
+}
+
+void TypedefTable_Fini(const TypedefTable* self)
+{
+	UInt8List_Fini(&self->isTypedefName);
+	UInt32List_Fini(&self->declared);
+}
+
+void TypedefTable_CopyFileScope(TypedefTable* self, const TypedefTable* source)
+{
+	if (!UInt8List_Resize(&self->isTypedefName, source->isTypedefName.size))
+		abort();
+	memcpy(self->isTypedefName.data, source->isTypedefName.data, source->isTypedefName.size);
+}
+
+void TypedefTable_StartRecording(TypedefTable* self)
+{
+	self->declared.size = 0;
+	self->isRecording = true;
+}
+
+void TypedefTable_Declare(TypedefTable* self, const uint32_t symbol, const bool isTypedefName)
+{
+	// Identifiers lexed without an interner cannot be tracked
+	if (symbol == INTERNER_NO_SYMBOL)
+		return;
+
+	if (symbol >= self->isTypedefName.size)
+	{
+		if (!isTypedefName)
+			return;
+
+		// Grow geometrically, but only when the symbol does not fit the capacity already reserved
+		const size_t oldSize = self->isTypedefName.size;
+		if (symbol >= self->isTypedefName.capacity)
+		{
+			const size_t grown = self->isTypedefName.capacity * 2;
+			if (!UInt8List_Reserve(&self->isTypedefName, grown > symbol ? grown : (size_t)symbol + 1))
+				abort();
+		}
+		if (!UInt8List_Resize(&self->isTypedefName, (size_t)symbol + 1))
+			abort();
+		memset(self->isTypedefName.data + oldSize, 0, self->isTypedefName.size - oldSize);
+	}
+
+	if (self->isRecording)
+		UInt32List_AppendFromPtr(&self->declared, &symbol);
+
+	self->isTypedefName.data[symbol] = isTypedefName;
+}
+
+nullable_end
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Util/List.h"
+#include "Util/Macros.h"
+
+nullable_begin
+
+// Tracks which interned identifiers currently name a typedef, so the parser can tell type names from expressions
+// by looking at a single token.
+typedef struct
+{
+	// Indexed by symbol; nonzero while the symbol names a typedef
+	UInt8List isTypedefName;
+	// Symbols declared since recording started, in declaration order
+	UInt32List declared;
+	bool isRecording;
+} TypedefTable;
+
+TypedefTable* TypedefTable_Init(TypedefTable* self);
+void TypedefTable_Fini(const TypedefTable* self);
+
+// Replaces the typedef names of self with those of source
+void TypedefTable_CopyFileScope(TypedefTable* self, const TypedefTable* source);
+
+// Appends the symbol of every later declaration to declared, so that callers can find out what a parse declared
+void TypedefTable_StartRecording(TypedefTable* self);
+// Declares symbol, either as a typedef name or as an ordinary identifier
+void TypedefTable_Declare(TypedefTable* self, uint32_t symbol, bool isTypedefName);
+
+static bool TypedefTable_IsTypedefName(const TypedefTable* self, const uint32_t symbol)
+{
+	return symbol < self->isTypedefName.size && self->isTypedefName.data[symbol];
+}
+
+nullable_end
@@ -0,0 +1,103 @@
+#include "Arena.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+nullable_begin
+
+struct ArenaBlock
+{
+	ArenaBlock*nullable next;
+	size_t size;
+	alignas(max_align_t) char data[];
+};
+
+struct ArenaCleanup
+{
+	ArenaCleanup*nullable next;
+	void (*function)(void*);
+	void* object;
+};
+
+static ArenaBlock* Arena_AddBlock(Arena* self, size_t size);
+
+Arena* Arena_Init(Arena* self)
+{
+	return Arena_Init_WithBlockSize(self, ARENA_DEFAULT_BLOCK_SIZE);
+}
+
+Arena* Arena_Init_WithBlockSize(Arena* self, const size_t blockSize)
+{
+	*self = (Arena) { .blockSize = blockSize };
+	return self;
+}
+
+void Arena_Fini(const Arena* self)
+{
+	for (const ArenaCleanup* cleanup = self->cleanups; cleanup; cleanup = cleanup->next)
+		cleanup->function(cleanup->object);
+
+	ArenaBlock* block = self->blocks;
+	while (block)
+	{
+		ArenaBlock* next = block->next;
+		free(block);
+		block = next;
+	}
+}
+
+void* Arena_Allocate(Arena* self, const size_t size, const size_t alignment)
+{
+	assert(alignment != 0 && (alignment & (alignment - 1)) == 0 && alignment <= alignof(max_align_t));
+
+	if (self->position)
+	{
+		char* aligned = (char*)(((uintptr_t)self->position + alignment - 1) & ~(uintptr_t)(alignment - 1));
+		if (aligned <= self->end && size <= (size_t)(self->end - aligned))
+		{
+			self->position = aligned + size;
+			return aligned;
+		}
+	}
+
+	// Allocations too large to share a block get a block of their own, so the current one stays in use
+	if (size > self->blockSize / 4)
+		return Arena_AddBlock(self, size)->data;
+
+	ArenaBlock* block = Arena_AddBlock(self, self->blockSize);
+	self->position = block->data + size;
+	self->end = block->data + block->size;
+	return block->data;
+}
+
+void Arena_AddCleanup(Arena* self, void (*function)(void*), void* object)
+{
+	ArenaCleanup* cleanup = (ArenaCleanup*)Arena_Allocate(self, sizeof(ArenaCleanup), alignof(ArenaCleanup));
+	*cleanup = (ArenaCleanup) { .next = self->cleanups, .function = function, .object = object };
+	self->cleanups = cleanup;
+}
+
+size_t Arena_GetMemoryUsage(const Arena* self)
+{
+	size_t usage = 0;
+	for (const ArenaBlock* block = self->blocks; block; block = block->next)
+		usage += sizeof(ArenaBlock) + block->size;
+	return usage;
+}
+
+ArenaBlock* Arena_AddBlock(Arena* self, const size_t size)
+{
+	ArenaBlock* block = (ArenaBlock*)malloc(sizeof(ArenaBlock) + size);
+	if (block == NULL)
+		abort();
+
+	block->size = size;
+	block->next = self->blocks;
+	self->blocks = block;
+	self->blockCount++;
+	return block;
+}
+
+nullable_end
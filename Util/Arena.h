@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "Macros.h"
+
+nullable_begin
+
+#define ARENA_DEFAULT_BLOCK_SIZE (64 * 1024)
+
+typedef struct ArenaBlock ArenaBlock;
+typedef struct ArenaCleanup ArenaCleanup;
+
+// Bump allocator: memory is handed out from large blocks and only given back all at once by Arena_Fini
+typedef struct Arena
+{
+	ArenaBlock*nullable blocks;
+	// Free space in the block currently bumped from
+	char*nullable position;
+	char*nullable end;
+	ArenaCleanup*nullable cleanups;
+	size_t blockSize;
+	size_t blockCount;
+} Arena;
+
+Arena* Arena_Init(Arena* self);
+Arena* Arena_Init_WithBlockSize(Arena* self, size_t blockSize);
+void Arena_Fini(const Arena* self);
+
+// Returns uninitialized memory aligned to alignment (a power of two no larger than alignof(max_align_t))
+void* Arena_Allocate(Arena* self, size_t size, size_t alignment);
+// Calls function(object) when the arena is destroyed, in reverse order of registration
+void Arena_AddCleanup(Arena* self, void (*function)(void*), void* object);
+// Memory reserved from the system, in bytes
+size_t Arena_GetMemoryUsage(const Arena* self);
+
+nullable_end
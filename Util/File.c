@@ -6,13 +6,11 @@
 
 nullable_begin
 
+#define FILE_READ_CHUNK_SIZE (64 * 1024)
+
 FileHandle* FileHandle_Init_WithArgs(FileHandle* self, const char* path, const char* mode)
 {
-	FILE* file = fopen(path, mode);
-	if (!file)
-		return self;
-
-	self->file = file;
+	self->file = fopen(path, mode);
 	return self;
 }
 
@@ -25,6 +23,16 @@ void FileHandle_Fini(FileHandle* handle)
 	}
 }
 
+bool FileHandle_Close(FileHandle* handle)
+{
+	if (handle->file == NULL)
+		return false;
+
+	const bool isClosed = fclose(handle->file) == 0;
+	handle->file = NULL;
+	return isClosed;
+}
+
 void FileHandle_SetPos(const FileHandle* handle, const size_t pos)
 {
 	fseek(handle->file, (long)pos, SEEK_SET);
@@ -44,28 +52,36 @@ size_t FileHandle_GetSize(const FileHandle* handle)
 	return (size_t)size;
 }
 
-void FileHandle_Read(const FileHandle* handle, void* buffer, const size_t size)
+size_t FileHandle_Read(const FileHandle* handle, void* buffer, const size_t size)
 {
-	fread(buffer, 1, size, handle->file);
+	return fread(buffer, 1, size, handle->file);
 }
 
-void FileHandle_Write(const FileHandle* handle, const void* buffer, const size_t size)
+size_t FileHandle_Write(const FileHandle* handle, const void* buffer, const size_t size)
 {
-	fwrite(buffer, 1, size, handle->file);
+	return fwrite(buffer, 1, size, handle->file);
 }
 
 String* File_ReadAllText(const char* path)
 {
 	using const FileHandle* file = NewWith(FileHandle, Args, path, "r");
-	if (!file)
+	if (!file->file)
 		return NULL;
 
-	const size_t size = FileHandle_GetSize(file);
-
-	String* str = NewWith(String, Capacity, size);
-	String_Resize(str, size);
-	FileHandle_Read(file, String_GetBuffer(str), size);
+	// Read until the end of the file rather than for its size, which pipes and terminals do not have
+	String* str = New(String);
+	size_t length = 0;
+	while (true)
+	{
+		String_Resize(str, length + FILE_READ_CHUNK_SIZE);
+		const size_t count = FileHandle_Read(file, String_GetBuffer(str) + length, FILE_READ_CHUNK_SIZE);
+		length += count;
+		if (count < FILE_READ_CHUNK_SIZE)
+			break;
+	}
 
+	String_Resize(str, length);
+	String_GetBuffer(str)[length] = '\0';
 	return str;
 }
 
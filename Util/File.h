@@ -11,11 +11,15 @@ typedef struct
 
 FileHandle* FileHandle_Init_WithArgs(FileHandle* self, const char* path, const char* mode);
 void FileHandle_Fini(FileHandle* handle);
+// Closes the file early and returns whether everything written to it was flushed
+bool FileHandle_Close(FileHandle* handle);
 void FileHandle_SetPos(const FileHandle* handle, size_t pos);
 size_t FileHandle_GetPos(const FileHandle* handle);
 size_t FileHandle_GetSize(const FileHandle* handle);
-void FileHandle_Read(const FileHandle* handle, void* buffer, size_t size);
-void FileHandle_Write(const FileHandle* handle, const void* buffer, size_t size);
+// Returns the number of bytes read, which is less than size at the end of the file
+size_t FileHandle_Read(const FileHandle* handle, void* buffer, size_t size);
+// Returns the number of bytes written, which is less than size on an error
+size_t FileHandle_Write(const FileHandle* handle, const void* buffer, size_t size);
 String*nullable File_ReadAllText(const char* path);
 
 nullable_end
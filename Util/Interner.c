@@ -0,0 +1,141 @@
+#include "Interner.h"
+
+#include <string.h>
+
+nullable_begin
+
+#define INTERNER_INITIAL_SLOT_COUNT 256
+
+static uint32_t Interner_Hash(ConstCharSpan spelling);
+static void Interner_Rehash(Interner* self, size_t newSlotCount);
+
+Interner* Interner_Init(Interner* self)
+{
+	Interner_SymbolList_Init(&self->symbols);
+	CharList_Init_WithCapacity(&self->spellings, 1024);
+
+	self->slotCount = INTERNER_INITIAL_SLOT_COUNT;
+	self->slots = (uint32_t*)calloc(self->slotCount, sizeof(uint32_t));
+	if (self->slots == NULL)
+		abort();
+
+	return self;
+}
+
+void Interner_Fini(const Interner* self)
+{
+	Interner_SymbolList_Fini(&self->symbols);
+	CharList_Fini(&self->spellings);
+	free(self->slots);
+}
+
+uint32_t Interner_Intern(Interner* self, const ConstCharSpan spelling)
+{
+	const uint32_t hash = Interner_Hash(spelling);
+
+	size_t slot = hash & (self->slotCount - 1);
+	while (self->slots[slot] != 0)
+	{
+		const uint32_t symbol = self->slots[slot] - 1;
+		const Interner_Symbol* entry = &self->symbols.data[symbol];
+		if (entry->hash == hash && entry->length == spelling.length &&
+		    memcmp(self->spellings.data + entry->offset, spelling.data, spelling.length) == 0)
+			return symbol;
+
+		slot = (slot + 1) & (self->slotCount - 1);
+	}
+
+	// New spelling: copy it and claim the empty slot
+	const uint32_t symbol = (uint32_t)self->symbols.size;
+	assert(symbol < INTERNER_NO_SYMBOL - 1 && self->spellings.size + spelling.length <= UINT32_MAX);
+
+	const Interner_Symbol entry = { (uint32_t)self->spellings.size, (uint32_t)spelling.length, hash };
+	Interner_SymbolList_AppendFromPtr(&self->symbols, &entry);
+
+	if (self->spellings.size + spelling.length > self->spellings.capacity)
+	{
+		const size_t grown = self->spellings.capacity + self->spellings.capacity / 2;
+		const size_t needed = self->spellings.size + spelling.length;
+		if (!CharList_Reserve(&self->spellings, grown > needed ? grown : needed))
+			abort();
+	}
+
+	if (spelling.length != 0)
+		memcpy(self->spellings.data + self->spellings.size, spelling.data, spelling.length);
+	self->spellings.size += spelling.length;
+
+	self->slots[slot] = symbol + 1;
+
+	// Keep the load factor at or below 1/2
+	if (self->symbols.size * 2 > self->slotCount)
+		Interner_Rehash(self, self->slotCount * 2);
+
+	return symbol;
+}
+
+ConstCharSpan Interner_GetSpelling(const Interner* self, const uint32_t symbol)
+{
+	assert(symbol < self->symbols.size);
+
+	const Interner_Symbol* entry = &self->symbols.data[symbol];
+	return ConstCharSpan_Create(self->spellings.data + entry->offset, entry->length);
+}
+
+size_t Interner_GetCount(const Interner* self)
+{
+	return self->symbols.size;
+}
+
+size_t Interner_GetMemoryUsage(const Interner* self)
+{
+	return self->symbols.capacity * sizeof(Interner_Symbol) +
+	       self->spellings.capacity +
+	       self->slotCount * sizeof(uint32_t);
+}
+
+// Multiplicative hash over 8-byte words
+uint32_t Interner_Hash(const ConstCharSpan spelling)
+{
+	uint64_t hash = spelling.length * 0x9E3779B97F4A7C15u;
+
+	size_t i = 0;
+	for (; i + 8 <= spelling.length; i += 8)
+	{
+		uint64_t word;
+		memcpy(&word, spelling.data + i, sizeof(word));
+		hash = (hash ^ word) * 0xFF51AFD7ED558CCDu;
+		hash ^= hash >> 32;
+	}
+
+	if (i < spelling.length)
+	{
+		uint64_t word = 0;
+		memcpy(&word, spelling.data + i, spelling.length - i);
+		hash = (hash ^ word) * 0xFF51AFD7ED558CCDu;
+		hash ^= hash >> 32;
+	}
+
+	return (uint32_t)hash;
+}
+
+void Interner_Rehash(Interner* self, const size_t newSlotCount)
+{
+	uint32_t* slots = (uint32_t*)calloc(newSlotCount, sizeof(uint32_t));
+	if (slots == NULL)
+		abort();
+
+	for (size_t symbol = 0; symbol < self->symbols.size; symbol++)
+	{
+		size_t slot = self->symbols.data[symbol].hash & (newSlotCount - 1);
+		while (slots[slot] != 0)
+			slot = (slot + 1) & (newSlotCount - 1);
+
+		slots[slot] = (uint32_t)symbol + 1;
+	}
+
+	free(self->slots);
+	self->slots = slots;
+	self->slotCount = newSlotCount;
+}
+
+nullable_end
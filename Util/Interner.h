@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "List.h"
+#include "Macros.h"
+#include "Span.h"
+
+nullable_begin
+
+// Marks the absence of a symbol, e.g. for identifiers lexed without an interner
+#define INTERNER_NO_SYMBOL UINT32_MAX
+
+typedef struct
+{
+	uint32_t offset; // Offset of the spelling in Interner.spellings
+	uint32_t length;
+	uint32_t hash;
+} Interner_Symbol;
+
+#define LIST_TYPE Interner_SymbolList
+#define LIST_ELEMENT_TYPE Interner_Symbol
+nullable_end
+#include "ListDef.h"
+nullable_begin
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+// Maps each distinct spelling to a dense 32-bit symbol ID, assigned in order of first appearance,
+// so that names can be compared as integers. Spellings are copied, so they outlive their source.
+typedef struct
+{
+	Interner_SymbolList symbols;
+	// All spellings back to back
+	CharList spellings;
+	// Open-addressing hash table of symbol ID + 1 (0 marks an empty slot)
+	uint32_t* slots;
+	size_t slotCount; // Power of two
+} Interner;
+
+Interner* Interner_Init(Interner* self);
+void Interner_Fini(const Interner* self);
+
+uint32_t Interner_Intern(Interner* self, ConstCharSpan spelling);
+ConstCharSpan Interner_GetSpelling(const Interner* self, uint32_t symbol);
+size_t Interner_GetCount(const Interner* self);
+// Heap memory owned by the interner, in bytes
+size_t Interner_GetMemoryUsage(const Interner* self);
+
+nullable_end
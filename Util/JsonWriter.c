@@ -0,0 +1,167 @@
+#include "JsonWriter.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#include "Scan.h"
+
+nullable_begin
+
+static void JsonWriter_BeginValue(JsonWriter* self);
+
+void JsonWriter_BeginObject(JsonWriter* self)
+{
+	JsonWriter_BeginValue(self);
+	Writer_WriteChar(self->output, '{');
+	self->needsComma = false;
+}
+
+void JsonWriter_EndObject(JsonWriter* self)
+{
+	Writer_WriteChar(self->output, '}');
+	self->needsComma = true;
+}
+
+void JsonWriter_BeginArray(JsonWriter* self)
+{
+	JsonWriter_BeginValue(self);
+	Writer_WriteChar(self->output, '[');
+	self->needsComma = false;
+}
+
+void JsonWriter_EndArray(JsonWriter* self)
+{
+	Writer_WriteChar(self->output, ']');
+	self->needsComma = true;
+}
+
+void JsonWriter_Key(JsonWriter* self, const char* key)
+{
+	JsonWriter_BeginValue(self);
+	Writer_WriteChar(self->output, '"');
+	Writer_WriteCString(self->output, key);
+	Writer_Write(self->output, "\":", 2);
+	self->needsComma = false;
+}
+
+void JsonWriter_String(JsonWriter* self, const ConstCharSpan value)
+{
+	static const char hexDigits[] = "0123456789abcdef";
+
+	JsonWriter_BeginValue(self);
+	Writer_WriteChar(self->output, '"');
+
+	// Runs without anything to escape are copied in one piece
+	size_t start = 0;
+	while (true)
+	{
+		const size_t position = Scan_FindJsonEscape(value.data, start, value.length);
+		Writer_Write(self->output, value.data + start, position - start);
+		if (position == value.length)
+			break;
+
+		const char c = value.data[position];
+		char escape[6] = { '\\', c, 0, 0, 0, 0 };
+		size_t escapeLength = 2;
+		switch (c)
+		{
+			case '"':
+			case '\\':
+				break;
+			case '\b':
+				escape[1] = 'b';
+				break;
+			case '\f':
+				escape[1] = 'f';
+				break;
+			case '\n':
+				escape[1] = 'n';
+				break;
+			case '\r':
+				escape[1] = 'r';
+				break;
+			case '\t':
+				escape[1] = 't';
+				break;
+			default:
+				escape[1] = 'u';
+				escape[2] = '0';
+				escape[3] = '0';
+				escape[4] = hexDigits[(unsigned char)c >> 4];
+				escape[5] = hexDigits[(unsigned char)c & 0xF];
+				escapeLength = 6;
+				break;
+		}
+		Writer_Write(self->output, escape, escapeLength);
+		start = position + 1;
+	}
+
+	Writer_WriteChar(self->output, '"');
+	self->needsComma = true;
+}
+
+void JsonWriter_CString(JsonWriter* self, const char* value)
+{
+	JsonWriter_String(self, ConstCharSpan_Create(value, strlen(value)));
+}
+
+void JsonWriter_Int(JsonWriter* self, const int64_t value)
+{
+	JsonWriter_BeginValue(self);
+	if (value < 0)
+	{
+		Writer_WriteChar(self->output, '-');
+		Writer_WriteUInt(self->output, (uint64_t)0 - (uint64_t)value);
+	}
+	else
+		Writer_WriteUInt(self->output, (uint64_t)value);
+	self->needsComma = true;
+}
+
+void JsonWriter_UInt(JsonWriter* self, const uint64_t value)
+{
+	JsonWriter_BeginValue(self);
+	Writer_WriteUInt(self->output, value);
+	self->needsComma = true;
+}
+
+void JsonWriter_Double(JsonWriter* self, const double value)
+{
+	if (!isfinite(value))
+	{
+		JsonWriter_Null(self);
+		return;
+	}
+
+	// 17 significant digits read back as the same double
+	char buffer[32];
+	const int length = snprintf(buffer, sizeof(buffer), "%.17g", value);
+	JsonWriter_BeginValue(self);
+	Writer_Write(self->output, buffer, (size_t)length);
+	self->needsComma = true;
+}
+
+void JsonWriter_Bool(JsonWriter* self, const bool value)
+{
+	JsonWriter_BeginValue(self);
+	if (value)
+		Writer_Write(self->output, "true", 4);
+	else
+		Writer_Write(self->output, "false", 5);
+	self->needsComma = true;
+}
+
+void JsonWriter_Null(JsonWriter* self)
+{
+	JsonWriter_BeginValue(self);
+	Writer_Write(self->output, "null", 4);
+	self->needsComma = true;
+}
+
+void JsonWriter_BeginValue(JsonWriter* self)
+{
+	if (self->needsComma)
+		Writer_WriteChar(self->output, ',');
+}
+
+nullable_end
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Writer.h"
+
+nullable_begin
+
+// Streams JSON into a Writer without allocating. Commas are placed from a single flag rather than a stack of open
+// containers, so nesting is unlimited; the caller is trusted to balance Begin and End calls and to put a Key before
+// every value inside an object.
+typedef struct
+{
+	Writer* output;
+	// Whether the next value or key follows another one in the same container
+	bool needsComma;
+} JsonWriter;
+
+static JsonWriter JsonWriter_Create(Writer* output)
+{
+	return (JsonWriter) { .output = output, .needsComma = false };
+}
+
+void JsonWriter_BeginObject(JsonWriter* self);
+void JsonWriter_EndObject(JsonWriter* self);
+void JsonWriter_BeginArray(JsonWriter* self);
+void JsonWriter_EndArray(JsonWriter* self);
+// Keys are written as they are, so they must not need escaping
+void JsonWriter_Key(JsonWriter* self, const char* key);
+
+// Strings are escaped but not checked to be UTF-8
+void JsonWriter_String(JsonWriter* self, ConstCharSpan value);
+void JsonWriter_CString(JsonWriter* self, const char* value);
+void JsonWriter_Int(JsonWriter* self, int64_t value);
+void JsonWriter_UInt(JsonWriter* self, uint64_t value);
+// NaN and infinities have no JSON form and are written as null
+void JsonWriter_Double(JsonWriter* self, double value);
+void JsonWriter_Bool(JsonWriter* self, bool value);
+void JsonWriter_Null(JsonWriter* self);
+
+nullable_end
@@ -1,47 +1,145 @@
 #pragma once
 
+#include <stdalign.h>
 #include <stdatomic.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdlib.h>
 
+#include "Arena.h"
+#include "Pool.h"
+
+// Reference counts are only atomic when objects are shared between threads, which is opt-in at build time
+#ifndef MANAGED_ATOMIC_REFCOUNT
+#define MANAGED_ATOMIC_REFCOUNT 0
+#endif
+
+// Reference count of objects owned by an arena; they are never counted, finalized or freed individually
+#define MANAGED_ARENA_OWNED UINT32_MAX
+// Size class of objects allocated directly with malloc
+#define MANAGED_NO_SIZE_CLASS UINT32_MAX
+
+#if MANAGED_ATOMIC_REFCOUNT
+typedef _Atomic uint32_t ManagedRefCount;
+#else
+typedef uint32_t ManagedRefCount;
+#endif
+
 typedef struct ManagedObjectHeader
 {
-	_Atomic size_t refCount;
+	ManagedRefCount refCount;
+	uint32_t sizeClass;
 	void (*fini)(void*);
 } ManagedObjectHeader;
 
+static uint32_t ManagedRefCount_Load(const ManagedRefCount* refCount)
+{
+#if MANAGED_ATOMIC_REFCOUNT
+	return atomic_load_explicit(refCount, memory_order_relaxed);
+#else
+	return *refCount;
+#endif
+}
+
+static void ManagedRefCount_Increment(ManagedRefCount* refCount)
+{
+#if MANAGED_ATOMIC_REFCOUNT
+	atomic_fetch_add_explicit(refCount, 1, memory_order_relaxed);
+#else
+	(*refCount)++;
+#endif
+}
+
+// Returns the count before decrementing
+static uint32_t ManagedRefCount_Decrement(ManagedRefCount* refCount)
+{
+#if MANAGED_ATOMIC_REFCOUNT
+	return atomic_fetch_sub_explicit(refCount, 1, memory_order_acq_rel);
+#else
+	return (*refCount)--;
+#endif
+}
+
 static void* NewImpl(const size_t size, void (*deleter)(void*))
 {
-	// Create header, also allocating space for the object
-	ManagedObjectHeader* header = (ManagedObjectHeader*)malloc(sizeof(ManagedObjectHeader) + size);
-	if (header == NULL)
-		abort();
+	// Create header, also allocating space for the object; small objects come from the pools
+	const size_t totalSize = sizeof(ManagedObjectHeader) + size;
+	ManagedObjectHeader* header;
+	uint32_t sizeClass = MANAGED_NO_SIZE_CLASS;
+	if (POOL_ENABLED && totalSize <= POOL_MAX_SIZE)
+	{
+		sizeClass = (uint32_t)Pool_GetSizeClass(totalSize);
+		header = (ManagedObjectHeader*)Pool_Allocate(sizeClass);
+	}
+	else
+	{
+		header = (ManagedObjectHeader*)malloc(totalSize);
+		if (header == NULL)
+			abort();
+	}
 
 	// Set header info
-	atomic_store(&header->refCount, 1);
+	header->refCount = 1;
+	header->sizeClass = sizeClass;
 	header->fini = deleter;
 
 	// Return pointer to object memory
 	return header + 1;
 }
 
-static void ReleaseImpl(void* ptr)
+static void* NewInImpl(Arena*nullable arena, const size_t size, void (*deleter)(void*))
+{
+	if (arena == NULL)
+		return NewImpl(size, deleter);
+
+	ManagedObjectHeader* header = (ManagedObjectHeader*)Arena_Allocate(arena, sizeof(ManagedObjectHeader) + size, alignof(max_align_t));
+	header->refCount = MANAGED_ARENA_OWNED;
+	header->sizeClass = MANAGED_NO_SIZE_CLASS;
+	header->fini = deleter;
+	return header + 1;
+}
+
+// Drops a reference like Release, but returns the object instead of finalizing it if that was the last reference, so
+// that the caller can finalize it (e.g. iteratively rather than recursively) and then free it with FreeDetached
+static void*nullable ReleaseDetachImpl(void*nullable ptr)
 {
 	if (ptr == NULL)
-		return;
+		return NULL;
 
 	// Get header
 	ManagedObjectHeader* header = (ManagedObjectHeader*)ptr - 1;
 
-	if (atomic_fetch_sub_explicit(&header->refCount, 1, memory_order_acq_rel) > 1)
+	if (ManagedRefCount_Load(&header->refCount) == MANAGED_ARENA_OWNED)
+		return NULL;
+
+	if (ManagedRefCount_Decrement(&header->refCount) > 1)
+		return NULL;
+
+	return ptr;
+}
+
+// Frees the memory of a detached object without finalizing it
+static void FreeDetachedImpl(void* ptr)
+{
+	ManagedObjectHeader* header = (ManagedObjectHeader*)ptr - 1;
+	if (header->sizeClass != MANAGED_NO_SIZE_CLASS)
+		Pool_Free(header, header->sizeClass);
+	else
+		free(header);
+}
+
+static void ReleaseImpl(void* ptr)
+{
+	ptr = ReleaseDetachImpl(ptr);
+	if (ptr == NULL)
 		return;
 
 	// Call deleter
+	const ManagedObjectHeader* header = (ManagedObjectHeader*)ptr - 1;
 	if (header->fini != NULL)
-		header->fini((void*)ptr);
+		header->fini(ptr);
 
-	// Free memory
-	free(header);
+	FreeDetachedImpl(ptr);
 }
 
 static void* RetainImpl(void* ptr)
@@ -49,7 +147,8 @@ static void* RetainImpl(void* ptr)
 	if (ptr != NULL)
 	{
 		ManagedObjectHeader* header = ((ManagedObjectHeader*)ptr) - 1;
-		atomic_fetch_add(&header->refCount, 1);
+		if (ManagedRefCount_Load(&header->refCount) != MANAGED_ARENA_OWNED)
+			ManagedRefCount_Increment(&header->refCount);
 	}
 	return ptr;
 }
@@ -66,5 +165,11 @@ static void CleanupUsingImpl(void* ptr)
 #define using __attribute__((cleanup(CleanupUsingImpl)))
 #define New(type) (type*)type##_Init((type*)NewImpl(sizeof(type), (void (*)(void*))type##_Fini))
 #define NewWith(type, with, ...) (type*)type##_Init_With##with((type*)NewImpl(sizeof(type), (void (*)(void*))type##_Fini) __VA_OPT__(,) __VA_ARGS__)
+// Allocate from arena (or the heap if it is NULL). Objects in an arena are never finalized, so anything they
+// reference outside of it has to be released through Arena_AddCleanup.
+#define NewIn(arena, type) (type*)type##_Init((type*)NewInImpl(arena, sizeof(type), (void (*)(void*))type##_Fini))
+#define NewWithIn(arena, type, with, ...) (type*)type##_Init_With##with((type*)NewInImpl(arena, sizeof(type), (void (*)(void*))type##_Fini) __VA_OPT__(,) __VA_ARGS__)
 #define Release(ptr) ReleaseImpl(ptr)
 #define Retain(ptr) (typeof (ptr))RetainImpl(ptr)
+#define ReleaseDetach(ptr) (typeof (ptr))ReleaseDetachImpl(ptr)
+#define FreeDetached(ptr) FreeDetachedImpl(ptr)
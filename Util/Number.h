@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "Macros.h"
+#include "Span.h"
+
+nullable_begin
+
+// Numeric literal decoding. Digit spans must only contain digits that are valid for the given base
+// (the lexer guarantees this); the value of invalid digits is unspecified.
+
+// Decimal and binary exponents beyond this magnitude are far outside the range of double; callers may saturate them here
+#define NUMBER_EXPONENT_LIMIT 100000
+
+// Parses an unsigned integer in base 2, 8, 10 or 16, 8 digits at a time.
+// Returns false (leaving *outValue unspecified) if the value does not fit in 64 bits.
+bool Number_ParseUnsigned(ConstCharSpan digits, unsigned base, uint64_t* outValue);
+
+// Correctly rounded value of integerPart.fractionalPart * 10^exponent
+double Number_DecimalToDouble(ConstCharSpan integerPart, ConstCharSpan fractionalPart, int64_t exponent);
+// Correctly rounded value of 0x integerPart.fractionalPart * 2^exponent
+double Number_HexToDouble(ConstCharSpan integerPart, ConstCharSpan fractionalPart, int64_t exponent);
+
+nullable_end
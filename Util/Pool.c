@@ -0,0 +1,83 @@
+#include "Pool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+
+nullable_begin
+
+_Thread_local PoolCache Pool_cache;
+
+static pthread_once_t Pool_exitKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t Pool_exitKey;
+// Free blocks of exited threads, per size class
+static pthread_mutex_t Pool_orphansLock = PTHREAD_MUTEX_INITIALIZER;
+static PoolBlock*nullable Pool_orphans[POOL_SIZE_CLASS_COUNT];
+
+static void Pool_CreateExitKey(void);
+static void Pool_OnThreadExit(void* cache);
+
+void* Pool_Refill(const size_t sizeClass)
+{
+	if (!Pool_cache.hasExitHook)
+	{
+		// The key's destructor only runs for threads that set a value for it
+		pthread_once(&Pool_exitKeyOnce, Pool_CreateExitKey);
+		if (pthread_setspecific(Pool_exitKey, &Pool_cache) != 0)
+			abort();
+		Pool_cache.hasExitHook = true;
+	}
+
+	pthread_mutex_lock(&Pool_orphansLock);
+	PoolBlock* orphans = Pool_orphans[sizeClass];
+	Pool_orphans[sizeClass] = NULL;
+	pthread_mutex_unlock(&Pool_orphansLock);
+	if (orphans != NULL)
+	{
+		Pool_cache.freeLists[sizeClass] = orphans->next;
+		return orphans;
+	}
+
+	char* chunk = (char*)malloc(POOL_CHUNK_SIZE);
+	if (chunk == NULL)
+		abort();
+
+	const size_t blockSize = (sizeClass + 1) * POOL_GRANULARITY;
+	const size_t blockCount = POOL_CHUNK_SIZE / blockSize;
+	for (size_t i = blockCount - 1; i > 0; i--)
+		Pool_Free(chunk + i * blockSize, sizeClass);
+
+	return chunk;
+}
+
+void Pool_CreateExitKey(void)
+{
+	if (pthread_key_create(&Pool_exitKey, Pool_OnThreadExit) != 0)
+		abort();
+}
+
+// Blocks may still be in use on other threads, so the chunks of an exiting thread are not freed; its free blocks are
+// spliced onto the shared lists instead
+void Pool_OnThreadExit(void* cache)
+{
+	PoolCache* exiting = (PoolCache*)cache;
+	pthread_mutex_lock(&Pool_orphansLock);
+	for (size_t sizeClass = 0; sizeClass < POOL_SIZE_CLASS_COUNT; sizeClass++)
+	{
+		PoolBlock* head = exiting->freeLists[sizeClass];
+		if (head == NULL)
+			continue;
+
+		PoolBlock* tail = head;
+		while (tail->next != NULL)
+			tail = tail->next;
+		tail->next = Pool_orphans[sizeClass];
+		Pool_orphans[sizeClass] = head;
+		exiting->freeLists[sizeClass] = NULL;
+	}
+	pthread_mutex_unlock(&Pool_orphansLock);
+
+	// Allocations from later destructors register the hook again
+	exiting->hasExitHook = false;
+}
+
+nullable_end
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Macros.h"
+
+nullable_begin
+
+// Small fixed-size blocks are recycled through per-thread free lists, one per size class.
+// Pool memory is carved from large chunks that are kept for the lifetime of the process. When a thread exits, its free
+// blocks are handed to a shared list that the next refill of their size class takes over.
+#define POOL_GRANULARITY 16
+#define POOL_SIZE_CLASS_COUNT 16
+#define POOL_MAX_SIZE (POOL_GRANULARITY * POOL_SIZE_CLASS_COUNT)
+#define POOL_CHUNK_SIZE (64 * 1024)
+
+// Pools hide use-after-free and leaks from AddressSanitizer, so they are off in sanitized builds
+#ifndef POOL_ENABLED
+#if defined(__SANITIZE_ADDRESS__)
+#define POOL_ENABLED 0
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define POOL_ENABLED 0
+#endif
+#endif
+#endif
+#ifndef POOL_ENABLED
+#define POOL_ENABLED 1
+#endif
+
+typedef struct PoolBlock
+{
+	struct PoolBlock*nullable next;
+} PoolBlock;
+
+typedef struct
+{
+	PoolBlock*nullable freeLists[POOL_SIZE_CLASS_COUNT];
+	// Whether the free lists are handed over when the thread exits
+	bool hasExitHook;
+} PoolCache;
+
+extern _Thread_local PoolCache Pool_cache;
+
+// Takes over the blocks left by exited threads, or else carves a new chunk into blocks of the size class, and returns
+// one of them
+void* Pool_Refill(size_t sizeClass);
+
+// Size class for blocks of size bytes; size must be between 1 and POOL_MAX_SIZE
+static size_t Pool_GetSizeClass(const size_t size)
+{
+	return (size - 1) / POOL_GRANULARITY;
+}
+
+static void* Pool_Allocate(const size_t sizeClass)
+{
+	PoolBlock* block = Pool_cache.freeLists[sizeClass];
+	if (block == NULL)
+		return Pool_Refill(sizeClass);
+
+	Pool_cache.freeLists[sizeClass] = block->next;
+	return block;
+}
+
+// Blocks may be freed on another thread than the one that allocated them; they then move to that thread's cache
+static void Pool_Free(void* ptr, const size_t sizeClass)
+{
+	PoolBlock* block = (PoolBlock*)ptr;
+	block->next = Pool_cache.freeLists[sizeClass];
+	Pool_cache.freeLists[sizeClass] = block;
+}
+
+nullable_end
@@ -0,0 +1,207 @@
+#include "Scan.h"
+
+#include <stdint.h>
+
+#if defined(__x86_64__)
+#define SCAN_HAVE_X86 1
+#include <immintrin.h>
+#else
+#define SCAN_HAVE_X86 0
+#endif
+
+nullable_begin
+
+typedef size_t (*Scan_FindFirstOfFunc)(const char* data, size_t position, size_t length, const char* needles, bool negate);
+typedef size_t (*Scan_FindFunc)(const char* data, size_t position, size_t length);
+
+static const char whitespaceNeedles[4] = { ' ', '\t', '\n', '\r' };
+static const char singleLineCommentNeedles[4] = { '\n', '\r', '\\', '\0' };
+static const char multiLineCommentNeedles[4] = { '*', '\0', '*', '\0' };
+static const char lineBreakNeedles[4] = { '\n', '\r', '\n', '\r' };
+
+// Scalar implementation, also used for the tails the vector implementations cannot cover
+
+static size_t Scan_FindFirstOf_Scalar(const char* data, size_t position, const size_t length, const char* needles, const bool negate)
+{
+	for (; position < length; position++)
+	{
+		const char c = data[position];
+		const bool match = c == needles[0] || c == needles[1] || c == needles[2] || c == needles[3];
+		if (match != negate)
+			return position;
+	}
+
+	return length;
+}
+
+static size_t Scan_FindJsonEscape_Scalar(const char* data, size_t position, const size_t length)
+{
+	for (; position < length; position++)
+	{
+		const unsigned char c = (unsigned char)data[position];
+		if (c < 0x20 || c == '"' || c == '\\')
+			return position;
+	}
+
+	return length;
+}
+
+#if SCAN_HAVE_X86
+
+static size_t Scan_FindFirstOf_SSE2(const char* data, size_t position, const size_t length, const char* needles, const bool negate)
+{
+	const __m128i n0 = _mm_set1_epi8(needles[0]);
+	const __m128i n1 = _mm_set1_epi8(needles[1]);
+	const __m128i n2 = _mm_set1_epi8(needles[2]);
+	const __m128i n3 = _mm_set1_epi8(needles[3]);
+
+	while (position + 16 <= length)
+	{
+		const __m128i block = _mm_loadu_si128((const __m128i*)(const void*)(data + position));
+		const __m128i eq = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(block, n0), _mm_cmpeq_epi8(block, n1)),
+		                                _mm_or_si128(_mm_cmpeq_epi8(block, n2), _mm_cmpeq_epi8(block, n3)));
+
+		uint32_t mask = (uint32_t)_mm_movemask_epi8(eq);
+		if (negate)
+			mask = ~mask & 0xFFFF;
+
+		if (mask != 0)
+			return position + (size_t)__builtin_ctz(mask);
+
+		position += 16;
+	}
+
+	return Scan_FindFirstOf_Scalar(data, position, length, needles, negate);
+}
+
+__attribute__((target("avx2")))
+static size_t Scan_FindFirstOf_AVX2(const char* data, size_t position, const size_t length, const char* needles, const bool negate)
+{
+	const __m256i n0 = _mm256_set1_epi8(needles[0]);
+	const __m256i n1 = _mm256_set1_epi8(needles[1]);
+	const __m256i n2 = _mm256_set1_epi8(needles[2]);
+	const __m256i n3 = _mm256_set1_epi8(needles[3]);
+
+	while (position + 32 <= length)
+	{
+		const __m256i block = _mm256_loadu_si256((const __m256i*)(const void*)(data + position));
+		const __m256i eq = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(block, n0), _mm256_cmpeq_epi8(block, n1)),
+		                                   _mm256_or_si256(_mm256_cmpeq_epi8(block, n2), _mm256_cmpeq_epi8(block, n3)));
+
+		uint32_t mask = (uint32_t)_mm256_movemask_epi8(eq);
+		if (negate)
+			mask = ~mask;
+
+		if (mask != 0)
+			return position + (size_t)__builtin_ctz(mask);
+
+		position += 32;
+	}
+
+	return Scan_FindFirstOf_SSE2(data, position, length, needles, negate);
+}
+
+// Bytes up to 0x1F are those left unchanged by an unsigned maximum with 0x1F
+static size_t Scan_FindJsonEscape_SSE2(const char* data, size_t position, const size_t length)
+{
+	const __m128i control = _mm_set1_epi8(0x1F);
+	const __m128i quote = _mm_set1_epi8('"');
+	const __m128i backslash = _mm_set1_epi8('\\');
+
+	while (position + 16 <= length)
+	{
+		const __m128i block = _mm_loadu_si128((const __m128i*)(const void*)(data + position));
+		const __m128i eq = _mm_or_si128(_mm_cmpeq_epi8(_mm_max_epu8(block, control), control),
+		                                _mm_or_si128(_mm_cmpeq_epi8(block, quote), _mm_cmpeq_epi8(block, backslash)));
+
+		const uint32_t mask = (uint32_t)_mm_movemask_epi8(eq);
+		if (mask != 0)
+			return position + (size_t)__builtin_ctz(mask);
+
+		position += 16;
+	}
+
+	return Scan_FindJsonEscape_Scalar(data, position, length);
+}
+
+__attribute__((target("avx2")))
+static size_t Scan_FindJsonEscape_AVX2(const char* data, size_t position, const size_t length)
+{
+	const __m256i control = _mm256_set1_epi8(0x1F);
+	const __m256i quote = _mm256_set1_epi8('"');
+	const __m256i backslash = _mm256_set1_epi8('\\');
+
+	while (position + 32 <= length)
+	{
+		const __m256i block = _mm256_loadu_si256((const __m256i*)(const void*)(data + position));
+		const __m256i eq = _mm256_or_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(block, control), control),
+		                                   _mm256_or_si256(_mm256_cmpeq_epi8(block, quote), _mm256_cmpeq_epi8(block, backslash)));
+
+		const uint32_t mask = (uint32_t)_mm256_movemask_epi8(eq);
+		if (mask != 0)
+			return position + (size_t)__builtin_ctz(mask);
+
+		position += 32;
+	}
+
+	return Scan_FindJsonEscape_SSE2(data, position, length);
+}
+
+#endif
+
+static Scan_FindFirstOfFunc findFirstOf = Scan_FindFirstOf_Scalar;
+static Scan_FindFunc findJsonEscape = Scan_FindJsonEscape_Scalar;
+static const char* implementationName = "scalar";
+
+__attribute__((constructor))
+static void Scan_SelectImplementation(void)
+{
+#if SCAN_HAVE_X86
+	__builtin_cpu_init();
+
+	if (__builtin_cpu_supports("avx2"))
+	{
+		findFirstOf = Scan_FindFirstOf_AVX2;
+		findJsonEscape = Scan_FindJsonEscape_AVX2;
+		implementationName = "avx2";
+	}
+	else if (__builtin_cpu_supports("sse2"))
+	{
+		findFirstOf = Scan_FindFirstOf_SSE2;
+		findJsonEscape = Scan_FindJsonEscape_SSE2;
+		implementationName = "sse2";
+	}
+#endif
+}
+
+size_t Scan_SkipWhitespace(const char* data, const size_t position, const size_t length)
+{
+	return findFirstOf(data, position, length, whitespaceNeedles, true);
+}
+
+size_t Scan_FindSingleLineCommentStop(const char* data, const size_t position, const size_t length)
+{
+	return findFirstOf(data, position, length, singleLineCommentNeedles, false);
+}
+
+size_t Scan_FindMultiLineCommentStop(const char* data, const size_t position, const size_t length)
+{
+	return findFirstOf(data, position, length, multiLineCommentNeedles, false);
+}
+
+size_t Scan_FindLineBreak(const char* data, const size_t position, const size_t length)
+{
+	return findFirstOf(data, position, length, lineBreakNeedles, false);
+}
+
+size_t Scan_FindJsonEscape(const char* data, const size_t position, const size_t length)
+{
+	return findJsonEscape(data, position, length);
+}
+
+const char* Scan_GetImplementationName(void)
+{
+	return implementationName;
+}
+
+nullable_end
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "Macros.h"
+
+nullable_begin
+
+// Vectorized byte scanners. Each function scans data[position, length) and returns the index of the
+// first matching byte, or length if there is none. The implementation (AVX2, SSE2 or scalar) is selected
+// once at startup based on CPUID.
+
+// First byte that is not ' ', '\t', '\n' or '\r'
+size_t Scan_SkipWhitespace(const char* data, size_t position, size_t length);
+// First '\n', '\r', '\\' or '\0' (the bytes that end or continue a single-line comment)
+size_t Scan_FindSingleLineCommentStop(const char* data, size_t position, size_t length);
+// First '*' or '\0' (the bytes that may end a multi-line comment)
+size_t Scan_FindMultiLineCommentStop(const char* data, size_t position, size_t length);
+// First '\n' or '\r'
+size_t Scan_FindLineBreak(const char* data, size_t position, size_t length);
+// First '"', '\\' or control character (below 0x20), the bytes a JSON string has to escape
+size_t Scan_FindJsonEscape(const char* data, size_t position, size_t length);
+
+// Name of the selected implementation ("avx2", "sse2" or "scalar")
+const char* Scan_GetImplementationName(void);
+
+nullable_end
@@ -30,20 +30,33 @@ String* String_Init_WithCapacity(String* self, const size_t capacity)
 		self->long__.capacity = capacity;
 
 		self->isLong__ = true;
+		self->isBorrowed__ = false;
 		self->length = 0;
 		return self;
 	}
 
 	self->short__.data[0] = '\0';
 	self->isLong__ = false;
+	self->isBorrowed__ = false;
 	self->length = 0;
 
 	return self;
 }
 
+String* String_Init_WithBorrowedBuffer(String* self, char* data, const size_t length, const size_t capacity)
+{
+	assert(length <= capacity && data[length] == '\0');
+	self->long__.data = data;
+	self->long__.capacity = capacity;
+	self->isLong__ = true;
+	self->isBorrowed__ = true;
+	self->length = length;
+	return self;
+}
+
 void String_Fini(const String* str)
 {
-	if (str->isLong__)
+	if (str->isLong__ && !str->isBorrowed__)
 		free(str->long__.data);
 }
 
@@ -66,8 +79,16 @@ void String_Resize(String* str, const size_t newLength)
 		while (newCapacity < newLength)
 			newCapacity = newCapacity + newCapacity / 2;
 
+		if (str->isBorrowed__)
+		{
+			char* newData = (char*)malloc(newCapacity + 1);
+			memcpy(newData, str->long__.data, str->length);
+			str->long__.data = newData;
+			str->isBorrowed__ = false;
+		}
+		else
+			str->long__.data = (char*)realloc(str->long__.data, newCapacity + 1);
 		str->long__.capacity = newCapacity;
-		str->long__.data = (char*)realloc(str->long__.data, newCapacity + 1);
 		str->long__.data[newLength] = '\0';
 
 		str->length = newLength;
@@ -109,6 +130,10 @@ void String_AppendChar(String* str, const char c)
 
 void String_AppendConstCharSpan(String* str, const ConstCharSpan strToAppend)
 {
+	// An empty span may have no data, which memcpy must not be given
+	if (strToAppend.length == 0)
+		return;
+
 	const size_t len = String_Length(str);
 	String_Resize(str, len + strToAppend.length);
 
@@ -28,11 +28,15 @@ typedef struct
 
 	size_t length;
 	bool isLong__;
+	// The long data belongs to someone else and is not freed; growing past its capacity copies it
+	bool isBorrowed__;
 } String;
 
 String* String_Init(String* self);
 String* String_Init_WithCString(String* self, const char* cstr);
 String* String_Init_WithCapacity(String* self, size_t capacity);
+// Uses data in place. It must hold capacity + 1 bytes, with data[length] == '\0', and outlive the string.
+String* String_Init_WithBorrowedBuffer(String* self, char* data, size_t length, size_t capacity);
 void String_Fini(const String* str);
 size_t String_Length(const String* str);
 void String_Resize(String* str, size_t newLength);
@@ -0,0 +1,86 @@
+#include "Writer.h"
+
+#include <errno.h>
+#include <unistd.h>
+
+nullable_begin
+
+static const char Writer_spaces[64] = "                                                                ";
+
+static void Writer_WriteAll(int fd, const char* data, size_t size);
+
+Writer* Writer_Init_WithFd(Writer* self, const int fd)
+{
+	self->fd = fd;
+	self->length = 0;
+	return self;
+}
+
+void Writer_Fini(Writer* self)
+{
+	Writer_Flush(self);
+}
+
+void Writer_Flush(Writer* self)
+{
+	Writer_WriteAll(self->fd, self->buffer, self->length);
+	self->length = 0;
+}
+
+void Writer_Write(Writer* self, const char* data, const size_t size)
+{
+	if (size > WRITER_BUFFER_SIZE - self->length)
+	{
+		Writer_Flush(self);
+
+		// Too large to be worth copying
+		if (size >= WRITER_BUFFER_SIZE)
+		{
+			Writer_WriteAll(self->fd, data, size);
+			return;
+		}
+	}
+
+	memcpy(self->buffer + self->length, data, size);
+	self->length += size;
+}
+
+void Writer_WriteSpaces(Writer* self, size_t count)
+{
+	while (count > sizeof(Writer_spaces))
+	{
+		Writer_Write(self, Writer_spaces, sizeof(Writer_spaces));
+		count -= sizeof(Writer_spaces);
+	}
+	Writer_Write(self, Writer_spaces, count);
+}
+
+void Writer_WriteUInt(Writer* self, uint64_t value)
+{
+	char buffer[20];
+	size_t start = sizeof(buffer);
+	do
+	{
+		buffer[--start] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	Writer_Write(self, buffer + start, sizeof(buffer) - start);
+}
+
+// Output that cannot be written (a closed pipe, a full disk) is dropped, as stdio would
+void Writer_WriteAll(const int fd, const char* data, size_t size)
+{
+	while (size != 0)
+	{
+		const ssize_t written = write(fd, data, size);
+		if (written < 0 && errno == EINTR)
+			continue;
+		if (written <= 0)
+			return;
+
+		data += written;
+		size -= (size_t)written;
+	}
+}
+
+nullable_end
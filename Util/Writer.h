@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Macros.h"
+#include "Span.h"
+
+nullable_begin
+
+#define WRITER_BUFFER_SIZE (64 * 1024)
+
+// Buffered output to a file descriptor. Fragments are copied into a fixed buffer that is written out with write(2)
+// whenever it fills up, so output starts early and memory stays the same however much is written.
+// Output from stdio to the same descriptor must be flushed before writing here.
+typedef struct
+{
+	int fd;
+	size_t length;
+	char buffer[WRITER_BUFFER_SIZE];
+} Writer;
+
+Writer* Writer_Init_WithFd(Writer* self, int fd);
+// Flushes whatever is still buffered
+void Writer_Fini(Writer* self);
+void Writer_Flush(Writer* self);
+void Writer_Write(Writer* self, const char* data, size_t size);
+void Writer_WriteSpaces(Writer* self, size_t count);
+// Writes value in decimal, as "%" PRIu64 would
+void Writer_WriteUInt(Writer* self, uint64_t value);
+
+static void Writer_WriteChar(Writer* self, const char c)
+{
+	if (self->length == WRITER_BUFFER_SIZE)
+		Writer_Flush(self);
+	self->buffer[self->length++] = c;
+}
+
+static void Writer_WriteConstCharSpan(Writer* self, const ConstCharSpan span)
+{
+	Writer_Write(self, span.data, span.length);
+}
+
+static void Writer_WriteCString(Writer* self, const char* cstr)
+{
+	Writer_Write(self, cstr, strlen(cstr));
+}
+
+nullable_end
@@ -0,0 +1,52 @@
+#include "AllocationCounter.h"
+
+#include <stdatomic.h>
+
+#if BENCH_COUNT_ALLOCATIONS
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void* __wrap_malloc(size_t size);
+void* __wrap_calloc(size_t count, size_t size);
+void* __wrap_realloc(void* ptr, size_t size);
+
+static _Atomic size_t allocationCount;
+
+void* __wrap_malloc(const size_t size)
+{
+	atomic_fetch_add_explicit(&allocationCount, 1, memory_order_relaxed);
+	return __real_malloc(size);
+}
+
+void* __wrap_calloc(const size_t count, const size_t size)
+{
+	atomic_fetch_add_explicit(&allocationCount, 1, memory_order_relaxed);
+	return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, const size_t size)
+{
+	atomic_fetch_add_explicit(&allocationCount, 1, memory_order_relaxed);
+	return __real_realloc(ptr, size);
+}
+
+size_t AllocationCounter_Get(void)
+{
+	return atomic_load_explicit(&allocationCount, memory_order_relaxed);
+}
+
+bool AllocationCounter_IsEnabled(void)
+{
+	return true;
+}
+#else
+size_t AllocationCounter_Get(void)
+{
+	return 0;
+}
+
+bool AllocationCounter_IsEnabled(void)
+{
+	return false;
+}
+#endif
@@ -0,0 +1,9 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Number of malloc, calloc and realloc calls so far. Always 0 unless allocations are counted, which wraps the
+// allocator at link time (-Wl,--wrap) where the linker supports it.
+size_t AllocationCounter_Get(void);
+bool AllocationCounter_IsEnabled(void);
@@ -0,0 +1,391 @@
+#include "CorpusGenerator.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "Util/Managed.h"
+
+nullable_begin
+
+typedef enum
+{
+	CORPUS_STATEMENT_IDENTIFIERS,
+	CORPUS_STATEMENT_COMMENT,
+	CORPUS_STATEMENT_LITERAL,
+	CORPUS_STATEMENT_OPERATORS,
+	CORPUS_STATEMENT_MAX,
+} CorpusStatement;
+
+typedef struct
+{
+	String* output;
+	uint64_t state;
+} CorpusGenerator;
+
+// Relative weights of the statement kinds for each profile
+static const unsigned statementWeights[CORPUS_PROFILE_MAX][CORPUS_STATEMENT_MAX] = {
+	[CORPUS_PROFILE_IDENTIFIERS] = { 80, 5, 10, 5 },
+	[CORPUS_PROFILE_COMMENTS] = { 20, 60, 10, 10 },
+	[CORPUS_PROFILE_LITERALS] = { 15, 5, 70, 10 },
+	[CORPUS_PROFILE_OPERATORS] = { 15, 5, 10, 70 },
+};
+
+static const char* profileNames[CORPUS_PROFILE_MAX] = {
+	[CORPUS_PROFILE_IDENTIFIERS] = "identifiers",
+	[CORPUS_PROFILE_COMMENTS] = "comments",
+	[CORPUS_PROFILE_LITERALS] = "literals",
+	[CORPUS_PROFILE_OPERATORS] = "operators",
+};
+
+static const char* words[] = {
+	"count", "index", "buffer_length", "self", "result", "node", "next", "value", "element", "capacity",
+	"offset", "position", "source", "token", "parser", "lexer", "entry", "hash", "slot", "data",
+};
+
+static const char* typeNames[] = {
+	"int", "unsigned int", "size_t", "const char*", "struct node*", "double", "long long", "uint32_t",
+};
+
+static const char* binaryOperators[] = {
+	"+", "-", "*", "/", "%", "<<", ">>", "&", "|", "^", "&&", "||", "==", "!=", "<", ">", "<=", ">=",
+};
+
+static const char* assignmentOperators[] = {
+	"=", "+=", "-=", "*=", "/=", "%=", "<<=", ">>=", "&=", "|=", "^=",
+};
+
+static const char* commentWords[] = {
+	"the", "lexer", "keeps", "track", "of", "position", "and", "returns", "next", "token", "when", "buffer",
+	"is", "empty", "NOTE:", "TODO:", "this", "handles", "escape", "sequences", "correctly", "(see", "C11)",
+};
+
+#define COUNT_OF(array) (sizeof(array) / sizeof((array)[0]))
+
+static uint32_t CorpusGenerator_Next(CorpusGenerator* self)
+{
+	// xorshift64*
+	self->state ^= self->state >> 12;
+	self->state ^= self->state << 25;
+	self->state ^= self->state >> 27;
+	return (uint32_t)((self->state * 0x2545F4914F6CDD1Du) >> 32);
+}
+
+static uint32_t CorpusGenerator_Below(CorpusGenerator* self, const uint32_t bound)
+{
+	return CorpusGenerator_Next(self) % bound;
+}
+
+static void CorpusGenerator_Append(CorpusGenerator* self, const char* str)
+{
+	String_AppendCString(self->output, str);
+}
+
+static void CorpusGenerator_AppendFormat(CorpusGenerator* self, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+static void CorpusGenerator_AppendFormat(CorpusGenerator* self, const char* format, ...)
+{
+	char buffer[128];
+
+	va_list args;
+	va_start(args, format);
+	vsnprintf(buffer, sizeof(buffer), format, args);
+	va_end(args);
+
+	String_AppendCString(self->output, buffer);
+}
+
+static void CorpusGenerator_AppendIdentifier(CorpusGenerator* self)
+{
+	const char* word = words[CorpusGenerator_Below(self, COUNT_OF(words))];
+
+	// Mostly reuse a small vocabulary, but keep a tail of rarer names like real code has
+	if (CorpusGenerator_Below(self, 4) == 0)
+		CorpusGenerator_AppendFormat(self, "%s_%u", word, CorpusGenerator_Below(self, 1000));
+	else
+		CorpusGenerator_Append(self, word);
+}
+
+static void CorpusGenerator_AppendLiteral(CorpusGenerator* self)
+{
+	switch (CorpusGenerator_Below(self, 8))
+	{
+		case 0:
+			CorpusGenerator_AppendFormat(self, "%u", CorpusGenerator_Next(self) % 100000);
+			break;
+		case 1:
+			CorpusGenerator_AppendFormat(self, "0x%XU", CorpusGenerator_Next(self));
+			break;
+		case 2:
+			CorpusGenerator_AppendFormat(self, "0%oULL", CorpusGenerator_Next(self) % 4096);
+			break;
+		case 3:
+			CorpusGenerator_Append(self, CorpusGenerator_Below(self, 2) ? "0b10110011" : "0b1u");
+			break;
+		case 4:
+			CorpusGenerator_AppendFormat(self, "%u.%ue-%u", CorpusGenerator_Below(self, 1000), CorpusGenerator_Below(self, 100000),
+			                             CorpusGenerator_Below(self, 20));
+			break;
+		case 5:
+			CorpusGenerator_AppendFormat(self, "%u.%uf", CorpusGenerator_Below(self, 100), CorpusGenerator_Below(self, 1000));
+			break;
+		case 6:
+			CorpusGenerator_Append(self, CorpusGenerator_Below(self, 2) ? "\"value out of range: %zu\\n\"" : "\"quoted \\\"text\\\" here\"");
+			break;
+		default:
+			CorpusGenerator_Append(self, CorpusGenerator_Below(self, 2) ? "'\\n'" : "'x'");
+			break;
+	}
+}
+
+static void CorpusGenerator_AppendOperand(CorpusGenerator* self)
+{
+	if (CorpusGenerator_Below(self, 3) == 0)
+		CorpusGenerator_AppendLiteral(self);
+	else
+		CorpusGenerator_AppendIdentifier(self);
+}
+
+static void CorpusGenerator_AppendStatement(CorpusGenerator* self, const CorpusStatement statement)
+{
+	CorpusGenerator_Append(self, "\t");
+
+	switch (statement)
+	{
+		case CORPUS_STATEMENT_IDENTIFIERS:
+			switch (CorpusGenerator_Below(self, 3))
+			{
+				case 0:
+					CorpusGenerator_AppendFormat(self, "%s ", typeNames[CorpusGenerator_Below(self, COUNT_OF(typeNames))]);
+					CorpusGenerator_AppendIdentifier(self);
+					CorpusGenerator_Append(self, " = ");
+					CorpusGenerator_AppendIdentifier(self);
+					CorpusGenerator_Append(self, "(");
+					CorpusGenerator_AppendIdentifier(self);
+					CorpusGenerator_Append(self, ", ");
+					CorpusGenerator_AppendIdentifier(self);
+					CorpusGenerator_Append(self, ");\n");
+					break;
+				case 1:
+					CorpusGenerator_AppendIdentifier(self);
+					CorpusGenerator_Append(self, "->");
+					CorpusGenerator_AppendIdentifier(self);
+					CorpusGenerator_Append(self, " = ");
+					CorpusGenerator_AppendIdentifier(self);
+					CorpusGenerator_Append(self, ".");
+					CorpusGenerator_AppendIdentifier(self);
+					CorpusGenerator_Append(self, ";\n");
+					break;
+				default:
+					CorpusGenerator_Append(self, "if (");
+					CorpusGenerator_AppendIdentifier(self);
+					CorpusGenerator_Append(self, " == NULL)\n\t\treturn ");
+					CorpusGenerator_AppendIdentifier(self);
+					CorpusGenerator_Append(self, ";\n");
+					break;
+			}
+			break;
+		case CORPUS_STATEMENT_COMMENT:
+		{
+			const bool multiLine = CorpusGenerator_Below(self, 3) == 0;
+			CorpusGenerator_Append(self, multiLine ? "/*" : "//");
+
+			const uint32_t wordCount = 4 + CorpusGenerator_Below(self, 12);
+			for (uint32_t i = 0; i < wordCount; i++)
+			{
+				CorpusGenerator_Append(self, multiLine && i % 6 == 5 ? "\n\t * " : " ");
+				CorpusGenerator_Append(self, commentWords[CorpusGenerator_Below(self, COUNT_OF(commentWords))]);
+			}
+
+			CorpusGenerator_Append(self, multiLine ? " */\n" : "\n");
+			break;
+		}
+		case CORPUS_STATEMENT_LITERAL:
+			CorpusGenerator_AppendIdentifier(self);
+			CorpusGenerator_Append(self, " = ");
+			CorpusGenerator_AppendLiteral(self);
+			CorpusGenerator_Append(self, ";\n");
+			break;
+		case CORPUS_STATEMENT_OPERATORS:
+		{
+			CorpusGenerator_AppendIdentifier(self);
+			CorpusGenerator_AppendFormat(self, " %s ", assignmentOperators[CorpusGenerator_Below(self, COUNT_OF(assignmentOperators))]);
+
+			const uint32_t operandCount = 2 + CorpusGenerator_Below(self, 5);
+			for (uint32_t i = 0; i < operandCount; i++)
+			{
+				if (i != 0)
+					CorpusGenerator_AppendFormat(self, " %s ", binaryOperators[CorpusGenerator_Below(self, COUNT_OF(binaryOperators))]);
+
+				switch (CorpusGenerator_Below(self, 5))
+				{
+					case 0:
+						CorpusGenerator_Append(self, "(");
+						CorpusGenerator_AppendOperand(self);
+						CorpusGenerator_Append(self, " ? ");
+						CorpusGenerator_AppendOperand(self);
+						CorpusGenerator_Append(self, " : ");
+						CorpusGenerator_AppendOperand(self);
+						CorpusGenerator_Append(self, ")");
+						break;
+					case 1:
+						CorpusGenerator_Append(self, CorpusGenerator_Below(self, 2) ? "~" : "!");
+						CorpusGenerator_AppendOperand(self);
+						break;
+					case 2:
+						CorpusGenerator_AppendIdentifier(self);
+						CorpusGenerator_Append(self, CorpusGenerator_Below(self, 2) ? "++" : "--");
+						break;
+					case 3:
+						CorpusGenerator_AppendIdentifier(self);
+						CorpusGenerator_Append(self, "[");
+						CorpusGenerator_AppendOperand(self);
+						CorpusGenerator_Append(self, "]");
+						break;
+					default:
+						CorpusGenerator_AppendOperand(self);
+						break;
+				}
+			}
+
+			CorpusGenerator_Append(self, ";\n");
+			break;
+		}
+		default:
+			assert(false && "unreachable");
+	}
+}
+
+static void CorpusGenerator_AppendExpression(CorpusGenerator* self, const uint32_t depth)
+{
+	if (depth == 0)
+	{
+		CorpusGenerator_AppendOperand(self);
+		return;
+	}
+
+	switch (CorpusGenerator_Below(self, 10))
+	{
+		case 0:
+			CorpusGenerator_Append(self, "(");
+			CorpusGenerator_AppendExpression(self, depth - 1);
+			CorpusGenerator_Append(self, ")");
+			break;
+		case 1:
+			CorpusGenerator_Append(self, CorpusGenerator_Below(self, 2) ? "!" : "-");
+			CorpusGenerator_AppendExpression(self, depth - 1);
+			break;
+		case 2:
+			CorpusGenerator_AppendExpression(self, depth - 1);
+			CorpusGenerator_Append(self, " ? ");
+			CorpusGenerator_AppendExpression(self, depth - 1);
+			CorpusGenerator_Append(self, " : ");
+			CorpusGenerator_AppendExpression(self, depth - 1);
+			break;
+		case 3:
+		{
+			CorpusGenerator_AppendIdentifier(self);
+			CorpusGenerator_Append(self, "(");
+
+			const uint32_t argumentCount = CorpusGenerator_Below(self, 4);
+			for (uint32_t i = 0; i < argumentCount; i++)
+			{
+				if (i != 0)
+					CorpusGenerator_Append(self, ", ");
+				CorpusGenerator_AppendExpression(self, depth - 1);
+			}
+
+			CorpusGenerator_Append(self, ")");
+			break;
+		}
+		case 4:
+			CorpusGenerator_AppendIdentifier(self);
+			CorpusGenerator_Append(self, "[");
+			CorpusGenerator_AppendExpression(self, depth - 1);
+			CorpusGenerator_Append(self, "]");
+			break;
+		case 5:
+			CorpusGenerator_AppendIdentifier(self);
+			CorpusGenerator_AppendFormat(self, " %s ", assignmentOperators[CorpusGenerator_Below(self, COUNT_OF(assignmentOperators))]);
+			CorpusGenerator_AppendExpression(self, depth - 1);
+			break;
+		default:
+			CorpusGenerator_AppendExpression(self, depth - 1);
+			CorpusGenerator_AppendFormat(self, " %s ", binaryOperators[CorpusGenerator_Below(self, COUNT_OF(binaryOperators))]);
+			CorpusGenerator_AppendExpression(self, depth - 1);
+			break;
+	}
+}
+
+const char* CorpusProfile_ToString(const CorpusProfile profile)
+{
+	assert(profile < CORPUS_PROFILE_MAX);
+	return profileNames[profile];
+}
+
+bool CorpusProfile_FromString(const char* name, CorpusProfile* outProfile)
+{
+	for (size_t i = 0; i < CORPUS_PROFILE_MAX; i++)
+	{
+		if (strcmp(profileNames[i], name) == 0)
+		{
+			*outProfile = (CorpusProfile)i;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+String* CorpusGenerator_Generate(const CorpusProfile profile, const size_t size, const uint64_t seed)
+{
+	assert(profile < CORPUS_PROFILE_MAX);
+
+	CorpusGenerator generator = {
+		.output = NewWith(String, Capacity, size + 4096),
+		.state = seed != 0 ? seed : 1,
+	};
+
+	const unsigned* weights = statementWeights[profile];
+	unsigned totalWeight = 0;
+	for (size_t i = 0; i < CORPUS_STATEMENT_MAX; i++)
+		totalWeight += weights[i];
+
+	for (uint32_t function = 0; String_Length(generator.output) < size; function++)
+	{
+		CorpusGenerator_AppendFormat(&generator, "static int function_%u(struct node* self, size_t count)\n{\n", function);
+
+		const uint32_t statementCount = 4 + CorpusGenerator_Below(&generator, 24);
+		for (uint32_t i = 0; i < statementCount; i++)
+		{
+			unsigned pick = CorpusGenerator_Below(&generator, totalWeight);
+			size_t statement = 0;
+			while (pick >= weights[statement])
+				pick -= weights[statement++];
+
+			CorpusGenerator_AppendStatement(&generator, (CorpusStatement)statement);
+		}
+
+		CorpusGenerator_Append(&generator, "\treturn 0;\n}\n\n");
+	}
+
+	return generator.output;
+}
+
+String* CorpusGenerator_GenerateExpressions(const size_t size, const uint64_t seed)
+{
+	CorpusGenerator generator = {
+		.output = NewWith(String, Capacity, size + 4096),
+		.state = seed != 0 ? seed : 1,
+	};
+
+	while (String_Length(generator.output) < size)
+	{
+		CorpusGenerator_AppendExpression(&generator, 1 + CorpusGenerator_Below(&generator, 5));
+		CorpusGenerator_Append(&generator, ";\n");
+	}
+
+	return generator.output;
+}
+
+nullable_end
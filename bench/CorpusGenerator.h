@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "Util/String.h"
+
+nullable_begin
+
+typedef enum
+{
+	CORPUS_PROFILE_IDENTIFIERS,
+	CORPUS_PROFILE_COMMENTS,
+	CORPUS_PROFILE_LITERALS,
+	CORPUS_PROFILE_OPERATORS,
+	CORPUS_PROFILE_MAX,
+} CorpusProfile;
+
+const char* CorpusProfile_ToString(CorpusProfile profile);
+bool CorpusProfile_FromString(const char* name, CorpusProfile* outProfile);
+
+// Generates syntactically plausible C made of functions whose statements are weighted towards the profile.
+// Output is deterministic for a given seed and ends at a function boundary once at least size bytes are written.
+String* CorpusGenerator_Generate(CorpusProfile profile, size_t size, uint64_t seed);
+// Generates standalone expressions like tests/expression_test*.c, each terminated by ';'
+String* CorpusGenerator_GenerateExpressions(size_t size, uint64_t seed);
+
+nullable_end
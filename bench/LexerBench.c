@@ -0,0 +1,493 @@
+#include <time.h>
+
+#include "AllocationCounter.h"
+#include "CorpusGenerator.h"
+#include "Lexer.h"
+#include "ParallelLexer.h"
+#include "SourceFile.h"
+#include "Util/Managed.h"
+#include "Util/Scan.h"
+
+nullable_begin
+
+#define BENCH_DEFAULT_CORPUS_SIZE (8 * 1024 * 1024)
+#define BENCH_DEFAULT_SEED 12345
+#define BENCH_ITERATIONS 5
+// Small inputs are lexed repeatedly within an iteration so that the timer resolution does not dominate
+#define BENCH_MIN_BYTES_PER_ITERATION (32 * 1024 * 1024)
+#define BENCH_MIN_CHUNK_SIZE (256 * 1024)
+// Small enough that --verify splits even short test sources at every thread count
+#define BENCH_VERIFY_CHUNK_SIZE 16
+
+typedef struct
+{
+	const char* name;
+	size_t threadCount;
+	size_t bytes;
+	size_t tokenCount;
+	double seconds; // Best time for a single pass over the input
+	double allocationsPerToken;
+	size_t symbolCount;
+	size_t internerBytes;
+} LexerBench_Result;
+
+#define LIST_TYPE LexerBench_ResultList
+#define LIST_ELEMENT_TYPE LexerBench_Result
+nullable_end
+#include "Util/ListDef.h"
+nullable_begin
+#undef LIST_TYPE
+#undef LIST_ELEMENT_TYPE
+
+typedef struct
+{
+	size_t threadCount;
+	bool json;
+	bool verify;
+	size_t corpusSize;
+	uint64_t seed;
+	bool allProfiles;
+	CorpusProfile profile;
+	const char*nullable writePath;
+} LexerBench_Options;
+
+static double LexerBench_Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static size_t LexerBench_GetPassCount(const SourceFile* source)
+{
+	const size_t bytes = String_Length((String*)source->content);
+	return bytes < BENCH_MIN_BYTES_PER_ITERATION && bytes != 0 ? BENCH_MIN_BYTES_PER_ITERATION / bytes : 1;
+}
+
+static LexerBench_Result LexerBench_Run(const char* name, const SourceFile* source)
+{
+	LexerBench_Result result = { .name = name, .threadCount = 1, .bytes = String_Length((String*)source->content) };
+	const size_t passCount = LexerBench_GetPassCount(source);
+
+	for (size_t iteration = 0; iteration < BENCH_ITERATIONS; iteration++)
+	{
+		const double start = LexerBench_Now();
+
+		for (size_t pass = 0; pass < passCount; pass++)
+		{
+			const size_t allocationsBefore = AllocationCounter_Get();
+
+			using CompilerErrorList* errors = New(CompilerErrorList);
+			using Token_DataList* tokenData = New(Token_DataList);
+			using Interner* interner = New(Interner);
+			Lexer lexer = Lexer_Create(source, tokenData, interner, errors);
+
+			size_t tokenCount = 0;
+			while (Lexer_GetNextToken(&lexer, false, false).type != TOKEN_EOF)
+				tokenCount++;
+
+			result.tokenCount = tokenCount;
+			result.allocationsPerToken = (double)(AllocationCounter_Get() - allocationsBefore) / (double)(tokenCount + 1);
+			result.symbolCount = Interner_GetCount(interner);
+			result.internerBytes = Interner_GetMemoryUsage(interner);
+		}
+
+		const double elapsed = (LexerBench_Now() - start) / (double)passCount;
+		if (iteration == 0 || elapsed < result.seconds)
+			result.seconds = elapsed;
+	}
+
+	return result;
+}
+
+static void LexerBench_LexSequential(const SourceFile* source, TokenList* tokens, Token_DataList* tokenData, Interner* interner,
+                                     CompilerErrorList* errors)
+{
+	Lexer lexer = Lexer_Create(source, tokenData, interner, errors);
+	while (true)
+	{
+		const Token token = Lexer_GetNextToken(&lexer, false, false);
+		TokenList_AppendFromPtr(tokens, &token);
+		if (token.type == TOKEN_EOF)
+			break;
+	}
+}
+
+static bool LexerBench_SpansEqual(const ConstCharSpan first, const ConstCharSpan second)
+{
+	return first.data == second.data && first.length == second.length;
+}
+
+static bool LexerBench_TokenDataEqual(const uint8_t type, const Token_Data* first, const Token_Data* second)
+{
+	if (type == TOKEN_LITERAL_INTEGER)
+	{
+		const Token_LiteralInteger* a = &first->literalInteger;
+		const Token_LiteralInteger* b = &second->literalInteger;
+		return LexerBench_SpansEqual(a->value, b->value) && a->base == b->base && a->type == b->type && a->decoded == b->decoded;
+	}
+
+	const Token_LiteralFloat* a = &first->literalDecimalFloat;
+	const Token_LiteralFloat* b = &second->literalDecimalFloat;
+	return a->isHex == b->isHex && a->hasIntegerPart == b->hasIntegerPart && LexerBench_SpansEqual(a->integerPart, b->integerPart) &&
+	       a->hasFractionalPart == b->hasFractionalPart && LexerBench_SpansEqual(a->fractionalPart, b->fractionalPart) &&
+	       a->hasExponent == b->hasExponent && a->exponentIsNegative == b->exponentIsNegative &&
+	       LexerBench_SpansEqual(a->exponentPart, b->exponentPart) && a->type == b->type &&
+	       memcmp(&a->decoded, &b->decoded, sizeof(double)) == 0;
+}
+
+// Compares token kinds, spans, symbols and payloads, and the errors with their locations
+static bool LexerBench_MatchesSequential(const TokenList* tokens, const Token_DataList* tokenData, const CompilerErrorList* errors,
+                                         const TokenList* expectedTokens, const Token_DataList* expectedTokenData,
+                                         const CompilerErrorList* expectedErrors)
+{
+	if (tokens->size != expectedTokens->size || tokenData->size != expectedTokenData->size || errors->size != expectedErrors->size)
+		return false;
+
+	for (size_t i = 0; i < tokens->size; i++)
+	{
+		const Token* token = &tokens->data[i];
+		const Token* expected = &expectedTokens->data[i];
+		if (token->type != expected->type || token->offset != expected->offset || token->length != expected->length ||
+		    token->dataIndex != expected->dataIndex)
+			return false;
+
+		if (Token_HasData(token) &&
+		    !LexerBench_TokenDataEqual(token->type, &tokenData->data[token->dataIndex], &expectedTokenData->data[expected->dataIndex]))
+			return false;
+	}
+
+	for (size_t i = 0; i < errors->size; i++)
+	{
+		const CompilerError* error = &errors->data[i];
+		const CompilerError* expected = &expectedErrors->data[i];
+		if (error->message != expected->message || error->location.offset != expected->location.offset ||
+		    !LexerBench_SpansEqual(error->location.snippet, expected->location.snippet))
+			return false;
+	}
+
+	return true;
+}
+
+// Lexes with ParallelLexer and checks the result against a sequential Lexer run
+static LexerBench_Result LexerBench_RunParallel(const char* name, const SourceFile* source, const size_t threadCount)
+{
+	using CompilerErrorList* expectedErrors = New(CompilerErrorList);
+	using Token_DataList* expectedTokenData = New(Token_DataList);
+	using TokenList* expectedTokens = New(TokenList);
+	using Interner* expectedInterner = New(Interner);
+	LexerBench_LexSequential(source, expectedTokens, expectedTokenData, expectedInterner, expectedErrors);
+
+	LexerBench_Result result = {
+		.name = name,
+		.threadCount = threadCount,
+		.bytes = String_Length((String*)source->content),
+		.tokenCount = expectedTokens->size - 1,
+		.symbolCount = Interner_GetCount(expectedInterner),
+		.internerBytes = Interner_GetMemoryUsage(expectedInterner),
+	};
+
+	for (size_t iteration = 0; iteration < BENCH_ITERATIONS; iteration++)
+	{
+		const size_t allocationsBefore = AllocationCounter_Get();
+
+		using CompilerErrorList* errors = New(CompilerErrorList);
+		using Token_DataList* tokenData = New(Token_DataList);
+		using TokenList* tokens = New(TokenList);
+		using Interner* interner = New(Interner);
+
+		const double start = LexerBench_Now();
+		ParallelLexer_Tokenize(source, threadCount, BENCH_MIN_CHUNK_SIZE, tokens, tokenData, interner, errors);
+		const double elapsed = LexerBench_Now() - start;
+		if (iteration == 0 || elapsed < result.seconds)
+			result.seconds = elapsed;
+
+		result.allocationsPerToken = (double)(AllocationCounter_Get() - allocationsBefore) / (double)tokens->size;
+
+		if (!LexerBench_MatchesSequential(tokens, tokenData, errors, expectedTokens, expectedTokenData, expectedErrors))
+		{
+			fprintf(stderr, "%s: parallel lexing does not match sequential lexing\n", name);
+			exit(1);
+		}
+	}
+
+	return result;
+}
+
+// Checks ParallelLexer against a sequential Lexer run with tiny chunks on every thread count up to threadCount, so that
+// the speculative splits land on many different lines of the source
+static bool LexerBench_Verify(const char* name, const SourceFile* source, const size_t threadCount)
+{
+	using CompilerErrorList* expectedErrors = New(CompilerErrorList);
+	using Token_DataList* expectedTokenData = New(Token_DataList);
+	using TokenList* expectedTokens = New(TokenList);
+	using Interner* expectedInterner = New(Interner);
+	LexerBench_LexSequential(source, expectedTokens, expectedTokenData, expectedInterner, expectedErrors);
+
+	for (size_t threads = 2; threads <= threadCount; threads++)
+	{
+		using CompilerErrorList* errors = New(CompilerErrorList);
+		using Token_DataList* tokenData = New(Token_DataList);
+		using TokenList* tokens = New(TokenList);
+		using Interner* interner = New(Interner);
+		ParallelLexer_Tokenize(source, threads, BENCH_VERIFY_CHUNK_SIZE, tokens, tokenData, interner, errors);
+
+		if (!LexerBench_MatchesSequential(tokens, tokenData, errors, expectedTokens, expectedTokenData, expectedErrors))
+		{
+			fprintf(stderr, "%s: parallel lexing on %zu threads does not match sequential lexing\n", name, threads);
+			return false;
+		}
+	}
+
+	printf("%s: %zu tokens, %zu errors, parallel lexing on 2 to %zu threads matches\n", name, expectedTokens->size - 1,
+	       expectedErrors->size, threadCount);
+	return true;
+}
+
+// Returns false if the parallel lexer did not match the sequential one in --verify mode
+static bool LexerBench_RunAll(LexerBench_ResultList* results, const char* name, const SourceFile* source, const LexerBench_Options* options)
+{
+	if (options->verify)
+		return LexerBench_Verify(name, source, options->threadCount);
+
+	const LexerBench_Result result = LexerBench_Run(name, source);
+	LexerBench_ResultList_AppendFromPtr(results, &result);
+
+	if (options->threadCount > 1)
+	{
+		const LexerBench_Result parallelResult = LexerBench_RunParallel(name, source, options->threadCount);
+		LexerBench_ResultList_AppendFromPtr(results, &parallelResult);
+	}
+	return true;
+}
+
+static void LexerBench_PrintText(const LexerBench_ResultList* results)
+{
+	for (size_t i = 0; i < results->size; i++)
+	{
+		const LexerBench_Result* result = &results->data[i];
+		const double megabytes = (double)result->bytes / (1024.0 * 1024.0);
+
+		printf("%s: %zu thread(s), %.2f MB, %zu tokens, %.1f MB/s, %.2f Mtokens/s, %.4f allocs/token\n",
+		       result->name, result->threadCount, megabytes, result->tokenCount, megabytes / result->seconds,
+		       (double)result->tokenCount / result->seconds / 1e6, result->allocationsPerToken);
+
+		if (result->threadCount == 1)
+		{
+			printf("%s: %zu unique identifiers, %zu interner bytes, %.1f bytes/identifier\n",
+			       result->name, result->symbolCount, result->internerBytes,
+			       result->symbolCount != 0 ? (double)result->internerBytes / (double)result->symbolCount : 0.0);
+		}
+	}
+}
+
+static void LexerBench_PrintJsonString(const char* str)
+{
+	putchar('"');
+	for (; *str; str++)
+	{
+		if (*str == '"' || *str == '\\')
+			putchar('\\');
+		if ((unsigned char)*str < 0x20)
+			printf("\\u%04x", (unsigned char)*str);
+		else
+			putchar(*str);
+	}
+	putchar('"');
+}
+
+static void LexerBench_PrintJson(const LexerBench_ResultList* results)
+{
+	printf("{\n  \"scan\": \"%s\",\n  \"allocations_counted\": %s,\n  \"results\": [", Scan_GetImplementationName(),
+	       AllocationCounter_IsEnabled() ? "true" : "false");
+
+	for (size_t i = 0; i < results->size; i++)
+	{
+		const LexerBench_Result* result = &results->data[i];
+		const double megabytes = (double)result->bytes / (1024.0 * 1024.0);
+
+		printf("%s\n    {\"name\": ", i == 0 ? "" : ",");
+		LexerBench_PrintJsonString(result->name);
+		printf(", \"threads\": %zu, \"bytes\": %zu, \"tokens\": %zu, \"seconds\": %.9f, \"mb_per_s\": %.3f, \"tokens_per_s\": %.1f, "
+		       "\"allocs_per_token\": %.6f, \"unique_identifiers\": %zu, \"interner_bytes\": %zu}",
+		       result->threadCount, result->bytes, result->tokenCount, result->seconds, megabytes / result->seconds,
+		       (double)result->tokenCount / result->seconds, result->allocationsPerToken, result->symbolCount, result->internerBytes);
+	}
+
+	printf("\n  ]\n}\n");
+}
+
+// Parses a byte count with an optional K, M or G suffix
+static bool LexerBench_ParseSize(const char* str, size_t* outSize)
+{
+	char* end;
+	const unsigned long long value = strtoull(str, &end, 10);
+	if (end == str)
+		return false;
+
+	switch (*end)
+	{
+		case '\0':
+			*outSize = value;
+			return true;
+		case 'K':
+		case 'k':
+			*outSize = value * 1024;
+			break;
+		case 'M':
+		case 'm':
+			*outSize = value * 1024 * 1024;
+			break;
+		case 'G':
+		case 'g':
+			*outSize = value * 1024 * 1024 * 1024;
+			break;
+		default:
+			return false;
+	}
+
+	return end[1] == '\0';
+}
+
+static void LexerBench_PrintUsage(const char* program)
+{
+	fprintf(stderr,
+	        "Usage: %s [options] [files...]\n"
+	        "  --profile <identifiers|comments|literals|operators|all>  Generated corpus profile (default: all)\n"
+	        "  --size <bytes[K|M|G]>                                   Generated corpus size (default: 8M)\n"
+	        "  --seed <n>                                              Generator seed\n"
+	        "  --write <path>                                          Write the corpus of a single --profile to a file and exit\n"
+	        "  --threads <n>                                           Also run the parallel lexer with n threads\n"
+	        "  --verify                                                Only check the parallel lexer against the sequential\n"
+	        "                                                          one, with tiny chunks on 2 to n threads\n"
+	        "  --json                                                  Print results as JSON\n",
+	        program);
+}
+
+static int run(const CStringSpan args)
+{
+	LexerBench_Options options = {
+		.threadCount = 1,
+		.corpusSize = BENCH_DEFAULT_CORPUS_SIZE,
+		.seed = BENCH_DEFAULT_SEED,
+		.allProfiles = true,
+	};
+
+	size_t argIndex = 1;
+	for (; argIndex < args.length && strncmp(args.data[argIndex], "--", 2) == 0; argIndex++)
+	{
+		const char* option = args.data[argIndex];
+		const char* value = argIndex + 1 < args.length ? args.data[argIndex + 1] : NULL;
+
+		if (strcmp(option, "--json") == 0)
+		{
+			options.json = true;
+			continue;
+		}
+		if (strcmp(option, "--verify") == 0)
+		{
+			options.verify = true;
+			continue;
+		}
+
+		bool valid = value != NULL;
+		if (valid && strcmp(option, "--threads") == 0)
+			options.threadCount = strtoul(value, NULL, 10);
+		else if (valid && strcmp(option, "--seed") == 0)
+			options.seed = strtoull(value, NULL, 10);
+		else if (valid && strcmp(option, "--size") == 0)
+			valid = LexerBench_ParseSize(value, &options.corpusSize);
+		else if (valid && strcmp(option, "--write") == 0)
+			options.writePath = value;
+		else if (valid && strcmp(option, "--profile") == 0)
+		{
+			options.allProfiles = strcmp(value, "all") == 0;
+			valid = options.allProfiles || CorpusProfile_FromString(value, &options.profile);
+		}
+		else
+			valid = false;
+
+		if (!valid)
+		{
+			LexerBench_PrintUsage(args.data[0]);
+			return 1;
+		}
+
+		argIndex++;
+	}
+
+	// A written corpus is a single generated profile
+	if ((options.verify && (options.threadCount < 2 || options.json || options.writePath)) ||
+	    (options.writePath && (options.allProfiles || argIndex != args.length)))
+	{
+		LexerBench_PrintUsage(args.data[0]);
+		return 1;
+	}
+
+	using LexerBench_ResultList* results = New(LexerBench_ResultList);
+
+	if (argIndex == args.length)
+	{
+		for (size_t i = 0; i < CORPUS_PROFILE_MAX; i++)
+		{
+			const CorpusProfile profile = (CorpusProfile)i;
+			if (!options.allProfiles && profile != options.profile)
+				continue;
+
+			SourceFile source = {
+				.path = CorpusProfile_ToString(profile),
+				.content = CorpusGenerator_Generate(profile, options.corpusSize, options.seed),
+			};
+
+			if (options.writePath)
+			{
+				FILE* file = fopen(options.writePath, "wb");
+				if (file == NULL)
+				{
+					fprintf(stderr, "Failed to open output file: %s\n", options.writePath);
+					SourceFile_Fini(&source);
+					return 1;
+				}
+
+				fwrite(String_AsCString((String*)source.content), 1, String_Length((String*)source.content), file);
+				fclose(file);
+				SourceFile_Fini(&source);
+				return 0;
+			}
+
+			const bool matches = LexerBench_RunAll(results, source.path, &source, &options);
+			SourceFile_Fini(&source);
+			if (!matches)
+				return 1;
+		}
+	}
+
+	for (size_t i = argIndex; i < args.length; i++)
+	{
+		using const SourceFile* source = NewWith(SourceFile, Path, args.data[i]);
+		if (source->content == NULL)
+		{
+			fprintf(stderr, "Failed to open source file: %s\n", args.data[i]);
+			return 1;
+		}
+
+		if (!LexerBench_RunAll(results, source->path, source, &options))
+			return 1;
+	}
+
+	if (options.verify)
+		return 0;
+	if (options.json)
+		LexerBench_PrintJson(results);
+	else
+		LexerBench_PrintText(results);
+
+	return 0;
+}
+
+int main(const int argc, char*nonnull argv[])
+{
+	return run(CStringSpan_Create(argv, (size_t)argc));
+}
+
+nullable_end
@@ -0,0 +1,797 @@
+#include <time.h>
+#include <unistd.h>
+
+#include "AllocationCounter.h"
+#include "ConstantFolder.h"
+#include "CorpusGenerator.h"
+#include "ExpressionInterner.h"
+#include "FlatAst.h"
+#include "FlatAstFile.h"
+#include "IncrementalParser.h"
+#include "JsonExport.h"
+#include "Lexer.h"
+#include "ParallelParser.h"
+#include "Parser.h"
+#include "SourceFile.h"
+#include "Util/Managed.h"
+
+nullable_begin
+
+#define BENCH_DEFAULT_CORPUS_SIZE (4 * 1024 * 1024)
+#define BENCH_DEFAULT_SEED 12345
+#define BENCH_ITERATIONS 5
+#define BENCH_VERIFY_INTERVAL 100
+
+static double ParserBench_Now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Keeps the fastest timing of a step over the BENCH_ITERATIONS iterations
+static void ParserBench_KeepFastest(double* seconds, const size_t iteration, const double elapsed)
+{
+	if (iteration == 0 || elapsed < *seconds)
+		*seconds = elapsed;
+}
+
+// Parses every ';'-separated expression in the token list, with AST nodes allocated from an arena or the heap
+static void ParserBench_ParseCorpus(const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData, Arena*nullable arena,
+                                    CompilerErrorList* errors, AstExpressionList* expressions)
+{
+	Parser parser = Parser_Create(source, tokens, tokenData, arena, errors);
+	while (tokens->data[parser.currentTokenIndex].type != TOKEN_EOF)
+	{
+		AstExpression* expression = Parser_ParseExpression(&parser);
+		if (expression)
+			AstExpressionList_Append(expressions, expression);
+
+		// Skip the terminating ';', or the offending token after an error
+		parser.currentTokenIndex++;
+	}
+	Parser_Fini(&parser);
+}
+
+// Measures parsing the corpus and releasing its expressions, with AST nodes allocated from an arena or the heap
+static void ParserBench_Parse(const char* name, const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData,
+                              const bool useArena)
+{
+	double parseSeconds = 0.0;
+	double releaseSeconds = 0.0;
+	size_t expressionCount = 0;
+	size_t errorCount = 0;
+	size_t allocationCount = 0;
+
+	for (size_t iteration = 0; iteration < BENCH_ITERATIONS; iteration++)
+	{
+		using CompilerErrorList* errors = New(CompilerErrorList);
+		using AstExpressionList* expressions = New(AstExpressionList);
+		AstExpressionList_Reserve(expressions, tokens->size / 4);
+
+		const size_t allocationsBefore = AllocationCounter_Get();
+		const double parseStart = ParserBench_Now();
+
+		Arena*nullable arena = useArena ? New(Arena) : NULL;
+		ParserBench_ParseCorpus(source, tokens, tokenData, arena, errors, expressions);
+		const double parseElapsed = ParserBench_Now() - parseStart;
+		allocationCount = AllocationCounter_Get() - allocationsBefore;
+		expressionCount = expressions->size;
+		errorCount = errors->size;
+
+		const double releaseStart = ParserBench_Now();
+		for (size_t i = 0; i < expressions->size; i++)
+			Release(expressions->data[i]);
+		Release(arena);
+		const double releaseElapsed = ParserBench_Now() - releaseStart;
+
+		ParserBench_KeepFastest(&parseSeconds, iteration, parseElapsed);
+		ParserBench_KeepFastest(&releaseSeconds, iteration, releaseElapsed);
+	}
+
+	const double megabytes = (double)String_Length((String*)source->content) / (1024.0 * 1024.0);
+	printf("%s (%s): %zu expressions, %zu errors, parse %.1f MB/s, %.2f Mtokens/s, %.1f ns/expression; "
+	       "release %.1f ns/expression; %.3f allocs/expression\n",
+	       name, useArena ? "arena" : "heap", expressionCount, errorCount, megabytes / parseSeconds,
+	       (double)(tokens->size - 1) / parseSeconds / 1e6, parseSeconds * 1e9 / (double)expressionCount,
+	       releaseSeconds * 1e9 / (double)expressionCount, (double)allocationCount / (double)expressionCount);
+}
+
+// Measures how deep the parser nests for each expression: the most frames its explicit stack held while parsing it,
+// each standing for what was a nested call of the recursive descent parser
+static void ParserBench_Depth(const char* name, const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData)
+{
+	using CompilerErrorList* errors = New(CompilerErrorList);
+	using Arena* arena = New(Arena);
+	Parser parser = Parser_Create(source, tokens, tokenData, arena, errors);
+
+	size_t expressionCount = 0;
+	size_t totalDepth = 0;
+	size_t maxDepth = 0;
+	while (tokens->data[parser.currentTokenIndex].type != TOKEN_EOF)
+	{
+		parser.maxExpressionFrameCount = 0;
+		if (Parser_ParseExpression(&parser))
+		{
+			expressionCount++;
+			totalDepth += parser.maxExpressionFrameCount;
+			if (parser.maxExpressionFrameCount > maxDepth)
+				maxDepth = parser.maxExpressionFrameCount;
+		}
+
+		parser.currentTokenIndex++;
+	}
+	Parser_Fini(&parser);
+
+	printf("%s (depth): %zu expressions, parse depth %.1f frames/expression on average, %zu at most\n", name, expressionCount,
+	       (double)totalDepth / (double)expressionCount, maxDepth);
+}
+
+// Visits every node of the pointer tree, the way a recursive pass would
+static size_t ParserBench_WalkTree(const AstExpression* expression)
+{
+	switch (expression->type)
+	{
+		case AST_EXPR_UNARY:
+			return 1 + ParserBench_WalkTree(expression->data.unary.expression);
+		case AST_EXPR_BINARY:
+			return 1 + ParserBench_WalkTree(expression->data.binary.left) + ParserBench_WalkTree(expression->data.binary.right);
+		case AST_EXPR_TERNARY:
+			return 1 + ParserBench_WalkTree(expression->data.ternary.left) + ParserBench_WalkTree(expression->data.ternary.middle) +
+			       ParserBench_WalkTree(expression->data.ternary.right);
+		case AST_EXPR_CAST:
+			return 1 + ParserBench_WalkTree(expression->data.cast.expression);
+		case AST_EXPR_MEMBER_ACCESS:
+			return 1 + ParserBench_WalkTree(expression->data.memberAccess.expression);
+		case AST_EXPR_CALL:
+		{
+			size_t count = 1 + ParserBench_WalkTree(expression->data.call.callee);
+			for (size_t i = 0; i < expression->data.call.arguments->size; i++)
+				count += ParserBench_WalkTree(expression->data.call.arguments->data[i]);
+			return count;
+		}
+		default:
+			return 1;
+	}
+}
+
+static bool ParserBench_CountNode(void* context, const FlatAst* ast, const FlatAst_Node node)
+{
+	(void)ast;
+	(void)node;
+	(*(size_t*)context)++;
+	return true;
+}
+
+// Compares walking the pointer tree with walking the same expressions copied into a FlatAst
+static void ParserBench_Walk(const char* name, const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData)
+{
+	using CompilerErrorList* errors = New(CompilerErrorList);
+	using AstExpressionList* expressions = New(AstExpressionList);
+	using Arena* arena = New(Arena);
+	ParserBench_ParseCorpus(source, tokens, tokenData, arena, errors, expressions);
+
+	double flattenSeconds = 0.0;
+	double treeSeconds = 0.0;
+	double flatSeconds = 0.0;
+	size_t treeNodeCount = 0;
+	size_t flatNodeCount = 0;
+	size_t flatBytes = 0;
+
+	for (size_t iteration = 0; iteration < BENCH_ITERATIONS; iteration++)
+	{
+		const double flattenStart = ParserBench_Now();
+		FlatAst ast;
+		FlatAst_Init_WithSource(&ast, source);
+		for (size_t i = 0; i < expressions->size; i++)
+			FlatAst_AppendExpression(&ast, expressions->data[i]);
+		const double flattenElapsed = ParserBench_Now() - flattenStart;
+
+		const double treeStart = ParserBench_Now();
+		treeNodeCount = 0;
+		for (size_t i = 0; i < expressions->size; i++)
+			treeNodeCount += ParserBench_WalkTree(expressions->data[i]);
+		const double treeElapsed = ParserBench_Now() - treeStart;
+
+		const double flatStart = ParserBench_Now();
+		flatNodeCount = 0;
+		const FlatAst_Visitor visitor = { .context = &flatNodeCount, .enter = ParserBench_CountNode };
+		for (size_t i = 0; i < ast.roots.size; i++)
+			FlatAst_Walk(&ast, ast.roots.data[i], &visitor);
+		const double flatElapsed = ParserBench_Now() - flatStart;
+
+		flatBytes = ast.types.size * (sizeof(uint8_t) + sizeof(uint32_t) + sizeof(FlatAst_Span)) +
+		            ast.unaries.size * sizeof(FlatAst_Unary) + ast.binaries.size * sizeof(FlatAst_Binary) +
+		            ast.ternaries.size * sizeof(FlatAst_Ternary) + ast.casts.size * sizeof(FlatAst_Cast) +
+		            ast.sizeofTypes.size * sizeof(FlatAst_SizeofType) + ast.memberAccesses.size * sizeof(FlatAst_MemberAccess) +
+		            ast.calls.size * sizeof(FlatAst_Call) + ast.primaries.size * sizeof(FlatAst_Primary) +
+		            ast.arguments.size * sizeof(uint32_t) + ast.typeNames.size * sizeof(FlatAst_TypeName) +
+		            ast.typeSpecifiers.size * sizeof(FlatAst_TypeSpecifier);
+		FlatAst_Fini(&ast);
+
+		ParserBench_KeepFastest(&flattenSeconds, iteration, flattenElapsed);
+		ParserBench_KeepFastest(&treeSeconds, iteration, treeElapsed);
+		ParserBench_KeepFastest(&flatSeconds, iteration, flatElapsed);
+	}
+
+	if (treeNodeCount != flatNodeCount)
+		fprintf(stderr, "%s: flat walk visited %zu nodes, tree walk %zu\n", name, flatNodeCount, treeNodeCount);
+
+	printf("%s (flat): %zu nodes, flatten %.1f ns/node, walk tree %.1f ns/node, walk flat %.1f ns/node; "
+	       "%.1f bytes/node flat, %.1f bytes/node in the arena\n",
+	       name, flatNodeCount, flattenSeconds * 1e9 / (double)flatNodeCount, treeSeconds * 1e9 / (double)treeNodeCount,
+	       flatSeconds * 1e9 / (double)flatNodeCount, (double)flatBytes / (double)flatNodeCount,
+	       (double)Arena_GetMemoryUsage(arena) / (double)treeNodeCount);
+}
+
+// Saves the expressions as a FlatAst file and loads it back; loading maps the file and validates it
+static void ParserBench_File(const char* name, const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData,
+                             const Interner* interner)
+{
+	using CompilerErrorList* errors = New(CompilerErrorList);
+	using AstExpressionList* expressions = New(AstExpressionList);
+	using Arena* arena = New(Arena);
+	ParserBench_ParseCorpus(source, tokens, tokenData, arena, errors, expressions);
+	FlatAst ast;
+	FlatAst_Init_WithSource(&ast, source);
+	for (size_t i = 0; i < expressions->size; i++)
+		FlatAst_AppendExpression(&ast, expressions->data[i]);
+
+	char path[] = "/tmp/ParserBench-XXXXXX";
+	const int fd = mkstemp(path);
+	if (fd < 0)
+	{
+		fprintf(stderr, "%s: failed to create a temporary file\n", name);
+		FlatAst_Fini(&ast);
+		return;
+	}
+	close(fd);
+
+	double writeSeconds = 0.0;
+	double loadSeconds = 0.0;
+	double walkSeconds = 0.0;
+	size_t fileSize = 0;
+	size_t nodeCount = 0;
+	for (size_t iteration = 0; iteration < BENCH_ITERATIONS; iteration++)
+	{
+		const double writeStart = ParserBench_Now();
+		const bool isWritten = FlatAstFile_Write(&ast, interner, path);
+		const double writeElapsed = ParserBench_Now() - writeStart;
+
+		const double loadStart = ParserBench_Now();
+		FlatAstFile file;
+		FlatAstFile_Init_WithPath(&file, path, source);
+		const double loadElapsed = ParserBench_Now() - loadStart;
+		if (!isWritten || !file.data)
+		{
+			fprintf(stderr, "%s: failed to write or load %s\n", name, path);
+			break;
+		}
+
+		const double walkStart = ParserBench_Now();
+		nodeCount = 0;
+		const FlatAst_Visitor visitor = { .context = &nodeCount, .enter = ParserBench_CountNode };
+		for (size_t i = 0; i < file.ast.roots.size; i++)
+			FlatAst_Walk(&file.ast, file.ast.roots.data[i], &visitor);
+		const double walkElapsed = ParserBench_Now() - walkStart;
+
+		fileSize = file.size;
+		FlatAstFile_Fini(&file);
+
+		ParserBench_KeepFastest(&writeSeconds, iteration, writeElapsed);
+		ParserBench_KeepFastest(&loadSeconds, iteration, loadElapsed);
+		ParserBench_KeepFastest(&walkSeconds, iteration, walkElapsed);
+	}
+
+	if (nodeCount != FlatAst_GetNodeCount(&ast))
+		fprintf(stderr, "%s: loaded file has %zu nodes, saved AST %zu\n", name, nodeCount, FlatAst_GetNodeCount(&ast));
+
+	printf("%s (file): %zu nodes, %.1f bytes/node on disk, write %.1f ns/node, load %.1f us, walk loaded %.1f ns/node\n",
+	       name, nodeCount, (double)fileSize / (double)nodeCount, writeSeconds * 1e9 / (double)nodeCount, loadSeconds * 1e6,
+	       walkSeconds * 1e9 / (double)nodeCount);
+
+	unlink(path);
+	FlatAst_Fini(&ast);
+}
+
+// Writes the tokens and the expressions as JSON to a temporary file, the way --emit-tokens=json and --emit-ast=json do
+static void ParserBench_Json(const char* name, const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData)
+{
+	using CompilerErrorList* errors = New(CompilerErrorList);
+	using AstExpressionList* expressions = New(AstExpressionList);
+	using Arena* arena = New(Arena);
+	ParserBench_ParseCorpus(source, tokens, tokenData, arena, errors, expressions);
+	FlatAst ast;
+	FlatAst_Init_WithSource(&ast, source);
+	for (size_t i = 0; i < expressions->size; i++)
+		FlatAst_AppendExpression(&ast, expressions->data[i]);
+
+	char path[] = "/tmp/ParserBench-XXXXXX";
+	const int fd = mkstemp(path);
+	if (fd < 0)
+	{
+		fprintf(stderr, "%s: failed to create a temporary file\n", name);
+		FlatAst_Fini(&ast);
+		return;
+	}
+
+	double tokenSeconds = 0.0;
+	double astSeconds = 0.0;
+	size_t tokenBytes = 0;
+	size_t astBytes = 0;
+	for (size_t iteration = 0; iteration < BENCH_ITERATIONS; iteration++)
+	{
+		// The file is emptied before each document, so its size is the size of the document
+		if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0)
+			break;
+		const double tokenStart = ParserBench_Now();
+		{
+			using Writer* output = NewWith(Writer, Fd, fd);
+			JsonWriter json = JsonWriter_Create(output);
+			JsonWriter_BeginArray(&json);
+			for (size_t i = 0; i < tokens->size; i++)
+				JsonExport_WriteToken(&json, &tokens->data[i], source, tokenData);
+			JsonWriter_EndArray(&json);
+		}
+		const double tokenElapsed = ParserBench_Now() - tokenStart;
+		tokenBytes = (size_t)lseek(fd, 0, SEEK_CUR);
+
+		if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0)
+			break;
+		const double astStart = ParserBench_Now();
+		{
+			using Writer* output = NewWith(Writer, Fd, fd);
+			JsonWriter json = JsonWriter_Create(output);
+			JsonWriter_BeginArray(&json);
+			for (size_t i = 0; i < ast.roots.size; i++)
+				JsonExport_WriteExpression(&json, &ast, ast.roots.data[i]);
+			JsonWriter_EndArray(&json);
+		}
+		const double astElapsed = ParserBench_Now() - astStart;
+		astBytes = (size_t)lseek(fd, 0, SEEK_CUR);
+
+		ParserBench_KeepFastest(&tokenSeconds, iteration, tokenElapsed);
+		ParserBench_KeepFastest(&astSeconds, iteration, astElapsed);
+	}
+
+	const size_t nodeCount = FlatAst_GetNodeCount(&ast);
+	printf("%s (json): tokens %.1f MB at %.0f MB/s, %zu nodes %.1f MB at %.0f MB/s (%.1f bytes/node)\n", name,
+	       (double)tokenBytes / (1024.0 * 1024.0), (double)tokenBytes / (1024.0 * 1024.0) / tokenSeconds, nodeCount,
+	       (double)astBytes / (1024.0 * 1024.0), (double)astBytes / (1024.0 * 1024.0) / astSeconds,
+	       (double)astBytes / (double)nodeCount);
+
+	close(fd);
+	unlink(path);
+	FlatAst_Fini(&ast);
+}
+
+// Folds the constant subexpressions of every expression; each iteration folds a fresh parse, as folding is in place
+static void ParserBench_Fold(const char* name, const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData)
+{
+	double seconds = 0.0;
+	size_t nodeCount = 0;
+	size_t foldedNodeCount = 0;
+	size_t remainingNodeCount = 0;
+	for (size_t iteration = 0; iteration < BENCH_ITERATIONS; iteration++)
+	{
+		using CompilerErrorList* errors = New(CompilerErrorList);
+		using AstExpressionList* expressions = New(AstExpressionList);
+		using Arena* arena = New(Arena);
+		ParserBench_ParseCorpus(source, tokens, tokenData, arena, errors, expressions);
+
+		nodeCount = 0;
+		for (size_t i = 0; i < expressions->size; i++)
+			nodeCount += ParserBench_WalkTree(expressions->data[i]);
+
+		ConstantFolder folder = ConstantFolder_Create(arena);
+		const double start = ParserBench_Now();
+		for (size_t i = 0; i < expressions->size; i++)
+			expressions->data[i] = ConstantFolder_Fold(&folder, expressions->data[i]);
+		const double elapsed = ParserBench_Now() - start;
+
+		foldedNodeCount = folder.foldedNodeCount;
+		remainingNodeCount = 0;
+		for (size_t i = 0; i < expressions->size; i++)
+			remainingNodeCount += ParserBench_WalkTree(expressions->data[i]);
+
+		ParserBench_KeepFastest(&seconds, iteration, elapsed);
+	}
+
+	printf("%s (fold): %zu nodes, %zu folded constants, %zu nodes left (%.1f%%), fold %.1f ns/node\n", name, nodeCount, foldedNodeCount,
+	       remainingNodeCount, 100.0 * (double)remainingNodeCount / (double)nodeCount, seconds * 1e9 / (double)nodeCount);
+}
+
+// Shares equal subexpressions of refcounted expressions across the whole corpus, releasing the duplicates
+static void ParserBench_Share(const char* name, const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData)
+{
+	double seconds = 0.0;
+	size_t nodeCount = 0;
+	size_t sharedNodeCount = 0;
+	size_t uniqueNodeCount = 0;
+	for (size_t iteration = 0; iteration < BENCH_ITERATIONS; iteration++)
+	{
+		using CompilerErrorList* errors = New(CompilerErrorList);
+		using AstExpressionList* expressions = New(AstExpressionList);
+		ParserBench_ParseCorpus(source, tokens, tokenData, NULL, errors, expressions);
+
+		nodeCount = 0;
+		for (size_t i = 0; i < expressions->size; i++)
+			nodeCount += ParserBench_WalkTree(expressions->data[i]);
+
+		using ExpressionInterner* interner = New(ExpressionInterner);
+		const double start = ParserBench_Now();
+		for (size_t i = 0; i < expressions->size; i++)
+			expressions->data[i] = ExpressionInterner_Intern(interner, expressions->data[i]);
+		const double elapsed = ParserBench_Now() - start;
+
+		sharedNodeCount = interner->sharedNodeCount;
+		uniqueNodeCount = ExpressionInterner_GetCount(interner);
+		for (size_t i = 0; i < expressions->size; i++)
+			Release(expressions->data[i]);
+
+		ParserBench_KeepFastest(&seconds, iteration, elapsed);
+	}
+
+	// Every live node is in the interner, so its count is what is left on the heap
+	printf("%s (share): %zu nodes, %zu shared, %zu distinct (%.1f%%), node memory %.1f KB -> %.1f KB, share %.1f ns/node\n", name,
+	       nodeCount, sharedNodeCount, uniqueNodeCount, 100.0 * (double)uniqueNodeCount / (double)nodeCount,
+	       (double)(nodeCount * sizeof(AstExpression)) / 1024.0, (double)(uniqueNodeCount * sizeof(AstExpression)) / 1024.0,
+	       seconds * 1e9 / (double)nodeCount);
+}
+
+// Parses the corpus as top-level items with ParallelParser, on one thread and on threadCount threads
+static void ParserBench_ParseParallel(const char* name, const SourceFile* source, TokenList* tokens, const Token_DataList* tokenData,
+                                      const size_t threadCount)
+{
+	const size_t threadCounts[] = { 1, threadCount };
+	double sequentialSeconds = 0.0;
+	for (size_t run = 0; run < 2; run++)
+	{
+		double seconds = 0.0;
+		size_t itemCount = 0;
+		size_t errorCount = 0;
+		for (size_t iteration = 0; iteration < BENCH_ITERATIONS; iteration++)
+		{
+			using CompilerErrorList* errors = New(CompilerErrorList);
+			const double start = ParserBench_Now();
+			ParallelParser_Result* result = ParallelParser_Parse(source, tokens, tokenData, threadCounts[run], 0, errors);
+			const double elapsed = ParserBench_Now() - start;
+
+			itemCount = result->items.size;
+			errorCount = errors->size;
+			Release(result);
+
+			ParserBench_KeepFastest(&seconds, iteration, elapsed);
+		}
+
+		if (run == 0)
+			sequentialSeconds = seconds;
+		printf("%s (%zu threads): %zu items, %zu errors, parse %.1f MB/s, %.2fx\n", name, threadCounts[run], itemCount, errorCount,
+		       (double)String_Length((String*)source->content) / (1024.0 * 1024.0) / seconds, sequentialSeconds / seconds);
+	}
+}
+
+// Appends what must not change between a full and an incremental parse: item kinds and the types and document offsets
+// of expression nodes
+static void ParserBench_AppendSignature(SizeList* signature, const SourceFile* source, const AstDeclaration*nullable declaration,
+                                        const AstStatement*nullable statement, const size_t start)
+{
+	if (declaration)
+	{
+		SizeList_Append(signature, 0);
+		SizeList_Append(signature, start + declaration->location.offset);
+		return;
+	}
+
+	SizeList_Append(signature, 1);
+	SizeList_Append(signature, start + statement->location.offset);
+	if (!statement->data.expression.expression)
+		return;
+
+	FlatAst ast;
+	FlatAst_Init_WithSource(&ast, source);
+	FlatAst_AppendExpression(&ast, statement->data.expression.expression);
+	for (FlatAst_Node node = 0; node < FlatAst_GetNodeCount(&ast); node++)
+	{
+		SizeList_Append(signature, FlatAst_GetType(&ast, node));
+		SizeList_Append(signature, start + FlatAst_GetLocation(&ast, node).offset);
+	}
+	FlatAst_Fini(&ast);
+}
+
+// Errors as (offset, message) pairs, which are compared sorted
+static void ParserBench_AppendErrors(SizeList* errors, const CompilerErrorList* errorList, const size_t start)
+{
+	for (size_t i = 0; i < errorList->size; i++)
+	{
+		SizeList_Append(errors, start + errorList->data[i].location.offset);
+		SizeList_Append(errors, (size_t)(uintptr_t)errorList->data[i].message);
+	}
+}
+
+static int ParserBench_CompareErrors(const void* first, const void* second)
+{
+	const size_t* a = (const size_t*)first;
+	const size_t* b = (const size_t*)second;
+	if (a[0] != b[0])
+		return a[0] < b[0] ? -1 : 1;
+	return a[1] < b[1] ? -1 : a[1] > b[1];
+}
+
+static bool ParserBench_SizeListsEqual(const SizeList* first, const SizeList* second)
+{
+	return first->size == second->size && memcmp(first->data, second->data, first->size * sizeof(size_t)) == 0;
+}
+
+// Checks an incremental parse against lexing and parsing its whole text from scratch
+static bool ParserBench_VerifyIncremental(const IncrementalParser* incremental, double* outFullSeconds)
+{
+	using SizeList* expected = New(SizeList);
+	using SizeList* actual = New(SizeList);
+	using SizeList* expectedErrors = New(SizeList);
+	using SizeList* actualErrors = New(SizeList);
+
+	SourceFile source = { .path = incremental->path, .content = IncrementalParser_GetText(incremental) };
+	{
+		using CompilerErrorList* errors = New(CompilerErrorList);
+		using Token_DataList* tokenData = New(Token_DataList);
+		using TokenList* tokens = New(TokenList);
+		using Interner* interner = New(Interner);
+
+		const double start = ParserBench_Now();
+		Lexer lexer = Lexer_Create(&source, tokenData, interner, errors);
+		while (true)
+		{
+			const Token token = Lexer_GetNextToken(&lexer, false, false);
+			TokenList_AppendFromPtr(tokens, &token);
+			if (token.type == TOKEN_EOF)
+				break;
+		}
+		using ParallelParser_Result* result = ParallelParser_Parse(&source, tokens, tokenData, 1, 0, errors);
+		*outFullSeconds = ParserBench_Now() - start;
+
+		for (size_t i = 0; i < result->items.size; i++)
+			ParserBench_AppendSignature(expected, &source, result->items.data[i].declaration, result->items.data[i].statement, 0);
+		ParserBench_AppendErrors(expectedErrors, errors, 0);
+	}
+
+	for (size_t i = 0; i < incremental->items.size; i++)
+	{
+		const IncrementalParser_Item* item = incremental->items.data[i];
+		if (item->declaration || item->statement)
+			ParserBench_AppendSignature(actual, &item->source, item->declaration, item->statement, item->start);
+		ParserBench_AppendErrors(actualErrors, item->errors, item->start);
+	}
+	SourceFile_Fini(&source);
+
+	qsort(expectedErrors->data, expectedErrors->size / 2, 2 * sizeof(size_t), ParserBench_CompareErrors);
+	qsort(actualErrors->data, actualErrors->size / 2, 2 * sizeof(size_t), ParserBench_CompareErrors);
+	return ParserBench_SizeListsEqual(expected, actual) && ParserBench_SizeListsEqual(expectedErrors, actualErrors);
+}
+
+// Checks the incremental parse against a full parse after an edit, adding up the time of the full parses
+static bool ParserBench_VerifyEdit(const char* name, const IncrementalParser* incremental, const size_t editNumber,
+                                   double* fullSeconds, size_t* verifyCount)
+{
+	double seconds = 0.0;
+	const bool isValid = ParserBench_VerifyIncremental(incremental, &seconds);
+	*fullSeconds += seconds;
+	(*verifyCount)++;
+	if (!isValid)
+		fprintf(stderr, "%s: incremental parse differs from a full parse after edit %zu\n", name, editNumber);
+	return isValid;
+}
+
+// Applies random small edits to the corpus with IncrementalParser, checking the result against a full parse now and then
+static bool ParserBench_Incremental(const char* name, const SourceFile* source, const size_t editCount, const uint64_t seed)
+{
+	// Most edits keep brackets balanced and literals whole, as an editor does when typing. The rest may also break a
+	// literal or a bracket, after which the text can lex or split into items differently up to its end.
+	static const char* const insertions[] = { " ", "\n", "x", "1", ";", "+", "*", "(1)", "f()", "= 2", "typedef int x;", "int y;",
+		                                      "(", ")", "{", "]", "\"", "'", "\\" };
+	static const size_t balancedInsertionCount = 12;
+
+	IncrementalParser incremental;
+	double start = ParserBench_Now();
+	IncrementalParser_Init_WithSource(&incremental, source);
+	const double initialSeconds = ParserBench_Now() - start;
+	const size_t initialLexedBytes = incremental.lexedBytes;
+	const size_t initialParsedItems = incremental.parsedItems;
+
+	// xorshift64*
+	uint64_t state = seed != 0 ? seed : 1;
+	double editSeconds = 0.0;
+	double unrestrictedSeconds = 0.0;
+	double fullSeconds = 0.0;
+	size_t unrestrictedCount = 0;
+	size_t verifyCount = 0;
+	bool isValid = true;
+	for (size_t i = 0; i < editCount && isValid; i++)
+	{
+		uint64_t random[4];
+		for (size_t j = 0; j < 4; j++)
+		{
+			state ^= state >> 12;
+			state ^= state << 25;
+			state ^= state >> 27;
+			random[j] = state * 0x2545F4914F6CDD1DULL;
+		}
+
+		const bool isUnrestricted = random[3] % 8 == 0;
+		const size_t insertionCount = isUnrestricted ? sizeof(insertions) / sizeof(insertions[0]) : balancedInsertionCount;
+		IncrementalParser_Edit edit = { .offset = (size_t)(random[0] % (incremental.length + 1)) };
+		if (random[1] % 3 != 0)
+		{
+			const char* insertion = insertions[random[2] % insertionCount];
+			edit.text = ConstCharSpan_Create(insertion, strlen(insertion));
+		}
+		if (random[1] % 3 != 1)
+			edit.length = (size_t)(random[2] >> 32) % 8;
+
+		using String* text = IncrementalParser_GetText(&incremental);
+		const ConstCharSpan content = String_AsConstCharSpan(text);
+		if (edit.length > content.length - edit.offset)
+			edit.length = content.length - edit.offset;
+
+		// Other edits stay out of lines with literals, where a deleted escape or an inserted line break ends the literal
+		if (!isUnrestricted)
+		{
+			size_t lineStart = edit.offset;
+			while (lineStart > 0 && content.data[lineStart - 1] != '\n')
+				lineStart--;
+			for (size_t j = lineStart; j < content.length && content.data[j] != '\n'; j++)
+			{
+				if (content.data[j] == '"' || content.data[j] == '\'')
+				{
+					edit.text = ConstCharSpan_Empty;
+					edit.length = 0;
+					break;
+				}
+			}
+
+			for (size_t j = 0; j < edit.length; j++)
+			{
+				if (strchr("()[]{}", content.data[edit.offset + j]))
+				{
+					edit.length = j;
+					break;
+				}
+			}
+		}
+
+		start = ParserBench_Now();
+		IncrementalParser_ApplyEdits(&incremental, &edit, 1);
+		const double elapsed = ParserBench_Now() - start;
+
+		// An unrestricted edit is checked and then undone, so that the edits after it work on text like the corpus
+		if (isUnrestricted)
+		{
+			isValid = ParserBench_VerifyEdit(name, &incremental, i + 1, &fullSeconds, &verifyCount);
+			const IncrementalParser_Edit undo = {
+				.offset = edit.offset,
+				.length = edit.text.length,
+				.text = ConstCharSpan_Create(content.data + edit.offset, edit.length),
+			};
+			start = ParserBench_Now();
+			IncrementalParser_ApplyEdits(&incremental, &undo, 1);
+			unrestrictedSeconds += elapsed + ParserBench_Now() - start;
+			unrestrictedCount++;
+		}
+		else
+			editSeconds += elapsed;
+
+		if (isValid && (isUnrestricted || (i + 1) % BENCH_VERIFY_INTERVAL == 0 || i + 1 == editCount))
+			isValid = ParserBench_VerifyEdit(name, &incremental, i + 1, &fullSeconds, &verifyCount);
+	}
+
+	if (isValid && editCount != 0)
+	{
+		const size_t appliedCount = editCount + unrestrictedCount;
+		const size_t restrictedCount = editCount - unrestrictedCount;
+		printf("%s (incremental): %zu items, initial parse %.1f ms, %zu edits at %.1f us/edit, %zu unrestricted edits and undos "
+		       "at %.1f us/edit vs %.1f ms full parse, %.1f bytes lexed and %.2f items parsed per edit\n",
+		       name, incremental.items.size, initialSeconds * 1e3, restrictedCount,
+		       restrictedCount != 0 ? editSeconds * 1e6 / (double)restrictedCount : 0.0, unrestrictedCount,
+		       unrestrictedCount != 0 ? unrestrictedSeconds * 1e6 / (double)(2 * unrestrictedCount) : 0.0,
+		       fullSeconds * 1e3 / (double)verifyCount,
+		       (double)(incremental.lexedBytes - initialLexedBytes) / (double)appliedCount,
+		       (double)(incremental.parsedItems - initialParsedItems) / (double)appliedCount);
+	}
+
+	IncrementalParser_Fini(&incremental);
+	return isValid;
+}
+
+static bool ParserBench_Run(const char* name, const SourceFile* source, const size_t threadCount, const size_t editCount,
+                            const uint64_t seed)
+{
+	using CompilerErrorList* lexerErrors = New(CompilerErrorList);
+	using Token_DataList* tokenData = New(Token_DataList);
+	using TokenList* tokens = New(TokenList);
+	using Interner* interner = New(Interner);
+	Lexer lexer = Lexer_Create(source, tokenData, interner, lexerErrors);
+	while (true)
+	{
+		const Token token = Lexer_GetNextToken(&lexer, false, false);
+		TokenList_AppendFromPtr(tokens, &token);
+		if (token.type == TOKEN_EOF)
+			break;
+	}
+
+	printf("%s: %.2f MB, %zu tokens\n", name, (double)String_Length((String*)source->content) / (1024.0 * 1024.0), tokens->size - 1);
+	ParserBench_Parse(name, source, tokens, tokenData, false);
+	ParserBench_Parse(name, source, tokens, tokenData, true);
+	ParserBench_Depth(name, source, tokens, tokenData);
+	ParserBench_Walk(name, source, tokens, tokenData);
+	ParserBench_File(name, source, tokens, tokenData, interner);
+	ParserBench_Json(name, source, tokens, tokenData);
+	ParserBench_Fold(name, source, tokens, tokenData);
+	ParserBench_Share(name, source, tokens, tokenData);
+	if (threadCount != 0)
+		ParserBench_ParseParallel(name, source, tokens, tokenData, threadCount);
+	return editCount == 0 || ParserBench_Incremental(name, source, editCount, seed);
+}
+
+static int run(const CStringSpan args)
+{
+	size_t corpusSize = BENCH_DEFAULT_CORPUS_SIZE;
+	uint64_t seed = BENCH_DEFAULT_SEED;
+	size_t threadCount = 0;
+	size_t editCount = 0;
+
+	size_t argIndex = 1;
+	for (; argIndex + 1 < args.length && strncmp(args.data[argIndex], "--", 2) == 0; argIndex += 2)
+	{
+		if (strcmp(args.data[argIndex], "--size") == 0)
+			corpusSize = strtoull(args.data[argIndex + 1], NULL, 10);
+		else if (strcmp(args.data[argIndex], "--seed") == 0)
+			seed = strtoull(args.data[argIndex + 1], NULL, 10);
+		else if (strcmp(args.data[argIndex], "--threads") == 0)
+			threadCount = strtoull(args.data[argIndex + 1], NULL, 10);
+		else if (strcmp(args.data[argIndex], "--edits") == 0)
+			editCount = strtoull(args.data[argIndex + 1], NULL, 10);
+		else
+			break;
+	}
+
+	if (argIndex < args.length && strncmp(args.data[argIndex], "--", 2) == 0)
+	{
+		fprintf(stderr, "Usage: %s [--size <bytes>] [--seed <n>] [--threads <n>] [--edits <n>] [files...]\n", args.data[0]);
+		return 1;
+	}
+
+	if (argIndex == args.length)
+	{
+		SourceFile source = {
+			.path = "expressions",
+			.content = CorpusGenerator_GenerateExpressions(corpusSize, seed),
+		};
+
+		const bool isValid = ParserBench_Run(source.path, &source, threadCount, editCount, seed);
+		SourceFile_Fini(&source);
+		if (!isValid)
+			return 1;
+	}
+
+	for (size_t i = argIndex; i < args.length; i++)
+	{
+		using const SourceFile* source = NewWith(SourceFile, Path, args.data[i]);
+		if (source->content == NULL)
+		{
+			fprintf(stderr, "Failed to open source file: %s\n", args.data[i]);
+			return 1;
+		}
+
+		if (!ParserBench_Run(source->path, source, threadCount, editCount, seed))
+			return 1;
+	}
+
+	return 0;
+}
+
+int main(const int argc, char*nonnull argv[])
+{
+	return run(CStringSpan_Create(argv, (size_t)argc));
+}
+
+nullable_end
@@ -1,282 +1,441 @@
+#include <inttypes.h>
+#include <unistd.h>
+
+#include "ConstantFolder.h"
+#include "ExpressionInterner.h"
+#include "FlatAst.h"
+#include "FlatAstFile.h"
+#include "JsonExport.h"
 #include "Lexer.h"
+#include "ParallelLexer.h"
+#include "ParallelParser.h"
 #include "Parser.h"
 #include "SourceFile.h"
 #include "Util/Array.h"
 #include "Util/Managed.h"
+#include "Util/Writer.h"
 
 nullable_begin
 
+// Streams the dump into output as it walks the tree
 typedef struct
 {
 	size_t indent;
-	String output;
+	Writer* output;
 } AstPrinter;
 
-static AstPrinter AstPrinter_Create(void)
+static AstPrinter AstPrinter_Create(Writer* output)
 {
 	AstPrinter printer;
 	printer.indent = 0;
-	String_Init(&printer.output);
+	printer.output = output;
 	return printer;
 }
 
-static void AstPrinter_Fini(const AstPrinter* self)
-{
-	String_Fini(&self->output);
-}
-
 static void AstPrinter_PrintIndentation(AstPrinter* self)
 {
-	for (size_t i = 0; i < self->indent * 4; i++)
-		String_AppendChar(&self->output, ' ');
+	Writer_WriteSpaces(self->output, self->indent * 4);
 }
 
 typedef int a;
 
-static void AstPrinter_PrintTypeName(AstPrinter* self, const AstTypeName* type)
+static void AstPrinter_PrintTypeName(AstPrinter* self, const FlatAst* ast, const FlatAst_TypeName* type)
 {
-	const AstTypeQualifiers qualifiers = type->specifierQualifierList->qualifiers;
-	using const String* qualifiersStr = AstTypeQualifiers_ToString(qualifiers);
-	String_AppendCString(&self->output, "Qualifiers: ");
-	String_AppendCString(&self->output, String_AsCString(qualifiersStr));
-	String_AppendChar(&self->output, '\n');
+	using const String* qualifiersStr = AstTypeQualifiers_ToString((AstTypeQualifiers)type->qualifiers);
+	Writer_WriteCString(self->output, "Qualifiers: ");
+	Writer_WriteCString(self->output, String_AsCString(qualifiersStr));
+	Writer_WriteChar(self->output, '\n');
 	AstPrinter_PrintIndentation(self);
-	String_AppendCString(&self->output, "Specifiers: ");
+	Writer_WriteCString(self->output, "Specifiers: ");
 
-	for (size_t i = 0; i < type->specifierQualifierList->specifiers->size; i++)
+	for (size_t i = 0; i < type->specifierCount; i++)
 	{
-		const AstTypeSpecifier* specifier = type->specifierQualifierList->specifiers->data[i];
-		String_AppendCString(&self->output, AstTypeSpecifier_Type_ToString(specifier->type));
-		if (i < type->specifierQualifierList->specifiers->size - 1)
-			String_AppendCString(&self->output, ", ");
+		const FlatAst_TypeSpecifier* specifier = &ast->typeSpecifiers.data[type->firstSpecifier + i];
+		Writer_WriteCString(self->output, AstTypeSpecifier_Type_ToString((AstTypeSpecifier_Type)specifier->type));
+		if (i < type->specifierCount - 1)
+			Writer_WriteCString(self->output, ", ");
 	}
 }
 
-static void AstPrinter_PrintExpression(AstPrinter* self, const AstExpression* expr)
+// Folded constants have no lexeme; integers print in decimal and floats in the fewest digits that read back exactly
+static ConstCharSpan AstPrinter_FormatFoldedValue(const FlatAst_Primary* primary, char* buffer, const size_t bufferSize)
 {
-	switch (expr->type)
+	int length;
+	if (primary->tokenType == TOKEN_LITERAL_INTEGER)
 	{
-		case AST_EXPR_UNARY:
+		const bool isSigned = primary->literalType <= TOKEN_LITERAL_INTEGER_TYPE_LONGLONG;
+		length = isSigned ? snprintf(buffer, bufferSize, "%" PRId64, (int64_t)primary->value.integer)
+		                  : snprintf(buffer, bufferSize, "%" PRIu64, primary->value.integer);
+	}
+	else
+	{
+		const bool isFloat = primary->literalType == TOKEN_LITERAL_FLOAT_TYPE_FLOAT;
+		for (int precision = 1; precision <= 17; precision++)
 		{
-			String_AppendCString(&self->output, "(Unary Expression) {\n");
-			self->indent++;
-
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "Operation: ");
-			String_AppendCString(&self->output, AstUnaryOperation_ToString(expr->data.unary.operation));
-			String_AppendCString(&self->output, ",\n");
-
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "Expression: ");
-			AstPrinter_PrintExpression(self, expr->data.unary.expression);
-			String_AppendCString(&self->output, "\n");
-
-			self->indent--;
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "}");
-			break;
+			length = snprintf(buffer, bufferSize, "%.*g", precision, primary->value.floating);
+			if (isFloat ? (double)strtof(buffer, NULL) == primary->value.floating : strtod(buffer, NULL) == primary->value.floating)
+				break;
 		}
-		case AST_EXPR_BINARY:
+		if (!strpbrk(buffer, ".en"))
 		{
-			String_AppendCString(&self->output, "(Binary Expression) {\n");
-			self->indent++;
+			buffer[length++] = '.';
+			buffer[length++] = '0';
+		}
+		if (isFloat)
+			buffer[length++] = 'f';
+	}
+	return ConstCharSpan_Create(buffer, (size_t)length);
+}
 
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "Operation: ");
-			String_AppendCString(&self->output, AstBinaryOperation_ToString(expr->data.binary.operation));
-			String_AppendCString(&self->output, ",\n");
+static void AstPrinter_PrintPrimary(AstPrinter* self, const FlatAst* ast, const FlatAst_Node node)
+{
+	const FlatAst_Primary* primary = FlatAst_GetPrimary(ast, node);
+	char buffer[32];
+	const ConstCharSpan snippet = primary->isFolded ? AstPrinter_FormatFoldedValue(primary, buffer, sizeof(buffer) - 1)
+	                                                : FlatAst_GetLocation(ast, node).snippet;
+	switch (primary->tokenType)
+	{
+		case TOKEN_LITERAL_INTEGER:
+			Writer_WriteCString(self->output, "Type: Integer Literal { Value: ");
+			Writer_WriteConstCharSpan(self->output, snippet);
+			Writer_WriteCString(self->output, ", ");
+			Writer_WriteCString(self->output, "Type: ");
+			Writer_WriteCString(self->output, primary->literalType == TOKEN_LITERAL_INTEGER_TYPE_INT
+				                                    ? "int"
+				                                    : primary->literalType == TOKEN_LITERAL_INTEGER_TYPE_LONG
+					                                      ? "long"
+					                                      : primary->literalType == TOKEN_LITERAL_INTEGER_TYPE_LONGLONG
+						                                        ? "long long"
+						                                        : primary->literalType == TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDINT
+							                                          ? "unsigned int"
+							                                          : primary->literalType == TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONG
+								                                            ? "unsigned long"
+								                                            : primary->literalType == TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONGLONG
+									                                              ? "unsigned long long"
+									                                              : "???");
+			Writer_WriteCString(self->output, ", ");
+			Writer_WriteCString(self->output, "Base: ");
+			Writer_WriteCString(self->output, primary->base == 10
+				                                    ? "10"
+				                                    : primary->base == 16
+					                                      ? "16"
+					                                      : primary->base == 8
+						                                        ? "8"
+						                                        : primary->base == 2
+							                                          ? "2"
+							                                          : "???");
+			Writer_WriteCString(self->output, " }\n");
+			break;
+		case TOKEN_LITERAL_FLOAT:
+			Writer_WriteCString(self->output, "Type: Floating Point Literal { Value: ");
+			Writer_WriteConstCharSpan(self->output, snippet);
+			Writer_WriteCString(self->output, " }\n");
+			break;
+		case TOKEN_LITERAL_CHAR:
+			Writer_WriteCString(self->output, "Type: Character Literal { Value: ");
+			Writer_WriteConstCharSpan(self->output, snippet);
+			Writer_WriteCString(self->output, " }\n");
+			break;
+		case TOKEN_LITERAL_STRING:
+			Writer_WriteCString(self->output, "Type: String Literal { Value: ");
+			Writer_WriteConstCharSpan(self->output, snippet);
+			Writer_WriteCString(self->output, " }\n");
+			break;
+		case TOKEN_IDENTIFIER:
+			Writer_WriteCString(self->output, "Type: Identifier { Name: ");
+			Writer_WriteConstCharSpan(self->output, snippet);
+			Writer_WriteCString(self->output, " }\n");
+			break;
+		default:
+			assert(false && "unreachable (invalid primary expression token)"); // Unexpected token type
+	}
+}
 
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "Left: ");
-			AstPrinter_PrintExpression(self, expr->data.binary.left);
-			String_AppendCString(&self->output, ",\n");
+// Prints the opening line and the fields of a node; returns whether its children are printed
+static bool AstPrinter_EnterNode(void* context, const FlatAst* ast, const FlatAst_Node node)
+{
+	AstPrinter* self = (AstPrinter*)context;
+	switch (FlatAst_GetType(ast, node))
+	{
+		case AST_EXPR_UNARY:
+			Writer_WriteCString(self->output, "(Unary Expression) {\n");
+			self->indent++;
 
 			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "Right: ");
-			AstPrinter_PrintExpression(self, expr->data.binary.right);
-			String_AppendChar(&self->output, '\n');
+			Writer_WriteCString(self->output, "Operation: ");
+			Writer_WriteCString(self->output, AstUnaryOperation_ToString((AstUnaryOperation)FlatAst_GetUnary(ast, node)->operation));
+			Writer_WriteCString(self->output, ",\n");
+			return true;
+		case AST_EXPR_BINARY:
+			Writer_WriteCString(self->output, "(Binary Expression) {\n");
+			self->indent++;
 
-			self->indent--;
 			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "}");
-		}
-		break;
+			Writer_WriteCString(self->output, "Operation: ");
+			Writer_WriteCString(self->output, AstBinaryOperation_ToString((AstBinaryOperation)FlatAst_GetBinary(ast, node)->operation));
+			Writer_WriteCString(self->output, ",\n");
+			return true;
 		case AST_EXPR_TERNARY:
-		{
-			String_AppendCString(&self->output, "(Ternary Expression) {\n");
+			Writer_WriteCString(self->output, "(Ternary Expression) {\n");
 			self->indent++;
 
 			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "Operation: ");
-			String_AppendCString(&self->output, AstTernaryOperation_ToString(expr->data.ternary.operation));
-			String_AppendCString(&self->output, ",\n");
-
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "Left: ");
-			AstPrinter_PrintExpression(self, expr->data.ternary.left);
-			String_AppendCString(&self->output, ",\n");
-
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "Middle: ");
-			AstPrinter_PrintExpression(self, expr->data.ternary.middle);
-			String_AppendCString(&self->output, ",\n");
-
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "Right: ");
-			AstPrinter_PrintExpression(self, expr->data.ternary.right);
-			String_AppendChar(&self->output, '\n');
-
-			self->indent--;
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "}");
-			break;
-		}
+			Writer_WriteCString(self->output, "Operation: ");
+			Writer_WriteCString(self->output, AstTernaryOperation_ToString((AstTernaryOperation)FlatAst_GetTernary(ast, node)->operation));
+			Writer_WriteCString(self->output, ",\n");
+			return true;
 		case AST_EXPR_CAST:
-		{
-			String_AppendCString(&self->output, "(Cast Expression) {\n");
+			Writer_WriteCString(self->output, "(Cast Expression) {\n");
 			self->indent++;
 
 			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "TODO!\n");
-
-			self->indent--;
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "}");
-			break;
-		}
+			Writer_WriteCString(self->output, "TODO!\n");
+			return false;
 		case AST_EXPR_SIZEOF_TYPE:
-		{
-			String_AppendCString(&self->output, "(Sizeof Type Expression) {\n");
+			Writer_WriteCString(self->output, "(Sizeof Type Expression) {\n");
 			self->indent++;
 
 			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "Type: ");
-			AstPrinter_PrintTypeName(self, expr->data.sizeofType.typeName);
-			String_AppendChar(&self->output, '\n');
-
-			self->indent--;
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "}");
-			break;
-		}
+			Writer_WriteCString(self->output, "Type: ");
+			AstPrinter_PrintTypeName(self, ast, FlatAst_GetTypeName(ast, FlatAst_GetSizeofType(ast, node)->typeName));
+			Writer_WriteChar(self->output, '\n');
+			return false;
 		case AST_EXPR_MEMBER_ACCESS:
-		{
-			String_AppendCString(&self->output, "(Member Access Expression) {\n");
+			Writer_WriteCString(self->output, "(Member Access Expression) {\n");
 			self->indent++;
 
 			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "TODO!\n");
-
-			self->indent--;
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "}");
-			break;
-		}
+			Writer_WriteCString(self->output, "TODO!\n");
+			return false;
 		case AST_EXPR_CALL:
-		{
-			String_AppendCString(&self->output, "(Call Expression) {\n");
+			Writer_WriteCString(self->output, "(Call Expression) {\n");
 			self->indent++;
 
 			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "Arguments: [\n");
+			Writer_WriteCString(self->output, "Arguments: [\n");
 			self->indent++;
-			for (size_t i = 0; i < expr->data.call.arguments->size; i++)
-			{
-				AstPrinter_PrintIndentation(self);
-				AstPrinter_PrintExpression(self, expr->data.call.arguments->data[i]);
-				if (i < expr->data.call.arguments->size - 1)
-					String_AppendChar(&self->output, ',');
-				String_AppendChar(&self->output, '\n');
-			}
-			self->indent--;
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "]\n");
-
-			self->indent--;
-			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "}");
-			break;
-		}
+			return true;
 		case AST_EXPR_PRIMARY:
-		{
-			String_AppendCString(&self->output, "(Primary Expression) {\n");
+			Writer_WriteCString(self->output, "(Primary Expression) {\n");
 			self->indent++;
 
 			AstPrinter_PrintIndentation(self);
-			const Token* token = &expr->data.primary.literal;
-			switch (token->type)
-			{
-				case TOKEN_LITERAL_INTEGER:
-					String_AppendCString(&self->output, "Type: Integer Literal { Value: ");
-					String_AppendConstCharSpan(&self->output, token->location.snippet);
-					String_AppendCString(&self->output, ", ");
-					String_AppendCString(&self->output, "Type: ");
-					String_AppendCString(&self->output, token->data.literalInteger.type == TOKEN_LITERAL_INTEGER_TYPE_INT
-						                                    ? "int"
-						                                    : token->data.literalInteger.type == TOKEN_LITERAL_INTEGER_TYPE_LONG
-							                                      ? "long"
-							                                      : token->data.literalInteger.type == TOKEN_LITERAL_INTEGER_TYPE_LONGLONG
-								                                        ? "long long"
-								                                        : token->data.literalInteger.type == TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDINT
-									                                          ? "unsigned int"
-									                                          : token->data.literalInteger.type == TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONG
-										                                            ? "unsigned long"
-										                                            : token->data.literalInteger.type ==
-										                                              TOKEN_LITERAL_INTEGER_TYPE_UNSIGNEDLONGLONG
-											                                              ? "unsigned long long"
-											                                              : "???");
-					String_AppendCString(&self->output, ", ");
-					String_AppendCString(&self->output, "Base: ");
-					String_AppendCString(&self->output, token->data.literalInteger.base == 10
-						                                    ? "10"
-						                                    : token->data.literalInteger.base == 16
-							                                      ? "16"
-							                                      : token->data.literalInteger.base == 8
-								                                        ? "8"
-								                                        : token->data.literalInteger.base == 2
-									                                          ? "2"
-									                                          : "???");
-					String_AppendCString(&self->output, " }\n");
-					break;
-				case TOKEN_LITERAL_FLOAT:
-					String_AppendCString(&self->output, "Type: Floating Point Literal { Value: ");
-					String_AppendConstCharSpan(&self->output, token->location.snippet);
-					String_AppendCString(&self->output, " }\n");
-					break;
-				case TOKEN_LITERAL_CHAR:
-					String_AppendCString(&self->output, "Type: Character Literal { Value: ");
-					String_AppendConstCharSpan(&self->output, token->location.snippet);
-					String_AppendCString(&self->output, " }\n");
-					break;
-				case TOKEN_LITERAL_STRING:
-					String_AppendCString(&self->output, "Type: String Literal { Value: ");
-					String_AppendConstCharSpan(&self->output, token->location.snippet);
-					String_AppendCString(&self->output, " }\n");
-					break;
-				case TOKEN_IDENTIFIER:
-					String_AppendCString(&self->output, "Type: Identifier { Name: ");
-					String_AppendConstCharSpan(&self->output, token->location.snippet);
-					String_AppendCString(&self->output, " }\n");
-					break;
-				default:
-					assert(false && "unreachable (invalid primary expression token)"); // Unexpected token type
-			}
-
-			self->indent--;
+			AstPrinter_PrintPrimary(self, ast, node);
+			return false;
+		default:
+			assert(false && "unreachable");
+			return false;
+	}
+}
+
+static bool AstPrinter_EnterChild(void* context, const FlatAst* ast, const FlatAst_Node parent, const size_t index)
+{
+	AstPrinter* self = (AstPrinter*)context;
+	switch (FlatAst_GetType(ast, parent))
+	{
+		case AST_EXPR_UNARY:
+			AstPrinter_PrintIndentation(self);
+			Writer_WriteCString(self->output, "Expression: ");
+			return true;
+		case AST_EXPR_BINARY:
 			AstPrinter_PrintIndentation(self);
-			String_AppendCString(&self->output, "}");
+			Writer_WriteCString(self->output, index == 0 ? "Left: " : "Right: ");
+			return true;
+		case AST_EXPR_TERNARY:
+			AstPrinter_PrintIndentation(self);
+			Writer_WriteCString(self->output, index == 0 ? "Left: " : index == 1 ? "Middle: " : "Right: ");
+			return true;
+		case AST_EXPR_CALL:
+			// The callee is not printed
+			if (index == 0)
+				return false;
+			AstPrinter_PrintIndentation(self);
+			return true;
+		default:
+			return true;
+	}
+}
+
+static void AstPrinter_LeaveChild(void* context, const FlatAst* ast, const FlatAst_Node parent, const size_t index)
+{
+	AstPrinter* self = (AstPrinter*)context;
+	const bool isLast = index == FlatAst_GetChildCount(ast, parent) - 1;
+	switch (FlatAst_GetType(ast, parent))
+	{
+		case AST_EXPR_CALL:
+			if (!isLast)
+				Writer_WriteChar(self->output, ',');
+			Writer_WriteChar(self->output, '\n');
 			break;
-		}
 		default:
-			assert(false && "unreachable");
+			Writer_WriteCString(self->output, isLast ? "\n" : ",\n");
+			break;
+	}
+}
+
+static void AstPrinter_LeaveNode(void* context, const FlatAst* ast, const FlatAst_Node node)
+{
+	AstPrinter* self = (AstPrinter*)context;
+	if (FlatAst_GetType(ast, node) == AST_EXPR_CALL)
+	{
+		self->indent--;
+		AstPrinter_PrintIndentation(self);
+		Writer_WriteCString(self->output, "]\n");
+	}
+
+	self->indent--;
+	AstPrinter_PrintIndentation(self);
+	Writer_WriteCString(self->output, "}");
+}
+
+static void AstPrinter_PrintExpression(AstPrinter* self, const FlatAst* ast, const FlatAst_Node node)
+{
+	const FlatAst_Visitor visitor = {
+		.context = self,
+		.enter = AstPrinter_EnterNode,
+		.enterChild = AstPrinter_EnterChild,
+		.leaveChild = AstPrinter_LeaveChild,
+		.leave = AstPrinter_LeaveNode,
+	};
+	FlatAst_Walk(ast, node, &visitor);
+}
+
+// Prints expressions one after another, as text trees or as a single JSON document
+typedef struct
+{
+	Writer* output;
+	JsonWriter json;
+	bool isJson;
+} ExpressionOutput;
+
+static ExpressionOutput ExpressionOutput_Begin(Writer* output, const bool isJson)
+{
+	ExpressionOutput self = { .output = output, .json = JsonWriter_Create(output), .isJson = isJson };
+	if (isJson)
+	{
+		JsonWriter_BeginObject(&self.json);
+		JsonWriter_Key(&self.json, "schema");
+		JsonWriter_UInt(&self.json, JSON_EXPORT_SCHEMA_VERSION);
+		JsonWriter_Key(&self.json, "expressions");
+		JsonWriter_BeginArray(&self.json);
+	}
+	return self;
+}
+
+static void ExpressionOutput_Print(ExpressionOutput* self, const FlatAst* ast, const FlatAst_Node root)
+{
+	if (self->isJson)
+	{
+		JsonExport_WriteExpression(&self->json, ast, root);
+		return;
+	}
+
+	AstPrinter printer = AstPrinter_Create(self->output);
+	AstPrinter_PrintExpression(&printer, ast, root);
+	Writer_WriteChar(self->output, '\n');
+}
+
+static void ExpressionOutput_End(ExpressionOutput* self)
+{
+	if (self->isJson)
+	{
+		JsonWriter_EndArray(&self->json);
+		JsonWriter_EndObject(&self->json);
+		Writer_WriteChar(self->output, '\n');
+	}
+}
+
+// Prints the tokens as {"schema": ..., "tokens": [...]} on one line
+static void PrintTokensJson(const TokenList* tokens, const SourceFile* source, const Token_DataList* tokenData)
+{
+	fflush(stdout);
+	using Writer* output = NewWith(Writer, Fd, STDOUT_FILENO);
+	JsonWriter json = JsonWriter_Create(output);
+	JsonWriter_BeginObject(&json);
+	JsonWriter_Key(&json, "schema");
+	JsonWriter_UInt(&json, JSON_EXPORT_SCHEMA_VERSION);
+	JsonWriter_Key(&json, "tokens");
+	JsonWriter_BeginArray(&json);
+	for (size_t i = 0; i < tokens->size; i++)
+		JsonExport_WriteToken(&json, &tokens->data[i], source, tokenData);
+	JsonWriter_EndArray(&json);
+	JsonWriter_EndObject(&json);
+	Writer_WriteChar(output, '\n');
+}
+
+// What to do with the parsed expressions besides printing them, and how to print them
+typedef struct
+{
+	bool fold;
+	bool share;
+	// Where to save the printed expressions as a FlatAst file, if anywhere
+	const char*nullable saveAstPath;
+	bool emitAstJson;
+	bool emitTokensJson;
+	// Print the token dump with printf per field rather than through a Writer; the output is the same
+	bool dumpTokensWithStdio;
+} Options;
+
+static void SaveAst(const FlatAst* ast, const Interner* interner, const char* path)
+{
+	if (!FlatAstFile_Write(ast, interner, path))
+		fprintf(stderr, "Failed to write AST file: %s\n", path);
+}
+
+static void ParseAndPrint(Parser* parser, const Interner* interner, const Options* options)
+{
+	// Leading declarations are parsed so that the expression can use the typedef names they declare
+	while (true)
+	{
+		const size_t errorCount = parser->errors->size;
+		using const AstDeclaration* declaration = Parser_TryParseDeclaration(parser);
+		if (!declaration)
+		{
+			if (parser->errors->size != errorCount)
+				return;
+			break;
+		}
+	}
+
+	using AstExpression* expr = Parser_ParseExpression(parser);
+	if (expr && options->fold)
+	{
+		ConstantFolder folder = ConstantFolder_Create(parser->arena);
+		expr = ConstantFolder_Fold(&folder, expr);
 	}
+
+	// Folding changes nodes in place, so sharing comes after it
+	if (expr && options->share)
+	{
+		using ExpressionInterner* interner = New(ExpressionInterner);
+		expr = ExpressionInterner_Intern(interner, expr);
+	}
+
+	// The token dump before the tree went through stdio
+	fflush(stdout);
+	using Writer* output = NewWith(Writer, Fd, STDOUT_FILENO);
+	ExpressionOutput expressionOutput = ExpressionOutput_Begin(output, options->emitAstJson);
+	if (expr)
+	{
+		FlatAst ast;
+		FlatAst_Init_WithSource(&ast, parser->source);
+		const FlatAst_Node root = FlatAst_AppendExpression(&ast, expr);
+		ExpressionOutput_Print(&expressionOutput, &ast, root);
+		if (options->saveAstPath)
+			SaveAst(&ast, interner, options->saveAstPath);
+		FlatAst_Fini(&ast);
+	}
+	ExpressionOutput_End(&expressionOutput);
 }
 
-static void Parse(const SourceFile* source, CompilerErrorList* errorList)
+static void Parse(const SourceFile* source, CompilerErrorList* errorList, const Options* options)
 {
 	using TokenList* tokens = New(TokenList);
+	using Token_DataList* tokenData = New(Token_DataList);
+	using Interner* interner = New(Interner);
+	using Arena* arena = New(Arena);
 
-	Lexer lexer = Lexer_Create(source, errorList);
+	Lexer lexer = Lexer_Create(source, tokenData, interner, errorList);
 
 	while (true)
 	{
@@ -288,33 +447,165 @@ static void Parse(const SourceFile* source, CompilerErrorList* errorList)
 			break;
 	}
 
-	for (size_t i = 0; i < tokens->size; i++)
+	// With the tree as JSON, stdout only carries JSON documents, one per line
+	if (options->emitTokensJson)
+		PrintTokensJson(tokens, source, tokenData);
+	else if (!options->emitAstJson && options->dumpTokensWithStdio)
+	{
+		for (size_t i = 0; i < tokens->size; i++)
+		{
+			const Token* token = &tokens->data[i];
+			Token_Print(token, source, tokenData);
+		}
+	}
+	else if (!options->emitAstJson)
 	{
-		const Token* token = &tokens->data[i];
-		Token_Print(token);
+		fflush(stdout);
+		using Writer* output = NewWith(Writer, Fd, STDOUT_FILENO);
+		for (size_t i = 0; i < tokens->size; i++)
+			Token_Write(&tokens->data[i], source, tokenData, output);
 	}
 
-	Parser parser = Parser_Create(tokens, errorList);
+	Parser parser = Parser_Create(source, tokens, tokenData, arena, errorList);
+	ParseAndPrint(&parser, interner, options);
+	Parser_Fini(&parser);
+}
 
-	using const AstExpression* expr = Parser_ParseExpression(&parser);
-	if (expr)
+// Parses without lexing the whole file up front; tokens are pulled from the lexer as the parser needs them
+static void ParseStreaming(const SourceFile* source, CompilerErrorList* errorList, const Options* options)
+{
+	using Interner* interner = New(Interner);
+	using TokenStream* stream = NewWith(TokenStream, Source, source, interner, errorList);
+	using Arena* arena = New(Arena);
+
+	Parser parser = Parser_Create_WithStream(source, stream, arena, errorList);
+	ParseAndPrint(&parser, interner, options);
+	Parser_Fini(&parser);
+}
+
+// Parses every top-level item, splitting the work between threadCount threads
+static void ParseParallel(const SourceFile* source, CompilerErrorList* errorList, const size_t threadCount, const Options* options)
+{
+	using TokenList* tokens = New(TokenList);
+	using Token_DataList* tokenData = New(Token_DataList);
+	using Interner* interner = New(Interner);
+	ParallelLexer_Tokenize(source, threadCount, 0, tokens, tokenData, interner, errorList);
+
+	using ParallelParser_Result* result = ParallelParser_Parse(source, tokens, tokenData, threadCount, 0, errorList);
+	using Arena* foldArena = New(Arena);
+	ConstantFolder folder = ConstantFolder_Create(foldArena);
+	using ExpressionInterner* expressionInterner = New(ExpressionInterner);
+	FlatAst ast;
+	FlatAst_Init_WithSource(&ast, source);
+	fflush(stdout);
+	using Writer* output = NewWith(Writer, Fd, STDOUT_FILENO);
+	ExpressionOutput expressionOutput = ExpressionOutput_Begin(output, options->emitAstJson);
+	for (size_t i = 0; i < result->items.size; i++)
 	{
-		AstPrinter printer = AstPrinter_Create();
-		AstPrinter_PrintExpression(&printer, expr);
-		printf("%s\n", String_AsCString(&printer.output));
-		AstPrinter_Fini(&printer);
+		const ParallelParser_Item* item = &result->items.data[i];
+		// The JSON document only holds expressions
+		if (item->declaration && options->emitAstJson)
+			continue;
+		if (item->declaration)
+		{
+			Writer_WriteCString(output, "(Declaration) { ");
+			Writer_WriteConstCharSpan(output, item->declaration->location.snippet);
+			Writer_WriteCString(output, " }\n");
+			continue;
+		}
+
+		AstExpression*nullable expr = item->statement->data.expression.expression;
+		if (!expr)
+			continue;
+		if (options->fold)
+			expr = ConstantFolder_Fold(&folder, expr);
+		if (options->share)
+			expr = ExpressionInterner_Intern(expressionInterner, expr);
+
+		const FlatAst_Node root = FlatAst_AppendExpression(&ast, expr);
+		ExpressionOutput_Print(&expressionOutput, &ast, root);
 	}
+	ExpressionOutput_End(&expressionOutput);
+
+	if (options->saveAstPath)
+		SaveAst(&ast, interner, options->saveAstPath);
+	FlatAst_Fini(&ast);
+}
+
+// Prints the expressions of a FlatAst file saved from source instead of parsing it
+static bool LoadAndPrint(const SourceFile* source, const char* path, const Options* options)
+{
+	using const FlatAstFile* file = NewWith(FlatAstFile, Path, path, source);
+	const char*nullable error = file->data && !FlatAstFile_MatchesSource(file, source) ? "was saved from a different source" : file->error;
+	if (error)
+	{
+		fprintf(stderr, "Failed to load AST file for %s: %s %s\n", source->path, path, error);
+		return false;
+	}
+
+	fflush(stdout);
+	using Writer* output = NewWith(Writer, Fd, STDOUT_FILENO);
+	ExpressionOutput expressionOutput = ExpressionOutput_Begin(output, options->emitAstJson);
+	for (size_t i = 0; i < file->ast.roots.size; i++)
+		ExpressionOutput_Print(&expressionOutput, &file->ast, file->ast.roots.data[i]);
+	ExpressionOutput_End(&expressionOutput);
+	return true;
 }
 
 static int run(const CStringSpan args)
 {
-	if (args.length == 1)
+	size_t argIndex = 1;
+	bool streaming = false;
+	size_t threadCount = 0;
+	Options options = { 0 };
+	const char*nullable loadAstPath = NULL;
+	bool isAstFormatSet = false;
+	bool isValid = true;
+	for (; argIndex < args.length && strncmp(args.data[argIndex], "--", 2) == 0 && isValid; argIndex++)
 	{
-		printf("Usage: %s <file>\n", args.data[0]);
+		if (strcmp(args.data[argIndex], "--stream") == 0)
+			streaming = true;
+		else if (argIndex + 1 < args.length && strcmp(args.data[argIndex], "--threads") == 0)
+			threadCount = strtoull(args.data[++argIndex], NULL, 10);
+		else if (strcmp(args.data[argIndex], "--fold") == 0)
+			options.fold = true;
+		else if (strcmp(args.data[argIndex], "--share") == 0)
+			options.share = true;
+		else if (argIndex + 1 < args.length && strcmp(args.data[argIndex], "--save-ast") == 0)
+			options.saveAstPath = args.data[++argIndex];
+		else if (argIndex + 1 < args.length && strcmp(args.data[argIndex], "--load-ast") == 0)
+			loadAstPath = args.data[++argIndex];
+		else if (strcmp(args.data[argIndex], "--emit-ast=json") == 0 || strcmp(args.data[argIndex], "--emit-ast=text") == 0)
+		{
+			options.emitAstJson = strcmp(args.data[argIndex], "--emit-ast=json") == 0;
+			isAstFormatSet = true;
+		}
+		else if (strcmp(args.data[argIndex], "--emit-tokens=json") == 0 || strcmp(args.data[argIndex], "--emit-tokens=text") == 0)
+			options.emitTokensJson = strcmp(args.data[argIndex], "--emit-tokens=json") == 0;
+		else if (strcmp(args.data[argIndex], "--token-dump=stdio") == 0 || strcmp(args.data[argIndex], "--token-dump=buffered") == 0)
+			options.dumpTokensWithStdio = strcmp(args.data[argIndex], "--token-dump=stdio") == 0;
+		else
+			isValid = false;
+	}
+
+	// Once the tokens are JSON, stdout only carries JSON, so the tree is JSON too and cannot be asked for as text
+	if (options.emitTokensJson && !isAstFormatSet)
+		options.emitAstJson = true;
+
+	// A loaded AST is printed as it was saved, so none of the parsing options apply to it.
+	// Only the default mode dumps the tokens.
+	const bool isParsing = streaming || threadCount != 0 || options.fold || options.share || options.saveAstPath;
+	const bool isLexingUpFront = !streaming && threadCount == 0 && !loadAstPath;
+	if (!isValid || argIndex >= args.length || (streaming && threadCount != 0) || (loadAstPath && isParsing) ||
+	    ((options.emitTokensJson || options.dumpTokensWithStdio) && !isLexingUpFront) || (options.emitTokensJson && !options.emitAstJson))
+	{
+		printf("Usage: %s [--stream | --threads <n>] [--fold] [--share] [--save-ast <ast-file>] [--emit-ast=<text|json>] "
+		       "[--emit-tokens=<text|json>] [--token-dump=<buffered|stdio>] <file>\n"
+		       "       %s --load-ast <ast-file> [--emit-ast=<text|json>] <file>\n", args.data[0], args.data[0]);
 		return 1;
 	}
 
-	const char* filepath = args.data[1];
+	const char* filepath = args.data[argIndex];
 	using const SourceFile* source = NewWith(SourceFile, Path, filepath);
 	if (source->content == NULL)
 	{
@@ -322,13 +613,26 @@ static int run(const CStringSpan args)
 		return 1;
 	}
 
-	using CompilerErrorList* errorList = New(CompilerErrorList);
-	Parse(source, errorList);
+	if (loadAstPath)
+		return LoadAndPrint(source, loadAstPath, &options) ? 0 : 1;
 
+	using CompilerErrorList* errorList = New(CompilerErrorList);
+	if (streaming)
+		ParseStreaming(source, errorList, &options);
+	else if (threadCount != 0)
+		ParseParallel(source, errorList, threadCount, &options);
+	else
+		Parse(source, errorList, &options);
+
+	// Errors go to stderr when stdout is JSON, so that it stays parseable
+	FILE* errorOutput = options.emitAstJson || options.emitTokensJson ? stderr : stdout;
 	for (size_t i = 0; i < errorList->size; i++)
 	{
 		const CompilerError* error = errorList->data + i;
-		printf("%s:%zu:%zu: error: %s\n", error->location.sourceFile->path, error->location.line, error->location.column, error->message);
+
+		size_t line, column;
+		SourceLocation_GetLineColumn(&error->location, &line, &column);
+		fprintf(errorOutput, "%s:%zu:%zu: error: %s\n", error->location.sourceFile->path, line, column, error->message);
 	}
 
 	return 0;
@@ -0,0 +1,59 @@
+# Runs SimpleC on a generated input and fails if it does not exit normally, or if its output misses the case's
+# expected text.
+#   cmake -DSIMPLEC=<path> -DCASE=<name> -DWORK_DIR=<dir> [-DMODE=<options>] -P RunGenerated.cmake
+
+set(options "")
+if (CASE STREQUAL "typedefs")
+	# Hundreds of distinct typedef names, then a cast to one of the last
+	set(input "")
+	foreach (i RANGE 1 400)
+		string(APPEND input "typedef int T${i};\n")
+	endforeach ()
+	string(APPEND input "(T400)1;\n")
+	set(expect "Cast")
+elseif (CASE STREQUAL "deepchain")
+	# Nesting deep enough to overflow the call stack of any pass that recurses per level. The text tree indents each
+	# level, so only JSON output stays linear in the depth.
+	string(REPEAT "a + " 300000 input)
+	string(APPEND input "a;\n")
+	set(options --emit-ast=json)
+	set(expect "^{\"schema\":1,\"expressions\":\\[{\"kind\":\"BINARY\"")
+elseif (CASE STREQUAL "deepunary")
+	string(REPEAT "-" 300000 input)
+	string(APPEND input "a;\n")
+	set(options --emit-ast=json)
+	set(expect "^{\"schema\":1,\"expressions\":\\[{\"kind\":\"UNARY\"")
+elseif (CASE STREQUAL "deepassign")
+	# Right-associative, so the chain nests on the right
+	string(REPEAT "a = " 200000 input)
+	string(APPEND input "a;\n")
+	set(options --emit-ast=json)
+	set(expect "^{\"schema\":1,\"expressions\":\\[{\"kind\":\"BINARY\",\"offset\":0,\"length\":800001,\"operator\":\"ASSIGN\"")
+else ()
+	message(FATAL_ERROR "unknown case ${CASE}")
+endif ()
+
+# Named after the mode as well, so that the modes of a case can run in parallel
+string(MAKE_C_IDENTIFIER "${CASE}${MODE}" name)
+set(path "${WORK_DIR}/${name}.c")
+file(WRITE "${path}" "${input}")
+
+if (MODE)
+	separate_arguments(mode UNIX_COMMAND "${MODE}")
+	list(APPEND options ${mode})
+endif ()
+
+# The output of deep cases is tens of megabytes, so it goes to a file and only its start is matched
+set(outputPath "${WORK_DIR}/${name}.out")
+execute_process(COMMAND "${SIMPLEC}" ${options} "${path}"
+		RESULT_VARIABLE result
+		OUTPUT_FILE "${outputPath}"
+		ERROR_VARIABLE errors)
+if (NOT result EQUAL 0)
+	message(FATAL_ERROR "SimpleC ${options} ${path} exited with ${result}\n${errors}")
+endif ()
+
+file(READ "${outputPath}" output LIMIT 200000)
+if (NOT output MATCHES "${expect}")
+	message(FATAL_ERROR "SimpleC ${options} ${path} did not print ${expect}")
+endif ()
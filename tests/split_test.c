@@ -0,0 +1,21 @@
+// Lines that look like good places to split the source for parallel lexing, but are not
+/*
+   a block comment whose lines do not start with '*'
+int inside_comment = 1;
+*/
+int a = 1; /* a comment that
+spans lines */ int b = 2;
+// a line comment continued \
+int inside_line_comment = 3;
+const char* s = "a string continued \
+int inside_string = 4;";
+char c = '\
+x';
+/**
+ * A documentation comment
+ */
+double d = 1.5e\
+10 + 0x1p-3;
+unsigned long long e = 18446744073709551615ULL + 012 + 0x7fffffff;
+int f = a+++b-->c<<=d>>=e;
+/* unterminated at the end of the file